@@ -3,13 +3,15 @@
 #include <Arduino.h>
 #include <Audio.h>
 #include "Mixer128.h"
+#include <sf22aswt_instrument_slot.h>
 
 namespace WaveTableSynth
 {
 
     #define VOICE_COUNT 128
     AudioSynthWavetable wavetable[VOICE_COUNT];
-    AudioSynthWavetable::instrument_data *wt_inst = nullptr;
+    /** the active instrument of all voices, new instruments are loaded into it's shadow slot and then swapped in */
+    SF22ASWT::InstrumentSlot instrument;
     int notes[VOICE_COUNT];
     bool sustain[VOICE_COUNT];
 
@@ -36,6 +38,7 @@ namespace WaveTableSynth
             sustain[i] = false;
             mixer.gain(i, mixerGlobalGain);
         }
+        instrument.setVoices(wavetable, VOICE_COUNT);
     }
 
     void autoGain()
@@ -55,14 +58,6 @@ namespace WaveTableSynth
         }
     }
 
-    void SetInstrument(const AudioSynthWavetable::instrument_data &inst)
-    {
-        for (int i=0;i<VOICE_COUNT;i++) {
-            
-            wavetable[i].setInstrument(inst);
-        }
-    }
-
     void activateSustain()
     {
         //sustainActive = true;
@@ -94,6 +89,7 @@ namespace WaveTableSynth
         //for (int i=0;i<VOICE_COUNT;i++){
         //    if (notes[i]==-1) {
                 notes[note] = 1;
+                instrument.ActivateVoice(note); // if the voice still have the previous instrument
                 wavetable[note].playNote(note, velocity);
                 //return;
             //}
@@ -68,10 +68,27 @@ void loop()
         }
     }
     usbMIDI.read();
+    // frees the previous instrument when no voice uses it anymore
+    WaveTableSynth::instrument.Service();
 }
 
 void PrintFileNotOpenOrLastReadWasNotOK() { USerial.println("file not open or last read was not ok"); }
 
+/** the optional paging parameters of list_instruments/list_presets: ":offset,limit,filter" (all parts are optional) */
+void parseListParameters(char *params, uint32_t &offset, uint32_t &limit, const char *&filter)
+{
+    offset = 0;
+    limit = UINT32_MAX;
+    filter = nullptr;
+    if (*params != ':') return;
+    char* endptr;
+    offset = std::strtoul(params + 1, &endptr, 10);
+    if (*endptr != ',') return;
+    limit = std::strtoul(endptr + 1, &endptr, 10);
+    if (*endptr != ',') return;
+    filter = endptr + 1;
+}
+
 void processSerialCommand()
 {
     if (USerial.available() <= 0) return;
@@ -157,8 +174,11 @@ void processSerialCommand()
             USerialSendAck_KO();
             return;
         }
+        uint32_t offset, limit;
+        const char *filter;
+        parseListParameters(&serialRxBuffer[16], offset, limit, filter);
         long startTime = micros();
-        sf22aswt.PrintInstrumentListAsJson(USerial);
+        sf22aswt.PrintInstrumentListAsJson(USerial, offset, limit, filter);
         long endTime = micros();
         USerial.print("list instruments took: ");
         USerial.print((float)(endTime-startTime)/1000.0f);
@@ -171,8 +191,11 @@ void processSerialCommand()
             USerialSendAck_KO();
             return;
         }
+        uint32_t offset, limit;
+        const char *filter;
+        parseListParameters(&serialRxBuffer[12], offset, limit, filter);
         long startTime = micros();
-        sf22aswt.PrintPresetListAsJson(USerial);
+        sf22aswt.PrintPresetListAsJson(USerial, offset, limit, filter);
         long endTime = micros();
         USerial.print("list presets took: ");
         USerial.print((float)(endTime-startTime)/1000.0f);
@@ -227,19 +250,10 @@ void processSerialCommand()
         USerial.print("load instrument sample data took: ");
         USerial.print((float)(endTime-startTime)/1000.0f);
         USerial.println(" ms");
-        // copy the old instrument_data pointer so we can delete the used data later
-        AudioSynthWavetable::instrument_data *wt_inst_old = WaveTableSynth::wt_inst;
-
-        WaveTableSynth::wt_inst = new AudioSynthWavetable::instrument_data(SF22ASWT::converter::to_AudioSynthWavetable_instrument_data(inst_temp));
-        WaveTableSynth::SetInstrument(*WaveTableSynth::wt_inst);
-        // delete prev inst data if exists
-        // Check if wt_inst_old is not nullptr and delete the memory it's pointing to
-        if(wt_inst_old != nullptr)
-        {
-            USerial.println("deleting prev inst.");
-            delete wt_inst_old;
-            wt_inst_old = nullptr; // It's a good practice to set deleted pointers to nullptr
-        }
+        // the new instrument is swapped in while the previous one is still playing,
+        // it's freed by WaveTableSynth::instrument.Service() when no voice uses it anymore
+        WaveTableSynth::instrument.setShadow(sf22aswt, inst_temp, index);
+        WaveTableSynth::instrument.Swap();
 
         USerial.println("json:{'cmd':'instrument_loaded'}");
     }
@@ -261,26 +275,15 @@ void processSerialCommand()
         USerial.print("trying to load file:"); USerial.println(&serialRxBuffer[26+6]);
         USerial.print("instrument index:"); USerial.println(instrumentIndex);
 
-        // copy the old instrument_data pointer so we can delete the used data later
-        AudioSynthWavetable::instrument_data *wt_inst_old = WaveTableSynth::wt_inst;
-        
-        if (sf22aswt.Load_instrument_from_file(&serialRxBuffer[26+6], instrumentIndex, &WaveTableSynth::wt_inst) == false)
+        if (sf22aswt.ReadFile(&serialRxBuffer[26+6]) == false || WaveTableSynth::instrument.Prefetch(sf22aswt, instrumentIndex) == false)
         {
             USerial.println("load_first_instrument_from_file error!");
+            sf22aswt.printSF2ErrorInfo(USerial);
             USerialSendAck_KO();
             return;
         }
-        
-        WaveTableSynth::SetInstrument(*WaveTableSynth::wt_inst);
-        // delete prev inst data if exists
-        // Check if wt_inst_old is not nullptr and delete the memory it's pointing to
-        if(wt_inst_old != nullptr)
-        {
-            USerial.println("deleting prev instrument data");
-            delete[] wt_inst_old->samples;
-            delete wt_inst_old;
-            wt_inst_old = nullptr; // It's a good practice to set deleted pointers to nullptr
-        }
+        // the previous instrument is freed by WaveTableSynth::instrument.Service() when no voice uses it anymore
+        WaveTableSynth::instrument.Swap();
         USerial.println("load_first_instrument_from_file OK");
         long endTime = micros();
         USerial.print("  took: ");
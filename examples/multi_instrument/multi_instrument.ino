@@ -1,6 +1,7 @@
 #include <Arduino.h>
 #include <Audio.h>
 #include <sf22aswt.h>
+#include <sf22aswt_instrument_slot.h>
 
 #define USerial Serial
 
@@ -8,13 +9,15 @@ SF22ASWTreader sf22aswt_reader1;
 SF22ASWTreader sf22aswt_reader2;
 SF22ASWTreader sf22aswt_reader3;
 
-AudioSynthWavetable::instrument_data* sf22aswt_reader1_inst;
-AudioSynthWavetable::instrument_data* sf22aswt_reader2_inst;
-AudioSynthWavetable::instrument_data* sf22aswt_reader3_inst;
-
 AudioSynthWavetable wavetable1;
 AudioSynthWavetable wavetable2;
 AudioSynthWavetable wavetable3;
+
+// each slot holds the instrument of one wavetable
+SF22ASWT::InstrumentSlot instrument1;
+SF22ASWT::InstrumentSlot instrument2;
+SF22ASWT::InstrumentSlot instrument3;
+
 AudioMixer4 mixer;
 
 AudioControlSGTL5000 outputCtrl;
@@ -45,6 +48,9 @@ void usbMidi_NoteOff(byte channel, byte note, byte velocity) {
 
 void LoadInstruments()
 {
+    // keep the file open between the loads,
+    // the clones below shares the same file handle
+    sf22aswt_reader1.setKeepFileOpen(true);
     if (sf22aswt_reader1.ReadFile("gm.sf2") == false)
     {
         USerial.println("Fail to load soundfont file gm.sf2");
@@ -56,66 +62,28 @@ void LoadInstruments()
     sf22aswt_reader1.CloneInto(sf22aswt_reader2);
     sf22aswt_reader1.CloneInto(sf22aswt_reader3);
 
+    instrument1.setVoices(&wavetable1, 1);
+    instrument2.setVoices(&wavetable2, 1);
+    instrument3.setVoices(&wavetable3, 1);
+
     // here we can load three different instruments:
 
-    // As a best practice, it's important to highlight that I utilize wt_inst_old
-    // to retain the pointer to the old instrument data.
-    // to be able to delete it's data later
-    // This precaution is necessary as the wavetable might still rely on the old data. 
-    // By doing so, we mitigate the risk of potential crashes.
-    // we could off course disable interrupts at this point but as 
-    // the Load_instrument_from_open_file takes some time to execute it's best not to
-    // note that this practice is only needed if the instruments are to be changed at runtime
-    
-    
+    // each instrument is first loaded into the shadow slot and then swapped in,
+    // the previous instrument (if any) is kept until the wavetable is not playing it anymore
+    // and is then freed by Service() in loop(), so instruments can be changed at runtime
+    // without the risk that the wavetable uses freed data
+
     // instrument 0
-    
-    AudioSynthWavetable::instrument_data *wt_inst_old = sf22aswt_reader1_inst;
-    if (sf22aswt_reader1.Load_instrument(0, sf22aswt_reader1_inst) == true)
-    {
-        wavetable1.setInstrument(*sf22aswt_reader1_inst);
-        if(wt_inst_old != nullptr)
-        {
-            delete wt_inst_old;
-            wt_inst_old = nullptr; // It's a good practice to set deleted pointers to nullptr
-        }
-    }
-    else
-    {
+    if (instrument1.Prefetch(sf22aswt_reader1, 0) == false || instrument1.Swap() == false)
         USerial.println("Fail to load instrument 0");
-    }
 
     // instrument 1
-    wt_inst_old = sf22aswt_reader2_inst;
-    if (sf22aswt_reader2.Load_instrument(1, sf22aswt_reader2_inst) == true)
-    {
-        wavetable1.setInstrument(*sf22aswt_reader2_inst);
-        if(wt_inst_old != nullptr)
-        {
-            delete wt_inst_old;
-            wt_inst_old = nullptr; // It's a good practice to set deleted pointers to nullptr
-        }
-    }
-    else
-    {
+    if (instrument2.Prefetch(sf22aswt_reader2, 1) == false || instrument2.Swap() == false)
         USerial.println("Fail to load instrument 1");
-    }
 
     // instrument 2
-    wt_inst_old = sf22aswt_reader3_inst;
-    if (sf22aswt_reader3.Load_instrument(2, sf22aswt_reader3_inst) == true)
-    {
-        wavetable1.setInstrument(*sf22aswt_reader3_inst);
-        if(wt_inst_old != nullptr)
-        {
-            delete wt_inst_old;
-            wt_inst_old = nullptr; // It's a good practice to set deleted pointers to nullptr
-        }
-    }
-    else
-    {
+    if (instrument3.Prefetch(sf22aswt_reader3, 2) == false || instrument3.Swap() == false)
         USerial.println("Fail to load instrument 2");
-    }
 }
 
 void setup()
@@ -140,4 +108,7 @@ void setup()
 void loop()
 {
     usbMIDI.read();
+    instrument1.Service();
+    instrument2.Service();
+    instrument3.Service();
 }
\ No newline at end of file
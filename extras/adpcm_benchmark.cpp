@@ -0,0 +1,74 @@
+/**
+ * host benchmark of the ADPCM codec (src/sf22aswt_adpcm.h)
+ *
+ * build and run from the library root:
+ *   g++ -O2 -Isrc extras/adpcm_benchmark.cpp src/sf22aswt_adpcm.cpp -o adpcm_benchmark && ./adpcm_benchmark
+ *
+ * prints the encode/decode time per block and the signal to noise ratio of a test signal
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include "sf22aswt_adpcm.h"
+
+using namespace SF22ASWT;
+
+#define SAMPLE_COUNT (1024*1024)
+#define ROUNDS 20
+
+static double now_ns()
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main()
+{
+    int16_t *in = new int16_t[SAMPLE_COUNT];
+    int16_t *out = new int16_t[SAMPLE_COUNT];
+    uint8_t *encoded = new uint8_t[Adpcm::getEncodedSize(SAMPLE_COUNT)];
+    size_t blocks = Adpcm::getBlockCount(SAMPLE_COUNT);
+
+    // a decaying tone with some harmonics and noise, like a typical instrument sample
+    srand(1);
+    for (int i=0;i<SAMPLE_COUNT;i++)
+    {
+        double t = i / 44100.0;
+        double v = sin(2*M_PI*440*t) + 0.5*sin(2*M_PI*880*t) + 0.25*sin(2*M_PI*1320*t);
+        v = v * 12000 * exp(-t * 0.5) + (rand() % 200 - 100);
+        in[i] = (int16_t)v;
+    }
+
+    double start = now_ns();
+    for (int r=0;r<ROUNDS;r++)
+        for (size_t b=0;b<blocks;b++)
+        {
+            size_t count = SAMPLE_COUNT - b*SF22ASWT_ADPCM_BLOCK_SAMPLES;
+            if (count > SF22ASWT_ADPCM_BLOCK_SAMPLES) count = SF22ASWT_ADPCM_BLOCK_SAMPLES;
+            Adpcm::EncodeBlock(in + b*SF22ASWT_ADPCM_BLOCK_SAMPLES, count, encoded + b*Adpcm::BlockSize);
+        }
+    double encodeNs = (now_ns() - start) / (ROUNDS * blocks);
+
+    start = now_ns();
+    for (int r=0;r<ROUNDS;r++)
+        Adpcm::Decode(encoded, out, SAMPLE_COUNT);
+    double decodeNs = (now_ns() - start) / (ROUNDS * blocks);
+
+    double signal = 0, noise = 0;
+    for (int i=0;i<SAMPLE_COUNT;i++)
+    {
+        signal += (double)in[i] * in[i];
+        noise += (double)(in[i] - out[i]) * (in[i] - out[i]);
+    }
+    double blockBytes = SF22ASWT_ADPCM_BLOCK_SAMPLES * sizeof(int16_t);
+
+    printf("block: %d samples, %u bytes (ratio %.2f)\n", SF22ASWT_ADPCM_BLOCK_SAMPLES, (unsigned)Adpcm::BlockSize, blockBytes / Adpcm::BlockSize);
+    printf("encode: %.0f ns/block (%.1f MB/s)\n", encodeNs, blockBytes / encodeNs * 1000);
+    printf("decode: %.0f ns/block (%.1f MB/s)\n", decodeNs, blockBytes / decodeNs * 1000);
+    printf("SNR: %.1f dB\n", 10 * log10(signal / noise));
+
+    delete[] in;
+    delete[] out;
+    delete[] encoded;
+    return 0;
+}
@@ -0,0 +1,48 @@
+/**
+ * host build of the library (the POSIX storage backend and src/sf22aswt_platform_host.h)
+ *
+ * build and run from the library root:
+ *   g++ -std=gnu++17 -O2 -Wall -Wextra -Wno-unknown-pragmas -Isrc extras/host_example.cpp src/sf22aswt_*.cpp -o host_example && ./host_example <file.sf2> [instrument]
+ * or with PlatformIO:
+ *   pio run -e native && .pio/build/native/program <file.sf2> [instrument]
+ *
+ * prints the info block and the instrument/preset lists of the file,
+ * then loads the instrument (0 by default) with the sample data and prints its zones
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "sf22aswt.h"
+
+using namespace SF22ASWT;
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("usage: %s <file.sf2> [instrument]\n", argv[0]);
+        return 1;
+    }
+    int instrumentIndex = (argc > 2) ? atoi(argv[2]) : 0;
+
+    ReaderLazy reader;
+    if (reader.ReadFile(argv[1]) == false) {
+        reader.printSF2ErrorInfo(Serial);
+        return 1;
+    }
+    reader.PrintInfoBlock(Serial);
+    reader.PrintInstrumentListAsJson(Serial);
+    reader.PrintPresetListAsJson(Serial);
+
+    instrument_data_temp inst = {0, nullptr, nullptr};
+    if (reader.Load_instrument_data(instrumentIndex, inst) == false || reader.ReadSampleDataFromFile(inst) == false) {
+        reader.printSF2ErrorInfo(Serial);
+        return 1;
+    }
+    printf("instrument %d: %d zones, %d bytes of sample data\n", instrumentIndex, inst.sample_count, samples_usedRam);
+    for (int i=0;i<inst.sample_count;i++)
+    {
+        const sample_header_temp &sample = inst.samples[i];
+        printf("  zone %d: keys up to %d, root %d, %d samples at %.0f Hz, loop %s %d-%d\n", i, inst.sample_note_ranges[i],
+            sample.SAMPLE_NOTE, sample.LENGTH, sample.SAMPLE_RATE, sample.LOOP ? "on" : "off", sample.LOOP_START, sample.LOOP_END);
+    }
+    return 0;
+}
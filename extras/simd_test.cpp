@@ -0,0 +1,200 @@
+/**
+ * host test of the SIMD versions of the sample processing (src/sf22aswt_sm24.h, src/sf22aswt_stereo.h)
+ * and of the resampler (src/sf22aswt_resampler.h)
+ *
+ * build and run from the library root:
+ *   g++ -std=gnu++17 -O2 -Wall -Wextra -Wno-unknown-pragmas -Isrc extras/simd_test.cpp src/sf22aswt_*.cpp -o simd_test && ./simd_test
+ * (-mno-sse2 don't work on x86-64, on a ARM host the NEON versions are tested instead of SSE2)
+ *
+ * Sm24::Merge and Stereo::Downmix of the library (the SIMD version of the host) are compared with
+ * the portable versions, these are compiled into this file from the same sources with SF22ASWT_*_NO_SIMD,
+ * with random data of all lengths up to a few groups so that all tail lengths are covered
+ * the resampler is checked for a chunked resampling that gives the same result as a single Process,
+ * and the loop/length mapping of ReaderBase::getResampled for a seamless loop
+ * prints the failed checks and returns 1 if any check failed
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sf22aswt.h"
+
+// the portable versions, the namespaces are renamed so that they can be linked together with the library
+namespace SF22ASWT::Sm24Scalar { using Sm24::Dither; }
+#define SF22ASWT_SM24_NO_SIMD
+#define SF22ASWT_STEREO_NO_SIMD
+#define Sm24 Sm24Scalar
+#define Stereo StereoScalar
+#include "sf22aswt_sm24.cpp"
+#include "sf22aswt_stereo.cpp"
+#undef Sm24
+#undef Stereo
+
+using namespace SF22ASWT;
+
+static int checks = 0;
+static int fails = 0;
+
+static void check(bool ok, const char *what, int a, int b)
+{
+    checks++;
+    if (ok) return;
+    if (fails < 20) printf("FAIL %s (%d, %d)\n", what, a, b);
+    fails++;
+}
+
+static uint32_t rngState = 12345;
+static uint32_t rnd()
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+/** random samples where every 4th is at the limits, so that the saturation is tested */
+static int16_t rndSample()
+{
+    uint32_t r = rnd();
+    if ((r & 3) == 0) return (r & 4) ? 32767 : -32768;
+    return (int16_t)(r >> 8);
+}
+
+/** exposes the protected resampling of the reader */
+class TestReader : public ReaderLazy
+{
+  public:
+    using ReaderBase::getResampled;
+};
+
+#define MAX_COUNT 200
+
+static void testSm24()
+{
+    int16_t simd[MAX_COUNT + 1], scalar[MAX_COUNT + 1];
+    uint8_t low[MAX_COUNT + 1];
+    Sm24::Dither simdDither, scalarDither;
+    for (int round=0;round<20;round++)
+    {
+        for (int count=0;count<=MAX_COUNT;count++)
+        {
+            // odd offsets gives unaligned loads and stores
+            int offset = count & 1;
+            for (int i=0;i<count+offset;i++) { simd[i] = scalar[i] = rndSample(); low[i] = (uint8_t)rnd(); }
+            // the dither state continues over the calls like when a sample is merged a chunk at a time
+            Sm24::Merge(simd + offset, low + offset, count, simdDither);
+            Sm24Scalar::Merge(scalar + offset, low + offset, count, scalarDither);
+            for (int i=0;i<count+offset;i++) check(simd[i] == scalar[i], "sm24 merge", count, i);
+            check(memcmp(simdDither.state, scalarDither.state, sizeof(simdDither.state)) == 0, "sm24 dither state", count, 0);
+        }
+    }
+}
+
+static void testStereo()
+{
+    int16_t simd[MAX_COUNT + 1], scalar[MAX_COUNT + 1], right[MAX_COUNT + 1];
+    for (int round=0;round<20;round++)
+    {
+        for (int count=0;count<=MAX_COUNT;count++)
+        {
+            int offset = count & 1;
+            for (int i=0;i<count+offset;i++) { simd[i] = scalar[i] = rndSample(); right[i] = rndSample(); }
+            Stereo::Downmix(simd + offset, right + offset, count);
+            StereoScalar::Downmix(scalar + offset, right + offset, count);
+            for (int i=0;i<count+offset;i++) check(simd[i] == scalar[i], "stereo downmix", count, i);
+        }
+    }
+}
+
+/** resamples in (length samples, silence outside) in parts of at most chunk output samples the same way as the reader does */
+static void resampleChunked(const int16_t *in, int length, int16_t *out, int outLength, uint64_t step, int chunk)
+{
+    static int16_t window[4096];
+    for (int o=0;o<outLength;o+=chunk)
+    {
+        int n = ((outLength - o) > chunk) ? chunk : (outLength - o);
+        int first = Resampler::getFirstInput(o, step);
+        int last = Resampler::getLastInput(o + n - 1, step);
+        for (int i=first;i<=last;i++) window[i - first] = (i >= 0 && i < length) ? in[i] : 0;
+        Resampler::Process(window, first, out + o, o, n, step);
+    }
+}
+
+static void testResampler()
+{
+    static int16_t in[3000], whole[3000], chunked[3000];
+    const double ratios[] = { 0.5, 44100.0/48000.0, 44100.0/96000.0, 0.73 };
+    for (double ratio : ratios)
+    {
+        if (Resampler::Init(ratio) == false) { check(false, "resampler init", 0, 0); return; }
+        uint64_t step = Resampler::getStep(ratio);
+        for (int length=Resampler::Taps;length<2000;length+=97)
+        {
+            for (int i=0;i<length;i++) in[i] = rndSample() / 4;
+            int outLength = (int)ceil(length * ratio);
+            resampleChunked(in, length, whole, outLength, step, outLength);
+            for (int chunk : { 1, 7, 64, 333 })
+            {
+                resampleChunked(in, length, chunked, outLength, step, chunk);
+                for (int i=0;i<outLength;i++) check(chunked[i] == whole[i], "resampler chunked", length, i);
+            }
+        }
+    }
+
+    TestReader reader;
+    const float rates[] = { 44100, 48000, 96000, 32000 };
+    for (int round=0;round<200;round++)
+    {
+        sample_header_temp sample = {};
+        sample.SAMPLE_RATE = rates[rnd() % 4];
+        sample.LENGTH = 100 + rnd() % 2000;
+        sample.LOOP = (rnd() & 1);
+        sample.LOOP_START = rnd() % (sample.LENGTH / 2);
+        sample.LOOP_END = sample.LOOP_START + 40 + rnd() % (sample.LENGTH - sample.LOOP_START - 40);
+        float targetRate = (round & 1) ? 22050 : 44100;
+        reader.setResampleRate(targetRate);
+
+        sample_header_temp resampled;
+        uint64_t step = 0;
+        if (reader.getResampled(sample, false, resampled, step) == false) {
+            check(sample.SAMPLE_RATE <= targetRate, "resampled when the rate is higher", (int)sample.SAMPLE_RATE, (int)targetRate);
+            continue;
+        }
+        double ratio = 4294967296.0 / step;
+        int loopLength = sample.LOOP_END - sample.LOOP_START;
+        int newLoopLength = resampled.LOOP_END - resampled.LOOP_START;
+        // the loop length is rounded to whole samples, the rate follows it
+        double maxRate = targetRate + (sample.LOOP ? (sample.SAMPLE_RATE * 0.5 / loopLength) : 0) + 0.5;
+        check(resampled.SAMPLE_RATE <= maxRate, "resampled rate", (int)resampled.SAMPLE_RATE, (int)targetRate);
+        check(fabs(resampled.SAMPLE_RATE - sample.SAMPLE_RATE * ratio) < 0.01 * sample.SAMPLE_RATE, "resampled rate matches the step", (int)resampled.SAMPLE_RATE, round);
+        check(resampled.LENGTH >= (int)ceil(sample.LENGTH * ratio - 0.01), "resampled length", resampled.LENGTH, sample.LENGTH);
+        check(resampled.LENGTH > resampled.LOOP_END, "resampled loop inside the sample", resampled.LENGTH, resampled.LOOP_END);
+        check(abs(resampled.LOOP_START - (int)(sample.LOOP_START * ratio + 0.5)) <= 1, "resampled loop start", resampled.LOOP_START, sample.LOOP_START);
+        if (sample.LOOP == false) continue;
+        check(newLoopLength == (int)(loopLength * ratio + 0.5), "resampled loop length", newLoopLength, loopLength);
+        // the new loop steps over exactly the old loop, so the pitch is exact
+        int64_t loopError = (int64_t)(newLoopLength * step) - ((int64_t)loopLength << 32);
+        check(llabs(loopError) <= newLoopLength, "resampled loop step", newLoopLength, loopLength);
+
+        // a input that repeats every loop gives a output that repeats every new loop (the loop is seamless)
+        if (Resampler::Init(ratio) == false) { check(false, "resampler init", 0, 0); return; }
+        for (int i=0;i<sample.LENGTH;i++)
+        {
+            double t = 2 * M_PI * ((i - sample.LOOP_START + loopLength * 64) % loopLength) / loopLength;
+            in[i] = (int16_t)(8000 * sin(t) + 4000 * sin(2 * t + 1));
+        }
+        resampleChunked(in, sample.LENGTH, whole, resampled.LENGTH, step, resampled.LENGTH);
+        // away from the ends of the sample where the filter sees the silence
+        for (int i=Resampler::Taps;i+newLoopLength<resampled.LENGTH-Resampler::Taps;i++)
+            check(abs(whole[i + newLoopLength] - whole[i]) <= 64, "resampled loop seamless", round, i);
+    }
+    Resampler::Free();
+}
+
+int main()
+{
+    testSm24();
+    testStereo();
+    testResampler();
+    printf("%d checks, %d failed\n", checks, fails);
+    return (fails == 0) ? 0 : 1;
+}
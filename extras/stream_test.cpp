@@ -0,0 +1,198 @@
+/**
+ * host test of the sample streaming (src/sf22aswt_sample_stream.h) with a simulated SD card
+ *
+ * build and run from the library root:
+ *   g++ -std=gnu++17 -O2 -Wall -Wextra -Wno-unknown-pragmas -DSF22ASWT_STORAGE_SIMULATED_LATENCY_US=1000 -DSF22ASWT_STORAGE_SIMULATED_KB_PER_SEC=2000 -Isrc extras/stream_test.cpp src/sf22aswt_*.cpp -o stream_test && ./stream_test
+ *
+ * writes a small sf2 file with a long sample (stream_test.sf2 in the current directory, removed at the end)
+ * and plays it with a StreamVoice in real time, the audio blocks are rendered when they are due
+ * by the clock and SampleStreamer::Service is called in between like from loop(),
+ * so every file read takes the simulated access time of the POSIX backend
+ * the output is compared with the sample (linear interpolation at the playback rate),
+ * first without underruns and then with a stall of the service that is longer than the ring buffer,
+ * where the output must be the sample again after the reading have continued at the playhead
+ * prints the failed checks and returns 1 if any check failed
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include "sf22aswt.h"
+
+using namespace SF22ASWT;
+
+static int checks = 0;
+static int fails = 0;
+
+static void check(bool ok, const char *what, int a, int b)
+{
+    checks++;
+    if (ok) return;
+    if (fails < 20) printf("FAIL %s (%d, %d)\n", what, a, b);
+    fails++;
+}
+
+#define TEST_FILE "stream_test.sf2"
+#define SAMPLE_RATE 44100
+/** 1.5 s, much longer than the head and the ring buffer */
+#define SAMPLE_LENGTH 66150
+#define ROOT_NOTE 60
+
+static std::vector<int16_t> source;
+
+#pragma region sf2 writer
+static void put16(std::vector<uint8_t> &d, uint16_t v) { d.push_back(v & 0xFF); d.push_back(v >> 8); }
+static void put32(std::vector<uint8_t> &d, uint32_t v) { put16(d, v & 0xFFFF); put16(d, v >> 16); }
+static void putName(std::vector<uint8_t> &d, const char *name) { char buf[20] = {}; strncpy(buf, name, 19); d.insert(d.end(), buf, buf + 20); }
+static void putChunk(std::vector<uint8_t> &d, const char *id, const std::vector<uint8_t> &data)
+{
+    d.insert(d.end(), id, id + 4);
+    put32(d, data.size());
+    d.insert(d.end(), data.begin(), data.end());
+    if (data.size() & 1) d.push_back(0);
+}
+static void putList(std::vector<uint8_t> &d, const char *type, const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> list(type, type + 4);
+    list.insert(list.end(), data.begin(), data.end());
+    putChunk(d, "LIST", list);
+}
+
+/** one preset, one instrument with one zone that plays the whole sample (no loop) */
+static bool writeTestFile()
+{
+    source.resize(SAMPLE_LENGTH);
+    for (int i=0;i<SAMPLE_LENGTH;i++)
+        source[i] = (int16_t)(12000 * sin(2 * M_PI * 220 * i / SAMPLE_RATE) + 6000 * sin(2 * M_PI * 37 * i / SAMPLE_RATE + 1));
+
+    std::vector<uint8_t> info, sdta, pdta, chunk;
+    chunk.clear(); put16(chunk, 2); put16(chunk, 1); putChunk(info, "ifil", chunk);
+    chunk.assign({'E','M','U','8','0','0','0',0}); putChunk(info, "isng", chunk);
+    chunk.assign({'S','t','r','e','a','m',0,0}); putChunk(info, "INAM", chunk);
+
+    chunk.clear();
+    for (int16_t s : source) put16(chunk, s);
+    for (int i=0;i<46;i++) put16(chunk, 0); // the 46 zero samples after every sample
+    putChunk(sdta, "smpl", chunk);
+
+    chunk.clear(); putName(chunk, "stream"); put16(chunk, 0); put16(chunk, 0); put16(chunk, 0); put32(chunk, 0); put32(chunk, 0); put32(chunk, 0);
+    putName(chunk, "EOP"); put16(chunk, 0); put16(chunk, 0); put16(chunk, 1); put32(chunk, 0); put32(chunk, 0); put32(chunk, 0);
+    putChunk(pdta, "phdr", chunk);
+    chunk.clear(); put16(chunk, 0); put16(chunk, 0); put16(chunk, 1); put16(chunk, 0); putChunk(pdta, "pbag", chunk);
+    chunk.assign(10, 0); putChunk(pdta, "pmod", chunk);
+    chunk.clear(); put16(chunk, (uint16_t)SFGenerator::instrument); put16(chunk, 0); put32(chunk, 0); putChunk(pdta, "pgen", chunk);
+    chunk.clear(); putName(chunk, "stream"); put16(chunk, 0); putName(chunk, "EOI"); put16(chunk, 1); putChunk(pdta, "inst", chunk);
+    chunk.clear(); put16(chunk, 0); put16(chunk, 0); put16(chunk, 1); put16(chunk, 0); putChunk(pdta, "ibag", chunk);
+    chunk.assign(10, 0); putChunk(pdta, "imod", chunk);
+    chunk.clear(); put16(chunk, (uint16_t)SFGenerator::sampleID); put16(chunk, 0); put32(chunk, 0); putChunk(pdta, "igen", chunk);
+    chunk.clear();
+    putName(chunk, "long"); put32(chunk, 0); put32(chunk, SAMPLE_LENGTH); put32(chunk, 0); put32(chunk, 0); put32(chunk, SAMPLE_RATE);
+    chunk.push_back(ROOT_NOTE); chunk.push_back(0); put16(chunk, 0); put16(chunk, 1);
+    putName(chunk, "EOS"); put32(chunk, 0); put32(chunk, 0); put32(chunk, 0); put32(chunk, 0); put32(chunk, 0); chunk.push_back(0); chunk.push_back(0); put16(chunk, 0); put16(chunk, 0);
+    putChunk(pdta, "shdr", chunk);
+
+    std::vector<uint8_t> sfbk = {'s','f','b','k'};
+    putList(sfbk, "INFO", info);
+    putList(sfbk, "sdta", sdta);
+    putList(sfbk, "pdta", pdta);
+    std::vector<uint8_t> riff;
+    putChunk(riff, "RIFF", sfbk);
+
+    FILE *f = fopen(TEST_FILE, "wb");
+    if (f == nullptr) return false;
+    bool ok = fwrite(riff.data(), 1, riff.size(), f) == riff.size();
+    return (fclose(f) == 0) && ok;
+}
+#pragma endregion
+
+/** the sample at the playback position of output sample i (the voice plays the root note with full gain) */
+static int expected(int i)
+{
+    double pos = i * (SAMPLE_RATE / (double)AUDIO_SAMPLE_RATE_EXACT);
+    int index = (int)pos;
+    int a = (index < SAMPLE_LENGTH) ? source[index] : 0;
+    int b = (index + 1 < SAMPLE_LENGTH) ? source[index + 1] : 0;
+    return (int)lround(a + (b - a) * (pos - index));
+}
+
+/**
+ * plays the sample in real time, Service is not called while the audio clock is in [stallStartMs, stallEndMs)
+ * returns the underruns of the voice
+ */
+static uint32_t play(const StreamedInstrument &instrument, const char *name, int stallStartMs, int stallEndMs)
+{
+    static StreamVoice voice;
+    voice.setInstrument(instrument);
+    SampleStreamer::AddVoice(voice);
+    uint32_t underrunsBefore = voice.getUnderruns();
+    voice.playNote(ROOT_NOTE, 127);
+
+    // the blocks during the stall can be partly silent, after it the reading continues at the playhead
+    // so the output is the sample again after the first read (about a block), not when the missed part is read
+    int stallFirstBlock = (int)(stallStartMs * AUDIO_SAMPLE_RATE_EXACT / 1000 / AUDIO_BLOCK_SAMPLES);
+    int recoveredBlock = (int)(stallEndMs * AUDIO_SAMPLE_RATE_EXACT / 1000 / AUDIO_BLOCK_SAMPLES) + 2;
+    int blocks = 0, differing = 0, differingAfterStall = 0;
+    int16_t out[AUDIO_BLOCK_SAMPLES];
+    uint32_t start = micros();
+    while (voice.isPlaying())
+    {
+        uint32_t ms = (micros() - start) / 1000;
+        bool stalled = (ms >= (uint32_t)stallStartMs && ms < (uint32_t)stallEndMs);
+        if (stalled || SampleStreamer::Service(1) == 0) delay(1);
+
+        // the blocks that are due by the audio clock
+        int due = (int)((micros() - start) * (double)AUDIO_SAMPLE_RATE_EXACT / 1e6 / AUDIO_BLOCK_SAMPLES);
+        for (;blocks<due && voice.isPlaying();blocks++)
+        {
+            voice.render(out, AUDIO_BLOCK_SAMPLES);
+            bool same = true;
+            for (int i=0;i<AUDIO_BLOCK_SAMPLES && same;i++)
+            {
+                int pos = blocks*AUDIO_BLOCK_SAMPLES + i;
+                if (pos * (SAMPLE_RATE / (double)AUDIO_SAMPLE_RATE_EXACT) >= SAMPLE_LENGTH) break; // the end is silence
+                same = abs(out[i] - expected(pos)) <= 2;
+            }
+            if (same) continue;
+            if (blocks < stallFirstBlock) check(false, name, blocks, -1);
+            else if (blocks >= recoveredBlock) differingAfterStall++;
+            differing++;
+        }
+    }
+    SampleStreamer::RemoveVoice(voice);
+    uint32_t underruns = voice.getUnderruns() - underrunsBefore;
+    int expectedBlocks = (int)(SAMPLE_LENGTH * AUDIO_SAMPLE_RATE_EXACT / SAMPLE_RATE / AUDIO_BLOCK_SAMPLES);
+    check(blocks >= expectedBlocks, "the whole sample is played", blocks, expectedBlocks);
+    check(differingAfterStall == 0, "the output is the sample after the stall", differingAfterStall, recoveredBlock);
+    printf("%s: %d blocks, %d differs from the sample, %u underruns\n", name, blocks, differing, underruns);
+    return underruns;
+}
+
+int main()
+{
+#if SF22ASWT_STORAGE_SIMULATED_LATENCY_US == 0
+    printf("note. built without SF22ASWT_STORAGE_SIMULATED_LATENCY_US, the reads are not slowed down\n");
+#endif
+    if (writeTestFile() == false) { printf("could not write %s\n", TEST_FILE); return 1; }
+
+    ReaderLazy reader;
+    instrument_data_temp inst = {0, nullptr, nullptr};
+    StreamedInstrument streamed;
+    if (reader.ReadFile(TEST_FILE) == false || reader.Load_instrument_data(0, inst) == false || reader.ReadSampleDataStreamed(inst, streamed) == false) {
+        reader.printSF2ErrorInfo(Serial);
+        remove(TEST_FILE);
+        return 1;
+    }
+    check(streamed.samples[0].streamEnd > streamed.samples[0].headLength + SF22ASWT_STREAM_RING_SAMPLES, "the sample is streamed", streamed.samples[0].streamEnd, streamed.samples[0].headLength);
+
+    uint32_t underruns = play(streamed, "serviced", 100000, 100000);
+    check(underruns == 0, "no underruns when serviced", underruns, 0);
+    // longer than the ring buffer (SF22ASWT_STREAM_RING_SAMPLES is about 190 ms) so that the playhead passes the read data
+    underruns = play(streamed, "stalled", 500, 900);
+    check(underruns > 0, "underruns when the service is stalled", underruns, 0);
+
+    streamed.Free();
+    remove(TEST_FILE);
+    printf("%d checks, %d failed\n", checks, fails);
+    return (fails == 0) ? 0 : 1;
+}
@@ -1,12 +1,13 @@
 #pragma once
 
+// define SF22ASWT_USE_FULL_READER before including this file to use SF22ASWT::Reader
+// which keeps all instrument/preset data (pdta) in ram (PSRAM if available)
+// so that loading of instruments only need file access for the sample data
+#ifndef SF22ASWT_USE_FULL_READER
 #define USE_LAZY_READER
+#endif
 
 #ifndef USE_LAZY_READER
-// using SF22ASWT::reader is currently not fully implemented
-// as both list_instruments and load_instrument is missing from 
-// sf22asw_reader.h, and is only included for future use
-// when more ram is available or for specific demands
 #include <sf22aswt_reader.h>
 #define SF22ASWTreader SF22ASWT::Reader
 #else
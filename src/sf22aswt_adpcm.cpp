@@ -0,0 +1,103 @@
+#include "sf22aswt_adpcm.h"
+
+namespace SF22ASWT::Adpcm
+{
+    static const int16_t stepTable[89] = {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+        50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+        337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+        2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+        15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+    };
+    static const int8_t indexTable[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+    /** updates the predictor and the step index with the code, the same for encode and decode */
+    static inline void step(int32_t &predictor, int32_t &index, uint8_t code)
+    {
+        int32_t stepSize = stepTable[index];
+        int32_t delta = stepSize >> 3;
+        if (code & 4) delta += stepSize;
+        if (code & 2) delta += stepSize >> 1;
+        if (code & 1) delta += stepSize >> 2;
+        predictor += (code & 8) ? -delta : delta;
+        if (predictor > 32767) predictor = 32767;
+        else if (predictor < -32768) predictor = -32768;
+        index += indexTable[code & 7];
+        if (index < 0) index = 0;
+        else if (index > 88) index = 88;
+    }
+
+    static inline uint8_t encodeSample(int32_t sample, int32_t &predictor, int32_t &index)
+    {
+        int32_t diff = sample - predictor;
+        uint8_t code = 0;
+        if (diff < 0) { code = 8; diff = -diff; }
+        int32_t stepSize = stepTable[index];
+        if (diff >= stepSize) { code |= 4; diff -= stepSize; }
+        stepSize >>= 1;
+        if (diff >= stepSize) { code |= 2; diff -= stepSize; }
+        stepSize >>= 1;
+        if (diff >= stepSize) code |= 1;
+        step(predictor, index, code);
+        return code;
+    }
+
+    void EncodeBlock(const int16_t *in, size_t count, uint8_t *block)
+    {
+        int32_t predictor = (count > 0) ? in[0] : 0;
+        // start with a step size that fits the first difference
+        int32_t index = 0;
+        if (count > 1) {
+            int32_t diff = in[1] - in[0];
+            if (diff < 0) diff = -diff;
+            while (index < 88 && stepTable[index] < diff) index++;
+        }
+        block[0] = (uint8_t)(predictor & 0xFF);
+        block[1] = (uint8_t)((predictor >> 8) & 0xFF);
+        block[2] = (uint8_t)index;
+        block[3] = 0;
+
+        uint8_t *codes = block + HeaderSize;
+        for (size_t i=0;i<SF22ASWT_ADPCM_BLOCK_SAMPLES;i+=2)
+        {
+            uint8_t low = encodeSample((i < count) ? in[i] : 0, predictor, index);
+            uint8_t high = encodeSample((i + 1 < count) ? in[i + 1] : 0, predictor, index);
+            *codes++ = low | (high << 4);
+        }
+    }
+
+    void DecodeBlock(const uint8_t *block, int16_t *out, size_t count)
+    {
+        int32_t predictor = (int16_t)(block[0] | (block[1] << 8));
+        int32_t index = block[2];
+        if (index > 88) index = 88;
+        const uint8_t *codes = block + HeaderSize;
+        if (count > SF22ASWT_ADPCM_BLOCK_SAMPLES) count = SF22ASWT_ADPCM_BLOCK_SAMPLES;
+
+        size_t i = 0;
+        for (;i+1<count;i+=2)
+        {
+            uint8_t code = *codes++;
+            step(predictor, index, code & 0x0F);
+            out[i] = (int16_t)predictor;
+            step(predictor, index, code >> 4);
+            out[i + 1] = (int16_t)predictor;
+        }
+        if (i < count) {
+            step(predictor, index, *codes & 0x0F);
+            out[i] = (int16_t)predictor;
+        }
+    }
+
+    void Decode(const uint8_t *blocks, int16_t *out, size_t count)
+    {
+        while (count > 0)
+        {
+            size_t n = (count > SF22ASWT_ADPCM_BLOCK_SAMPLES) ? SF22ASWT_ADPCM_BLOCK_SAMPLES : count;
+            DecodeBlock(blocks, out, n);
+            blocks += BlockSize;
+            out += n;
+            count -= n;
+        }
+    }
+}
@@ -0,0 +1,37 @@
+/**
+ * IMA ADPCM block codec used to keep samples compressed in PSRAM (see CompressedInstrument)
+ *
+ * every block of SF22ASWT_ADPCM_BLOCK_SAMPLES samples is independent (so blocks can be decoded in any order):
+ * a 4 byte header (the predictor as int16 and the step index) followed by one 4 bit code per sample
+ * with 256 samples per block that is 132 bytes instead of 512 bytes (3.9x)
+ *
+ * it has no Arduino dependencies so that it can be benchmarked on a host (see extras/adpcm_benchmark.cpp)
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef SF22ASWT_ADPCM_BLOCK_SAMPLES
+/** samples in every block, must be a multiple of 2 */
+#define SF22ASWT_ADPCM_BLOCK_SAMPLES 256
+#endif
+
+namespace SF22ASWT::Adpcm
+{
+    static_assert(SF22ASWT_ADPCM_BLOCK_SAMPLES % 2 == 0, "SF22ASWT_ADPCM_BLOCK_SAMPLES must be a multiple of 2");
+
+    constexpr size_t HeaderSize = 4;
+    constexpr size_t BlockSize = HeaderSize + SF22ASWT_ADPCM_BLOCK_SAMPLES / 2;
+
+    /** number of blocks needed for count samples */
+    constexpr size_t getBlockCount(size_t count) { return (count + SF22ASWT_ADPCM_BLOCK_SAMPLES - 1) / SF22ASWT_ADPCM_BLOCK_SAMPLES; }
+    constexpr size_t getEncodedSize(size_t count) { return getBlockCount(count) * BlockSize; }
+
+    /** encodes one block, count can be less than a full block, the rest is encoded as silence */
+    void EncodeBlock(const int16_t *in, size_t count, uint8_t *block);
+    /** decodes count (max SF22ASWT_ADPCM_BLOCK_SAMPLES) samples of one block */
+    void DecodeBlock(const uint8_t *block, int16_t *out, size_t count);
+    /** decodes count samples of the blocks that follow each other */
+    void Decode(const uint8_t *blocks, int16_t *out, size_t count);
+}
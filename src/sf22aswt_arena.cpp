@@ -0,0 +1,61 @@
+#include "sf22aswt_arena.h"
+
+namespace SF22ASWT
+{
+    void* Arena::Alloc(size_t size)
+    {
+        size = (size + Align - 1) & ~(Align - 1);
+        if (block == nullptr && used == 0 && capacity != 0)
+            block = (uint8_t*)malloc(capacity);
+
+        void *ptr = nullptr;
+        if (block != nullptr && size <= capacity - used)
+        {
+            ptr = block + used;
+            used += size;
+        }
+        else
+        {
+            Overflow *o = (Overflow*)malloc(OverflowHeaderSize + size);
+            if (o == nullptr) return nullptr;
+            o->next = overflow;
+            overflow = o;
+            overflowUsed += size;
+            overflowCount++;
+            ptr = (uint8_t*)o + OverflowHeaderSize;
+        }
+        if (used + overflowUsed > highWaterMark) highWaterMark = used + overflowUsed;
+        return ptr;
+    }
+
+    void Arena::Reset()
+    {
+        used = 0;
+        if (overflow == nullptr) return;
+
+        FreeOverflow();
+        // grow the block so that the next load of the same size fits into it
+        free(block);
+        block = nullptr;
+        capacity = highWaterMark;
+    }
+
+    void Arena::Free()
+    {
+        FreeOverflow();
+        free(block);
+        block = nullptr;
+        used = 0;
+    }
+
+    void Arena::FreeOverflow()
+    {
+        while (overflow != nullptr)
+        {
+            Overflow *next = overflow->next;
+            free(overflow);
+            overflow = next;
+        }
+        overflowUsed = 0;
+    }
+}
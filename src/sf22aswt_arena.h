@@ -0,0 +1,75 @@
+/**
+ * bump allocator for the temporary data of one instrument load
+ * (bags, gens, ibag indexes and optionally the instrument_data_temp arrays)
+ *
+ * everything is taken from one contiguous block that is kept between loads
+ * and released in O(1) by Reset, so loading instruments don't fragment the heap
+ * allocations that don't fit are placed in separately allocated overflow blocks,
+ * at the next Reset the overflow blocks are freed and the main block is grown to the high-water mark
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+#include <new>
+#include <type_traits>
+
+#ifndef SF22ASWT_LOAD_ARENA_SIZE
+/** initial size in bytes of the load arena, it grows to the high-water mark when a load don't fit */
+#define SF22ASWT_LOAD_ARENA_SIZE 4096
+#endif
+
+namespace SF22ASWT
+{
+    class Arena
+    {
+      public:
+        /** all allocations are aligned to this */
+        static const size_t Align = 8;
+
+        Arena(size_t initialCapacity = SF22ASWT_LOAD_ARENA_SIZE) : capacity(initialCapacity) {}
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+        ~Arena() { Free(); }
+
+        /** returns nullptr if out of memory, the block is allocated on first use */
+        void* Alloc(size_t size);
+        /** allocates and default constructs count items, T must not need a destructor as none is called */
+        template<class T> T* New(size_t count)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "arena items are never destructed");
+            T* items = (T*)Alloc(count*sizeof(T));
+            if (items == nullptr) return nullptr;
+            for (size_t i=0;i<count;i++) new (&items[i]) T();
+            return items;
+        }
+        /** releases all allocations, the block is kept for the next load */
+        void Reset();
+        /** releases all allocations and the block */
+        void Free();
+
+        /** bytes currently allocated (inclusive overflow blocks) */
+        size_t getUsed() { return used + overflowUsed; }
+        size_t getCapacity() { return capacity; }
+        /** the max bytes used by a single load, use it to set SF22ASWT_LOAD_ARENA_SIZE */
+        size_t getHighWaterMark() { return highWaterMark; }
+        /** number of allocations that did not fit into the block */
+        uint32_t getOverflowCount() { return overflowCount; }
+
+      private:
+        struct Overflow
+        {
+            Overflow *next;
+        };
+        static const size_t OverflowHeaderSize = (sizeof(Overflow) + Align - 1) & ~(Align - 1);
+
+        uint8_t *block = nullptr;
+        size_t capacity;
+        size_t used = 0;
+        Overflow *overflow = nullptr;
+        size_t overflowUsed = 0;
+        size_t highWaterMark = 0;
+        uint32_t overflowCount = 0;
+
+        void FreeOverflow();
+    };
+}
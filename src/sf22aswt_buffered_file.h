@@ -0,0 +1,224 @@
+/**
+ * block buffered read layer between the readers and the storage backend
+ *
+ * the readers do a lot of small (2, 4 and 22 byte) reads, on SD every read call
+ * have a fixed cost, so instead whole sectors are read into a buffer and the small
+ * reads (and seeks that land inside the buffered window) are served from memory
+ *
+ * the window always starts at a sector (512 byte) boundary, it starts at one sector
+ * after a random seek and is doubled (up to the buffer size) every time the next
+ * read continues where the previous window ended (sequential readahead)
+ *
+ * reads that are larger than the buffer (i.e. sample data) bypass the buffer
+ *
+ * the buffer size is set by defining SF22ASWT_READ_BUFFER_SIZE (512 to 32768, a multiple of 512)
+ * the buffer is allocated (in internal ram) by the first read that needs it and freed by close,
+ * so a File object is small and can be on the stack, a persistent (pooled) handle keeps its buffer between the loads
+ * if the allocation fails the reads goes directly to the backend
+ * defining it as 0 disables the buffering, which is the default for the mmap and memory backends
+ * as they don't have any per read overhead
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+#include "sf22aswt_storage.h"
+
+#ifndef SF22ASWT_READ_BUFFER_SIZE
+#if defined(SF22ASWT_STORAGE_MMAP) || defined(SF22ASWT_STORAGE_MEMORY)
+#define SF22ASWT_READ_BUFFER_SIZE 0
+#else
+#define SF22ASWT_READ_BUFFER_SIZE 4096
+#endif
+#endif
+
+namespace SF22ASWT
+{
+    template<class FileT, size_t BufferSize>
+    class BufferedFile
+    {
+      public:
+        static const size_t SectorSize = 512;
+        static_assert(BufferSize >= 512 && BufferSize <= 32768, "BufferSize must be between 512 and 32768 bytes");
+        static_assert(BufferSize % SectorSize == 0, "BufferSize must be a multiple of the sector size (512)");
+
+        BufferedFile() {}
+        BufferedFile(FileT &&file) : file(static_cast<FileT&&>(file)) { if (this->file) fileSize = this->file.size(); }
+        /** the buffer is moved together with the file */
+        BufferedFile(BufferedFile &&other) :
+            file(static_cast<FileT&&>(other.file)), fileSize(other.fileSize), pos(other.pos), filePos(other.filePos),
+            windowStart(other.windowStart), windowLength(other.windowLength), readahead(other.readahead),
+            allocation(other.allocation), buffer(other.buffer)
+        {
+            other.allocation = nullptr;
+            other.buffer = nullptr;
+            other.windowLength = 0;
+        }
+        BufferedFile& operator=(BufferedFile &&other)
+        {
+            if (this == &other) return *this;
+            freeBuffer();
+            file = static_cast<FileT&&>(other.file);
+            fileSize = other.fileSize;
+            pos = other.pos;
+            filePos = other.filePos;
+            windowStart = other.windowStart;
+            windowLength = other.windowLength;
+            readahead = other.readahead;
+            allocation = other.allocation;
+            buffer = other.buffer;
+            other.allocation = nullptr;
+            other.buffer = nullptr;
+            other.windowLength = 0;
+            return *this;
+        }
+        ~BufferedFile() { freeBuffer(); }
+        BufferedFile(const BufferedFile&) = delete;
+        BufferedFile& operator=(const BufferedFile&) = delete;
+
+        size_t read(void *buf, size_t nbyte)
+        {
+            if (!file) return 0;
+            uint8_t *dst = (uint8_t*)buf;
+            size_t total = 0;
+            while (nbyte > 0 && pos < fileSize)
+            {
+                if (pos >= windowStart && pos < windowStart + windowLength)
+                {
+                    size_t n = windowStart + windowLength - pos;
+                    if (n > nbyte) n = nbyte;
+                    memcpy(dst, buffer + (pos - windowStart), n);
+                    dst += n; pos += n; total += n; nbyte -= n;
+                }
+                else if (nbyte >= BufferSize || allocBuffer() == false)
+                {
+                    // large read, read directly into the destination
+                    if (fileSeek(pos) == false) break;
+                    int n = (int)file.read(dst, nbyte);
+                    if (n <= 0) break;
+                    filePos += n; pos += n; total += n;
+                    break;
+                }
+                else if (fill(nbyte) == false)
+                    break;
+            }
+            return total;
+        }
+        size_t readBytes(char *buffer, size_t length) { return read(buffer, length); }
+
+        /** writes are not buffered, they invalidates the read buffer */
+        size_t write(const uint8_t *buf, size_t size)
+        {
+            if (!file) return 0;
+            windowLength = 0;
+            if (fileSeek(pos) == false) return 0;
+            size_t n = file.write(buf, size);
+            filePos += n;
+            pos += n;
+            if (pos > fileSize) fileSize = pos;
+            return n;
+        }
+
+        /** only the position is changed, the backend seek is done on the next read that is not in the buffer */
+        bool seek(uint64_t pos, int mode = SeekSet)
+        {
+            if (!file) return false;
+            int64_t newPos = (int64_t)pos;
+            if (mode == SeekCur) newPos = (int64_t)this->pos + (int64_t)pos;
+            else if (mode == SeekEnd) newPos = (int64_t)fileSize + (int64_t)pos;
+            if (newPos < 0 || (uint64_t)newPos > fileSize) return false;
+            this->pos = newPos;
+            return true;
+        }
+        uint64_t position() { return pos; }
+        uint64_t size() { return fileSize; }
+        int available() { return (pos >= fileSize) ? 0 : (((fileSize - pos) > 0x7FFFFFFF) ? 0x7FFFFFFF : (int)(fileSize - pos)); }
+        void close()
+        {
+            file.close();
+            freeBuffer();
+            readahead = SectorSize;
+        }
+        operator bool() { return (bool)file; }
+        /** the backend file, any direct use of it must be followed by a seek */
+        FileT& rawFile() { return file; }
+
+      private:
+        FileT file;
+        uint64_t fileSize = 0;
+        /** the position seen by the user */
+        uint64_t pos = 0;
+        /** the position of the backend file */
+        uint64_t filePos = 0;
+
+        uint64_t windowStart = 0;
+        size_t windowLength = 0;
+        size_t readahead = SectorSize;
+        /** buffer is allocation aligned to 32 bytes (a cache line) */
+        void *allocation = nullptr;
+        uint8_t *buffer = nullptr;
+
+        bool allocBuffer()
+        {
+            if (buffer != nullptr) return true;
+            allocation = malloc(BufferSize + 31);
+            if (allocation == nullptr) return false;
+            buffer = (uint8_t*)(((uintptr_t)allocation + 31) & ~(uintptr_t)31);
+            return true;
+        }
+        void freeBuffer()
+        {
+            free(allocation);
+            allocation = nullptr;
+            buffer = nullptr;
+            windowLength = 0;
+        }
+
+        bool fileSeek(uint64_t newPos)
+        {
+            if (filePos == newPos) return true;
+            if (file.seek(newPos) == false) return false;
+            filePos = newPos;
+            return true;
+        }
+
+        /** fills the buffer with the sector aligned window that contains pos */
+        bool fill(size_t nbyte)
+        {
+            uint64_t start = pos & ~(uint64_t)(SectorSize - 1);
+            if (windowLength != 0 && start == windowStart + windowLength)
+                readahead = (readahead*2 > BufferSize) ? BufferSize : readahead*2;
+            else
+                readahead = SectorSize;
+
+            // make sure that the whole request fits when possible
+            size_t length = (size_t)(pos - start) + nbyte;
+            length = (length + SectorSize - 1) & ~(SectorSize - 1);
+            if (length < readahead) length = readahead;
+            if (length > BufferSize) length = BufferSize;
+            if (length > fileSize - start) length = fileSize - start;
+
+            windowLength = 0;
+            if (fileSeek(start) == false) return false;
+            int n = (int)file.read(buffer, length);
+            if (n <= 0) return false;
+            filePos += n;
+            windowStart = start;
+            windowLength = n;
+            return pos < windowStart + windowLength;
+        }
+    };
+
+    namespace Storage
+    {
+        template<class FileT, size_t BufferSize>
+        uint32_t ModifyTime(BufferedFile<FileT, BufferSize> &file) { return ModifyTime(file.rawFile()); }
+    }
+
+#if SF22ASWT_READ_BUFFER_SIZE == 0
+    /** the file type used by the readers, depends on the selected storage backend */
+    typedef Storage::File File;
+#else
+    /** the file type used by the readers, depends on the selected storage backend and SF22ASWT_READ_BUFFER_SIZE */
+    typedef BufferedFile<Storage::File, SF22ASWT_READ_BUFFER_SIZE> File;
+#endif
+}
@@ -0,0 +1,99 @@
+#include "sf22aswt_compressed_instrument.h"
+#include "sf22aswt_sample_cache.h"
+
+namespace SF22ASWT
+{
+    extern int samples_usedRam;
+
+    /** the same as ReaderBase::get_sample_data_size_bytes, the padding is a multiple of 256 samples */
+    static size_t getDecodedSampleSize(int length)
+    {
+        int length_32 = (length + 1) / 2;
+        int pad_length = (length_32 % 128 == 0) ? 0 : (128 - length_32 % 128);
+        return (length_32 + pad_length)*4;
+    }
+
+    void CompressedInstrument::Free()
+    {
+        samples_usedRam -= data.getSize();
+        data.Free();
+        delete[] samples;
+        samples = nullptr;
+        delete[] sample_note_ranges;
+        sample_note_ranges = nullptr;
+        delete[] offsets;
+        offsets = nullptr;
+        sample_count = 0;
+    }
+
+    bool CompressedInstrument::Alloc(const instrument_data_temp &inst, uint32_t fileId, bool useExtMem)
+    {
+        Free();
+        size_t size = 0;
+        for (int si=0;si<inst.sample_count;si++)
+            size += SamplePool::alignSize(Adpcm::getEncodedSize(inst.samples[si].LENGTH));
+        if (data.Alloc(size, useExtMem) == false) return false;
+        samples_usedRam += data.getSize();
+
+        // the decoded samples are not the same as the lossless ones in the SampleCache, so they get a own id
+        this->fileId = fileId ^ 0x4D435044; // "DPCM"
+        sample_count = inst.sample_count;
+        samples = new sample_header_temp[sample_count];
+        sample_note_ranges = new uint8_t[sample_count];
+        offsets = new uint32_t[sample_count];
+        size_t offset = 0;
+        for (int si=0;si<sample_count;si++)
+        {
+            samples[si] = inst.samples[si];
+            samples[si].sample = nullptr;
+            sample_note_ranges[si] = inst.sample_note_ranges[si];
+            offsets[si] = offset;
+            offset += SamplePool::alignSize(Adpcm::getEncodedSize(inst.samples[si].LENGTH));
+        }
+        return true;
+    }
+
+    size_t CompressedInstrument::getDecodedSize()
+    {
+        size_t size = 0;
+        for (int si=0;si<sample_count;si++)
+            size += SamplePool::alignSize(getDecodedSampleSize(samples[si].LENGTH));
+        return size;
+    }
+
+    bool CompressedInstrument::Decode(instrument_data_temp &inst)
+    {
+        if (inst.arenaAllocated == false) {
+            delete[] inst.samples;
+            delete[] inst.sample_note_ranges;
+        }
+        inst.arenaAllocated = false;
+        inst.sample_count = sample_count;
+        inst.samples = new sample_header_temp[sample_count];
+        inst.sample_note_ranges = new uint8_t[sample_count];
+        for (int si=0;si<sample_count;si++)
+        {
+            inst.samples[si] = samples[si];
+            inst.sample_note_ranges[si] = sample_note_ranges[si];
+        }
+
+        for (int si=0;si<sample_count;si++)
+        {
+            sample_header_temp &sample = inst.samples[si];
+            // allready decoded (by this or a other instrument that uses the same sample)
+            if ((sample.sample = SampleCache::Acquire(fileId, sample.sample_start, sample.LENGTH)) != nullptr) continue;
+
+            size_t size = getDecodedSampleSize(sample.LENGTH);
+            int16_t *out = SampleCache::Insert(fileId, sample.sample_start, sample.LENGTH, size, false);
+            if (out == nullptr) {
+                SampleCache::Release(inst);
+                return false;
+            }
+            size_t length = (sample.LENGTH > 0) ? sample.LENGTH : 0;
+            Adpcm::Decode(getSampleData(si), out, length);
+            memset(out + length, 0, size - length*sizeof(int16_t));
+            sample.sample = out;
+        }
+        return true;
+    }
+}
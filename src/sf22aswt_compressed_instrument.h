@@ -0,0 +1,56 @@
+/**
+ * a instrument which samples are kept ADPCM compressed (see sf22aswt_adpcm.h) in PSRAM
+ *
+ * loaded with ReaderBase::ReadSampleDataCompressed, this keeps about 3.9x more instruments in PSRAM
+ * as AudioSynthWavetable needs int16 data (and PSRAM is slow to read from the audio interrupt)
+ * Decode decompresses the samples into internal ram when the instrument is to be played,
+ * the decoded samples are placed in the SampleCache that is used as the working cache,
+ * so its internal ram budget (SampleCache::setBudget(size, false)) limits the decoded data
+ * and decoding a instrument again is free while its samples are still cached
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+#include "sf22aswt_structures.h"
+#include "sf22aswt_sample_pool.h"
+#include "sf22aswt_adpcm.h"
+
+namespace SF22ASWT
+{
+    class CompressedInstrument
+    {
+      public:
+        CompressedInstrument() {}
+        CompressedInstrument(const CompressedInstrument&) = delete;
+        CompressedInstrument& operator=(const CompressedInstrument&) = delete;
+        ~CompressedInstrument() { Free(); }
+
+        void Free();
+        /** copies the sample headers of inst and allocates the compressed data, used by ReaderBase::ReadSampleDataCompressed */
+        bool Alloc(const instrument_data_temp &inst, uint32_t fileId, bool useExtMem);
+        /** the compressed blocks of a sample */
+        uint8_t* getSampleData(int sampleIndex) { return data.getData() + offsets[sampleIndex]; }
+
+        /**
+         * decompresses all samples into the SampleCache (internal ram) and fills inst (the arrays are allocated)
+         * inst can then be converted with converter::to_AudioSynthWavetable_instrument_data,
+         * the samples must be released with SampleCache::Release when not used anymore
+         * returns false if the samples don't fit in the SampleCache
+         */
+        bool Decode(instrument_data_temp &inst);
+
+        uint8_t getSampleCount() { return sample_count; }
+        size_t getCompressedSize() { return data.getSize(); }
+        /** the size of the decoded samples inclusive padding */
+        size_t getDecodedSize();
+
+      private:
+        uint32_t fileId = 0;
+        uint8_t sample_count = 0;
+        uint8_t *sample_note_ranges = nullptr;
+        sample_header_temp *samples = nullptr;
+        /** the position of every sample in data */
+        uint32_t *offsets = nullptr;
+        SamplePool data;
+    };
+}
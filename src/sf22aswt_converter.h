@@ -1,8 +1,7 @@
 
 #pragma once
 
-#include <Arduino.h>
-#include <Audio.h>
+#include "sf22aswt_platform.h"
 #include "sf22aswt_enums.h"
 #include "sf22aswt_structures.h"
 #include "sf22aswt_helpers.h"
@@ -5,7 +5,7 @@
 */
 #pragma once
 
-#include <Arduino.h>
+#include "sf22aswt_platform.h"
 
 namespace SF22ASWT
 {
@@ -80,10 +80,12 @@ namespace SF22ASWT::Error
     };
     const uint16_t FUNCTION_LockupTable[] PROGMEM = {
         (uint16_t)FUNCTION::LOAD_INST,
+        (uint16_t)FUNCTION::LOAD_PRESET,
     };
     const int FUNCTION_LockupTable_Size = sizeof(FUNCTION_LockupTable)/sizeof(FUNCTION_LockupTable[0]);
     const char* const FUNCTION_Strings[] PROGMEM = {
         "LOAD_INST",
+        "LOAD_PRESET",
     };
 
     const uint16_t INFO_LockupTable[] PROGMEM = {
@@ -219,6 +221,9 @@ namespace SF22ASWT::Error
         Errors::NONE,
         Errors::RAM_DATA_MALLOC,
         Errors::FUNCTION_LOAD_INST_INDEX_RANGE,
+        Errors::FUNCTION_LOAD_PRESET_INDEX_RANGE,
+        Errors::FUNCTION_LOAD_INST_DATA_RANGE,
+        Errors::FUNCTION_LOAD_PRESET_DATA_RANGE,
         //Errors::NONE,
         Errors::FILE_NOT_OPEN,
         Errors::FILE_FOURCC_READ,
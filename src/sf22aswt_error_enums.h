@@ -3,7 +3,7 @@
 #ifndef SF22ASWT_ERROR_ENUMS_H_
 #define SF22ASWT_ERROR_ENUMS_H_
 
-#include <Arduino.h>
+#include "sf22aswt_platform.h"
 
 // this mode takes 448 bytes of flash
 //#define SF22ASWT_PRINT_ERROR_CODE_AS_TEXT
@@ -73,6 +73,7 @@ namespace SF22ASWT::Error
     enum class FUNCTION
     {
         LOAD_INST = 1 << ERROR_SUB_LOCATION_SHIFT,
+        LOAD_PRESET = 2 << ERROR_SUB_LOCATION_SHIFT,
 
     };
     enum class INFO
@@ -136,6 +137,10 @@ namespace SF22ASWT
         RAM_DATA_MALLOC         = ERROR(RAM, DATA, MALLOC),
         EXTRAM_DATA_MALLOC      = ERROR(EXTRAM, DATA, MALLOC),
         FUNCTION_LOAD_INST_INDEX_RANGE = ERROR_SUB(FUNCTION, LOAD_INST, INDEX, RANGE),
+        FUNCTION_LOAD_PRESET_INDEX_RANGE = ERROR_SUB(FUNCTION, LOAD_PRESET, INDEX, RANGE), // the bank/program is not in the file
+        /** more than 255 zones, AudioSynthWavetable::instrument_data can't hold them */
+        FUNCTION_LOAD_INST_DATA_RANGE = ERROR_SUB(FUNCTION, LOAD_INST, DATA, RANGE),
+        FUNCTION_LOAD_PRESET_DATA_RANGE = ERROR_SUB(FUNCTION, LOAD_PRESET, DATA, RANGE),
 
         FILE_NOT_OPEN           = ERROR(FILE, NONE, OPEN), // file could not be opened
         FILE_FOURCC_READ        = ERROR(FILE, FOURCC, READ),     // read error - RIFF fileTag
@@ -276,6 +281,12 @@ namespace SF22ASWT
 
 namespace SF22ASWT::Error
 {
+    /** same as ERROR_SUB but from runtime values, used by the chunk walkers, subLocation is 0 for root errors */
+    constexpr Errors Code(RootLocation root, uint16_t subLocation, Type type, Operation operation)
+    {
+        return (Errors)((uint16_t)operation + (uint16_t)type + subLocation + (uint16_t)root);
+    }
+
     extern const Errors ErrorList[];
     extern int ErrorList_Size;
 
@@ -0,0 +1,70 @@
+#include "sf22aswt_file_pool.h"
+
+namespace SF22ASWT::FilePool
+{
+    struct Entry
+    {
+        String path;
+        File *file = nullptr;
+        int users = 0;
+    };
+    static Entry entries[SF22ASWT_FILE_POOL_SIZE];
+
+    static Entry* find(File *file)
+    {
+        if (file == nullptr) return nullptr;
+        for (int i=0;i<SF22ASWT_FILE_POOL_SIZE;i++)
+            if (entries[i].file == file) return &entries[i];
+        return nullptr;
+    }
+
+    File* Acquire(const char *path)
+    {
+        Entry *freeEntry = nullptr;
+        for (int i=0;i<SF22ASWT_FILE_POOL_SIZE;i++)
+        {
+            if (entries[i].file == nullptr) {
+                if (freeEntry == nullptr) freeEntry = &entries[i];
+                continue;
+            }
+            if (entries[i].path != path) continue;
+
+            if (!*entries[i].file && Reopen(entries[i].file) == false) return nullptr;
+            entries[i].users++;
+            return entries[i].file;
+        }
+        if (freeEntry == nullptr) return nullptr;
+
+        File *file = new File(Storage::Open(path));
+        if (!*file) { delete file; return nullptr; }
+        freeEntry->path = path;
+        freeEntry->file = file;
+        freeEntry->users = 1;
+        return file;
+    }
+
+    void Release(File *file)
+    {
+        Entry *entry = find(file);
+        if (entry == nullptr) return;
+        if (--entry->users > 0) return;
+        entry->file->close();
+        delete entry->file;
+        *entry = Entry();
+    }
+
+    bool Reopen(File *file)
+    {
+        Entry *entry = find(file);
+        if (entry == nullptr) return false;
+        file->close();
+        *file = File(Storage::Open(entry->path.c_str()));
+        return (bool)*file;
+    }
+
+    int getUserCount(File *file)
+    {
+        Entry *entry = find(file);
+        return (entry != nullptr) ? entry->users : 0;
+    }
+}
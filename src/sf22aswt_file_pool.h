@@ -0,0 +1,33 @@
+/**
+ * small pool of open files used by readers that keeps the file open between calls
+ * (see ReaderBase::setKeepFileOpen), readers that uses the same file
+ * (i.e. readers created with CloneInto) shares the same handle
+ *
+ * every user must seek before reading as the position is shared
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+#include "sf22aswt_buffered_file.h"
+
+#ifndef SF22ASWT_FILE_POOL_SIZE
+/**
+ * max number of different files that can be kept open at the same time,
+ * readers with setKeepFileOpen, streamed instruments and async loads (BeginLoad) in progress of different files each uses one,
+ * when the pool is full the readers and the async loads opens a own file handle instead
+ */
+#define SF22ASWT_FILE_POOL_SIZE 4
+#endif
+
+namespace SF22ASWT::FilePool
+{
+    /** returns the open file for path, the file is opened if not allready in the pool,
+     *  returns nullptr if the file could not be opened or if the pool is full */
+    File* Acquire(const char *path);
+    /** must be called once for every successful Acquire, the file is closed when the last user releases it */
+    void Release(File *file);
+    /** closes and opens the file again, used when the file was closed by a error or if the file was changed */
+    bool Reopen(File *file);
+    /** number of users of the file, 0 if it's not in the pool */
+    int getUserCount(File *file);
+}
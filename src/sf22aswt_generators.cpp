@@ -0,0 +1,60 @@
+#include "sf22aswt_generators.h"
+
+namespace SF22ASWT
+{
+    void zone_gens::Clear()
+    {
+        for (int i=0;i<GenCount;i++)
+            values[i].Amount = GenDescriptors[i].defaultValue;
+        setMask = 0;
+    }
+
+    void zone_gens::Set(const bag_of_gens &bag)
+    {
+        uint64_t bagMask = 0;
+        for (int i=0;i<bag.count;i++)
+        {
+            int gen = (int)bag.items[i].sfGenOper;
+            if (gen >= GenCount) continue; // unknown generators should be ignored
+            uint64_t bit = (uint64_t)1 << gen;
+            if (bagMask & bit) continue;
+            bagMask |= bit;
+            values[gen] = bag.items[i].genAmount;
+        }
+        setMask |= bagMask;
+    }
+
+    int zone_gens::getClamped(SFGenerator genType) const
+    {
+        const gen_descriptor &desc = getGenDescriptor(genType);
+        if (desc.unit == SFGenUnit::range || desc.unit == SFGenUnit::index || desc.unit == SFGenUnit::flags)
+            return values[(int)genType].UAmount;
+        int val = values[(int)genType].Amount;
+        return (val > desc.max) ? desc.max : ((val < desc.min) ? desc.min : val);
+    }
+
+    /** the intersection of two ranges (low byte = low, high byte = high), returns false if they don't overlap */
+    static bool intersectRange(SF2GeneratorAmount &range, SF2GeneratorAmount other)
+    {
+        uint8_t low = (range.rangeLow() > other.rangeLow()) ? range.rangeLow() : other.rangeLow();
+        uint8_t high = (range.rangeHigh() < other.rangeHigh()) ? range.rangeHigh() : other.rangeHigh();
+        if (low > high) return false;
+        range.LowByte = low;
+        range.HighByte = high;
+        return true;
+    }
+
+    bool zone_gens::ApplyPreset(const zone_gens &preset)
+    {
+        if (intersectRange(values[(int)SFGenerator::keyRange], preset.get(SFGenerator::keyRange)) == false) return false;
+        if (intersectRange(values[(int)SFGenerator::velRange], preset.get(SFGenerator::velRange)) == false) return false;
+        for (int i=0;i<GenCount;i++)
+        {
+            if (GenDescriptors[i].instrumentOnly || preset.isSet((SFGenerator)i) == false) continue;
+            int val = values[i].Amount + preset.values[i].Amount;
+            values[i].Amount = (val > GenDescriptors[i].max) ? GenDescriptors[i].max : ((val < GenDescriptors[i].min) ? GenDescriptors[i].min : val);
+            setMask |= (uint64_t)1 << i;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,167 @@
+/**
+ * generator descriptors and the dense per zone generator table
+ *
+ * the values of a zone (with the global zone merged in) are resolved once into a
+ * zone_gens table that is indexed by SFGenerator, so that every lookup is O(1)
+ * instead of a linear scan of the zone and the global zone
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+#include "sf22aswt_enums.h"
+#include "sf22aswt_structures.h"
+
+namespace SF22ASWT
+{
+    /** the unit of a generator value, @see "8.1.3 Generator Summary" In SoundFont Technical Specification 2.04. */
+    enum class SFGenUnit : uint8_t
+    {
+        /** unused or reserved generator */
+        none = 0,
+        /** sample data points */
+        smpls,
+        /** 32768 sample data points */
+        coarseSmpls,
+        /** cents */
+        cent,
+        /** absolute cents (0 = 8.176 Hz) */
+        absCent,
+        /** timecents (0 = 1 second) */
+        timecent,
+        /** timecents per key number */
+        timecentPerKey,
+        /** centibels */
+        cB,
+        /** 0.1 % */
+        permille,
+        /** semitones */
+        semitone,
+        /** cents per key number */
+        centPerKey,
+        /** MIDI key number or velocity, -1 = not used */
+        midi,
+        /** low byte = low value, high byte = high value */
+        range,
+        /** index into the inst or shdr records */
+        index,
+        /** bit flags (SFSampleMode) */
+        flags
+    };
+
+    struct gen_descriptor
+    {
+        int16_t defaultValue;
+        int16_t min;
+        int16_t max;
+        SFGenUnit unit;
+        /** generators that can't be used at preset level and that are not additive (ranges, indexes, flags and sample offsets) */
+        bool instrumentOnly;
+    };
+
+    /** number of generators in the descriptor table and zone_gens, i.e. every value below SFGenerator::endOper */
+    constexpr int GenCount = (int)SFGenerator::endOper;
+
+    /** @see "8.1.3 Generator Summary" In SoundFont Technical Specification 2.04. */
+    constexpr gen_descriptor GenDescriptors[GenCount] = {
+        /*  0 startAddrsOffset           */ {      0, -32768, 32767, SFGenUnit::smpls, true },
+        /*  1 endAddrsOffset             */ {      0, -32768, 32767, SFGenUnit::smpls, true },
+        /*  2 startloopAddrsOffset       */ {      0, -32768, 32767, SFGenUnit::smpls, true },
+        /*  3 endloopAddrsOffset         */ {      0, -32768, 32767, SFGenUnit::smpls, true },
+        /*  4 startAddrsCoarseOffset     */ {      0, -32768, 32767, SFGenUnit::coarseSmpls, true },
+        /*  5 modLfoToPitch              */ {      0, -12000, 12000, SFGenUnit::cent, false },
+        /*  6 vibLfoToPitch              */ {      0, -12000, 12000, SFGenUnit::cent, false },
+        /*  7 modEnvToPitch              */ {      0, -12000, 12000, SFGenUnit::cent, false },
+        /*  8 initialFilterFc            */ {  13500,   1500, 13500, SFGenUnit::absCent, false },
+        /*  9 initialFilterQ             */ {      0,      0,   960, SFGenUnit::cB, false },
+        /* 10 modLfoToFilterFc           */ {      0, -12000, 12000, SFGenUnit::cent, false },
+        /* 11 modEnvToFilterFc           */ {      0, -12000, 12000, SFGenUnit::cent, false },
+        /* 12 endAddrsCoarseOffset       */ {      0, -32768, 32767, SFGenUnit::coarseSmpls, true },
+        /* 13 modLfoToVolume             */ {      0,   -960,   960, SFGenUnit::cB, false },
+        /* 14 unused1                    */ {      0,      0,     0, SFGenUnit::none, true },
+        /* 15 chorusEffectsSend          */ {      0,      0,  1000, SFGenUnit::permille, false },
+        /* 16 reverbEffectsSend          */ {      0,      0,  1000, SFGenUnit::permille, false },
+        /* 17 pan                        */ {      0,   -500,   500, SFGenUnit::permille, false },
+        /* 18 unused2                    */ {      0,      0,     0, SFGenUnit::none, true },
+        /* 19 unused3                    */ {      0,      0,     0, SFGenUnit::none, true },
+        /* 20 unused4                    */ {      0,      0,     0, SFGenUnit::none, true },
+        /* 21 delayModLFO                */ { -12000, -12000,  5000, SFGenUnit::timecent, false },
+        /* 22 freqModLFO                 */ {      0, -16000,  4500, SFGenUnit::absCent, false },
+        /* 23 delayVibLFO                */ { -12000, -12000,  5000, SFGenUnit::timecent, false },
+        /* 24 freqVibLFO                 */ {      0, -16000,  4500, SFGenUnit::absCent, false },
+        /* 25 delayModEnv                */ { -12000, -12000,  5000, SFGenUnit::timecent, false },
+        /* 26 attackModEnv               */ { -12000, -12000,  8000, SFGenUnit::timecent, false },
+        /* 27 holdModEnv                 */ { -12000, -12000,  5000, SFGenUnit::timecent, false },
+        /* 28 decayModEnv                */ { -12000, -12000,  8000, SFGenUnit::timecent, false },
+        /* 29 sustainModEnv              */ {      0,      0,  1000, SFGenUnit::permille, false },
+        /* 30 releaseModEnv              */ { -12000, -12000,  8000, SFGenUnit::timecent, false },
+        /* 31 keynumToModEnvHold         */ {      0,  -1200,  1200, SFGenUnit::timecentPerKey, false },
+        /* 32 keynumToModEnvDecay        */ {      0,  -1200,  1200, SFGenUnit::timecentPerKey, false },
+        /* 33 delayVolEnv                */ { -12000, -12000,  5000, SFGenUnit::timecent, false },
+        /* 34 attackVolEnv               */ { -12000, -12000,  8000, SFGenUnit::timecent, false },
+        /* 35 holdVolEnv                 */ { -12000, -12000,  5000, SFGenUnit::timecent, false },
+        /* 36 decayVolEnv                */ { -12000, -12000,  8000, SFGenUnit::timecent, false },
+        /* 37 sustainVolEnv              */ {      0,      0,  1440, SFGenUnit::cB, false },
+        /* 38 releaseVolEnv              */ { -12000, -12000,  8000, SFGenUnit::timecent, false },
+        /* 39 keynumToVolEnvHold         */ {      0,  -1200,  1200, SFGenUnit::timecentPerKey, false },
+        /* 40 keynumToVolEnvDecay        */ {      0,  -1200,  1200, SFGenUnit::timecentPerKey, false },
+        /* 41 instrument                 */ {      0,      0, 32767, SFGenUnit::index, true },
+        /* 42 reserved1                  */ {      0,      0,     0, SFGenUnit::none, true },
+        /* 43 keyRange                   */ { 0x7F00,      0, 32767, SFGenUnit::range, true },
+        /* 44 velRange                   */ { 0x7F00,      0, 32767, SFGenUnit::range, true },
+        /* 45 startloopAddrsCoarseOffset */ {      0, -32768, 32767, SFGenUnit::coarseSmpls, true },
+        /* 46 keynum                     */ {     -1,     -1,   127, SFGenUnit::midi, true },
+        /* 47 velocity                   */ {     -1,     -1,   127, SFGenUnit::midi, true },
+        /* 48 initialAttenuation         */ {      0,      0,  1440, SFGenUnit::cB, false },
+        /* 49 reserved2                  */ {      0,      0,     0, SFGenUnit::none, true },
+        /* 50 endloopAddrsCoarseOffset   */ {      0, -32768, 32767, SFGenUnit::coarseSmpls, true },
+        /* 51 coarseTune                 */ {      0,   -120,   120, SFGenUnit::semitone, false },
+        /* 52 fineTune                   */ {      0,    -99,    99, SFGenUnit::cent, false },
+        /* 53 sampleID                   */ {      0,      0, 32767, SFGenUnit::index, true },
+        /* 54 sampleModes                */ {      0,      0,     3, SFGenUnit::flags, true },
+        /* 55 reserved3                  */ {      0,      0,     0, SFGenUnit::none, true },
+        /* 56 scaleTuning                */ {    100,      0,  1200, SFGenUnit::centPerKey, false },
+        /* 57 exclusiveClass             */ {      0,      0,   127, SFGenUnit::index, true },
+        /* 58 overridingRootKey          */ {     -1,     -1,   127, SFGenUnit::midi, true },
+        /* 59 unused5                    */ {      0,      0,     0, SFGenUnit::none, true },
+    };
+    static_assert(GenDescriptors[(int)SFGenerator::overridingRootKey].unit == SFGenUnit::midi, "GenDescriptors is not in SFGenerator order");
+
+    constexpr const gen_descriptor& getGenDescriptor(SFGenerator genType) { return GenDescriptors[(int)genType]; }
+
+    /**
+     * all generator values of a zone, indexed by SFGenerator
+     * generators not set by the zone (or the global zone) have the default value from GenDescriptors
+    */
+    class zone_gens
+    {
+      public:
+        SF2GeneratorAmount values[GenCount];
+        /** bit n is set when generator n was set by the zone or the global zone */
+        uint64_t setMask = 0;
+
+        zone_gens() { Clear(); }
+        /** sets all values to their defaults */
+        void Clear();
+        /** sets the values used by bag, within the same bag the first occurrence is used */
+        void Set(const bag_of_gens &bag);
+
+        inline bool isSet(SFGenerator genType) const { return ((int)genType < GenCount) && ((setMask >> (int)genType) & 1); }
+        /** returns the value, or the default value when not set */
+        inline SF2GeneratorAmount get(SFGenerator genType) const { return values[(int)genType]; }
+        /** returns false and don't change amount when the generator is not set */
+        inline bool get(SFGenerator genType, SF2GeneratorAmount *amount) const {
+            if (isSet(genType) == false) return false;
+            *amount = values[(int)genType];
+            return true;
+        }
+        /** returns the value clamped to the range of the generator */
+        int getClamped(SFGenerator genType) const;
+        /**
+         * applies a preset zone to this instrument zone (@see "9.4 The SoundFont Generator Model"):
+         * the key and velocity ranges are intersected and the additive generators set by the preset zone
+         * are added to the values of this zone (or the defaults), clamped to their range
+         * returns false when the ranges don't overlap (the zone is then not used by the preset)
+         */
+        bool ApplyPreset(const zone_gens &preset);
+    };
+}
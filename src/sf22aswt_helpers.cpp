@@ -53,6 +53,28 @@ namespace Helpers
                 printStream.write(bytes[i]);
         }
     }
+    uint32_t fnv1a32(const void* data, size_t length, uint32_t hash)
+    {
+        const uint8_t* bytes = (const uint8_t*)data;
+        for (size_t i=0;i<length;i++)
+        {
+            hash ^= bytes[i];
+            hash *= 0x01000193;
+        }
+        return hash;
+    }
+    bool containsIgnoreCase(const char* str, size_t length, const char* find)
+    {
+        size_t findLength = strlen(find);
+        for (size_t i=0;i<length && str[i] != '\0';i++)
+        {
+            size_t j = 0;
+            for (;j<findLength && i+j<length && str[i+j] != '\0';j++)
+                if (tolower((uint8_t)str[i+j]) != tolower((uint8_t)find[j])) break;
+            if (j == findLength) return true;
+        }
+        return findLength == 0;
+    }
 
     
 }
\ No newline at end of file
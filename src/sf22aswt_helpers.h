@@ -1,6 +1,6 @@
 #pragma once
 
-#include <Arduino.h>
+#include "sf22aswt_platform.h"
 
 
 
@@ -10,6 +10,10 @@ namespace Helpers
     void printRawBytesSanitized(Print &printStream, const char* bytes, size_t length);
     void printRawBytesSanitizedUntil(Print &printStream, const char* bytes, size_t length, char untilchar);
     void printRawBytesUntil(Print &printStream, const char* bytes, size_t length, char untilchar);
+    /** FNV-1a 32bit hash, hash can be used to continue a previous calculation */
+    uint32_t fnv1a32(const void* data, size_t length, uint32_t hash = 0x811C9DC5);
+    /** true when the first length chars of str (stops at a null char) contains find (case insensitive), a empty find allways matches */
+    bool containsIgnoreCase(const char* str, size_t length, const char* find);
 
     // can be used to get strings from:
     // PrintInstrumentListAsJson, PrintPresetListAsJson & PrintInfoBlock 
@@ -0,0 +1,171 @@
+#include "sf22aswt_instrument_slot.h"
+#include "sf22aswt_converter.h"
+
+namespace SF22ASWT
+{
+#pragma region InstrumentSlot
+    void InstrumentSlot::Loaded::Free()
+    {
+        if (inst != nullptr) {
+            // allocated by the converter
+            delete[] reinterpret_cast<const SF22ASWT::sample_header*>(inst->samples);
+            delete[] inst->sample_note_ranges;
+            delete inst;
+        }
+        inst = nullptr;
+        samples_usedRam -= pool.getSize();
+        pool.Free();
+        index = -1;
+    }
+
+    void InstrumentSlot::setVoices(AudioSynthWavetable *voices, int count)
+    {
+        this->voices = voices;
+        voiceCount = (count > SF22ASWT_SLOT_MAX_VOICES) ? SF22ASWT_SLOT_MAX_VOICES : count;
+        for (int i=0;i<voiceCount;i++)
+        {
+            pending[i] = false;
+            if (active.inst != nullptr) voices[i].setInstrument(*active.inst);
+        }
+    }
+
+    bool InstrumentSlot::setShadow(ReaderBase &reader, instrument_data_temp &inst, int instrumentIndex)
+    {
+        shadow.Free();
+        shadow.inst = new AudioSynthWavetable::instrument_data(SF22ASWT::converter::to_AudioSynthWavetable_instrument_data(inst));
+        reader.DetachSamplePool(shadow.pool);
+        shadow.index = instrumentIndex;
+        return true;
+    }
+
+    bool InstrumentSlot::Prefetch(ReaderBase &reader, int instrumentIndex)
+    {
+        instrument_data_temp inst = {0,0,nullptr};
+        if (reader.Load_instrument_data(instrumentIndex, inst, true) == false) return false;
+        if (reader.ReadSampleDataFromFile(inst) == false) return false;
+        return setShadow(reader, inst, instrumentIndex);
+    }
+
+    bool InstrumentSlot::BeginPrefetch(ReaderBase &reader, int instrumentIndex)
+    {
+        if (reader.BeginLoad(instrumentIndex) == false) return false;
+        loadingReader = &reader;
+        return true;
+    }
+
+    AsyncLoadState InstrumentSlot::StepPrefetch(uint32_t budget_us)
+    {
+        if (loadingReader == nullptr) return AsyncLoadState::Idle;
+        AsyncLoadState state = loadingReader->Step(budget_us);
+        if (state == AsyncLoadState::Loading) return state;
+        if (state == AsyncLoadState::Done) {
+            shadow.Free();
+            shadow.inst = loadingReader->getLoadedInstrument();
+            loadingReader->DetachSamplePool(shadow.pool);
+            shadow.index = loadingReader->getLoadInstrumentIndex();
+        }
+        loadingReader = nullptr;
+        return state;
+    }
+
+    bool InstrumentSlot::Swap()
+    {
+        if (shadow.inst == nullptr) return false;
+        if (retired.inst != nullptr) {
+            // the previous swap is not done, the voices that still uses it are stopped
+            for (int i=0;i<voiceCount;i++)
+                if (pending[i]) ActivateVoice(i);
+            retired.Free();
+        }
+
+        AudioNoInterrupts();
+        Loaded old = active;
+        active = shadow;
+        shadow = Loaded();
+        for (int i=0;i<voiceCount;i++)
+        {
+            pending[i] = (old.inst != nullptr) && voices[i].isPlaying();
+            if (pending[i] == false) voices[i].setInstrument(*active.inst);
+        }
+        AudioInterrupts();
+
+        retired = old;
+        Service(); // frees it directly if no voice was playing
+        return true;
+    }
+
+    void InstrumentSlot::ActivateVoice(int voiceIndex)
+    {
+        if (voiceIndex < 0 || voiceIndex >= voiceCount || pending[voiceIndex] == false) return;
+        voices[voiceIndex].setInstrument(*active.inst);
+        pending[voiceIndex] = false;
+    }
+
+    void InstrumentSlot::Service()
+    {
+        if (retired.inst == nullptr) return;
+        bool inUse = false;
+        for (int i=0;i<voiceCount;i++)
+        {
+            if (pending[i] == false) continue;
+            if (voices[i].isPlaying()) { inUse = true; continue; }
+            ActivateVoice(i);
+        }
+        if (inUse == false) retired.Free();
+    }
+
+    void InstrumentSlot::Free()
+    {
+        if (loadingReader != nullptr) loadingReader->CancelLoad();
+        loadingReader = nullptr;
+        for (int i=0;i<voiceCount;i++) pending[i] = false;
+        retired.Free();
+        shadow.Free();
+        active.Free();
+    }
+#pragma endregion
+
+#pragma region ProgramPredictor
+    void ProgramPredictor::Record(int program)
+    {
+        if (last != -1 && last != program)
+        {
+            Transition *match = nullptr;
+            Transition *weakest = &transitions[0];
+            for (int i=0;i<SF22ASWT_PREDICTOR_SIZE;i++)
+            {
+                Transition &t = transitions[i];
+                if (t.from == last && t.to == program) { match = &t; break; }
+                if (t.count < weakest->count) weakest = &t;
+            }
+            if (match == nullptr) {
+                // replaces the least used transition
+                match = weakest;
+                match->from = last;
+                match->to = program;
+                match->count = 0;
+            }
+            if (match->count < UINT16_MAX) match->count++;
+        }
+        last = program;
+    }
+
+    int ProgramPredictor::Predict()
+    {
+        int best = -1;
+        uint16_t bestCount = 0;
+        for (int i=0;i<SF22ASWT_PREDICTOR_SIZE;i++)
+        {
+            Transition &t = transitions[i];
+            if (t.from == last && t.count > bestCount) { best = t.to; bestCount = t.count; }
+        }
+        return best;
+    }
+
+    void ProgramPredictor::Clear()
+    {
+        for (int i=0;i<SF22ASWT_PREDICTOR_SIZE;i++) transitions[i] = Transition();
+        last = -1;
+    }
+#pragma endregion
+}
@@ -0,0 +1,114 @@
+/**
+ * double buffered instrument for a set of AudioSynthWavetable voices
+ *
+ * the next instrument is loaded (prefetched) into the shadow slot while the active one is still played,
+ * Swap then exchanges them with interrupts disabled, the voices that are not playing gets the new instrument
+ * directly, the playing ones keep the old one until they are done (or when ActivateVoice is called on note on)
+ * the old instrument is freed by Service() when no voice uses it anymore
+ *
+ * the slot owns the sample data (it's taken from the reader after the load),
+ * so the reader can load other instruments without freeing it
+ *
+ * ProgramPredictor can be used to select what to prefetch from the previous program changes
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+#include "sf22aswt_reader_base.h"
+#include "sf22aswt_sample_pool.h"
+
+#ifndef SF22ASWT_SLOT_MAX_VOICES
+/** max number of voices that a InstrumentSlot can handle */
+#define SF22ASWT_SLOT_MAX_VOICES 128
+#endif
+
+#ifndef SF22ASWT_PREDICTOR_SIZE
+/** number of program changes (from -> to) that the ProgramPredictor remembers */
+#define SF22ASWT_PREDICTOR_SIZE 64
+#endif
+
+namespace SF22ASWT
+{
+    class InstrumentSlot
+    {
+      public:
+        InstrumentSlot() {}
+        InstrumentSlot(const InstrumentSlot&) = delete;
+        InstrumentSlot& operator=(const InstrumentSlot&) = delete;
+        /** frees all instruments, the voices must not be playing */
+        ~InstrumentSlot() { Free(); }
+
+        /** the voices that plays the active instrument, count is limited to SF22ASWT_SLOT_MAX_VOICES */
+        void setVoices(AudioSynthWavetable *voices, int count);
+
+        /** loads the instrument into the shadow slot, blocks until the load is done (replaces a previous shadow) */
+        bool Prefetch(ReaderBase &reader, int instrumentIndex);
+        /** puts a instrument loaded with Load_instrument_data and ReadSampleDataFromFile into the shadow slot, it then owns the sample data */
+        bool setShadow(ReaderBase &reader, instrument_data_temp &inst, int instrumentIndex = -1);
+        /** non blocking Prefetch, uses BeginLoad of the reader, call StepPrefetch from loop() until it's not Loading anymore */
+        bool BeginPrefetch(ReaderBase &reader, int instrumentIndex);
+        AsyncLoadState StepPrefetch(uint32_t budget_us);
+
+        /**
+         * makes the shadow instrument the active one, returns false if there is no shadow
+         * if a previous swap is still waiting for voices to finish, those are stopped first
+         */
+        bool Swap();
+        /** gives the active instrument to voices that have stopped playing, and frees the old instrument when it's not used, call often from loop() */
+        void Service();
+        /** call before playNote, gives the voice the active instrument if it still has the old one (note. this stops the voice) */
+        void ActivateVoice(int voiceIndex);
+        /** frees all instruments */
+        void Free();
+
+        AudioSynthWavetable::instrument_data* getActive() { return active.inst; }
+        int getActiveIndex() { return active.index; }
+        bool hasShadow() { return shadow.inst != nullptr; }
+        int getShadowIndex() { return shadow.index; }
+        /** true while the previous instrument is still used by a voice */
+        bool isRetiredInUse() { return retired.inst != nullptr; }
+
+      private:
+        struct Loaded
+        {
+            AudioSynthWavetable::instrument_data *inst = nullptr;
+            SamplePool pool;
+            int index = -1;
+
+            void Free();
+        };
+        Loaded active;
+        Loaded shadow;
+        /** the previous active instrument, used by the voices that are marked in pending */
+        Loaded retired;
+
+        AudioSynthWavetable *voices = nullptr;
+        int voiceCount = 0;
+        bool pending[SF22ASWT_SLOT_MAX_VOICES];
+        ReaderBase *loadingReader = nullptr;
+    };
+
+    /**
+     * remembers which program follows which, the next program is predicted
+     * as the one that most often followed the current program
+     */
+    class ProgramPredictor
+    {
+      public:
+        /** call on every program change */
+        void Record(int program);
+        /** the program that most often followed the last recorded program, -1 if not known */
+        int Predict();
+        void Clear();
+
+      private:
+        struct Transition
+        {
+            int16_t from = -1;
+            int16_t to = -1;
+            uint16_t count = 0;
+        };
+        Transition transitions[SF22ASWT_PREDICTOR_SIZE];
+        int last = -1;
+    };
+}
@@ -0,0 +1,77 @@
+/**
+ * the instrument and preset lists of PrintInstrumentListAsJson/PrintPresetListAsJson (both readers)
+ * written with the ForEach iterators of the reader and a JsonWriter
+ *
+ * the output is
+ * json:{"instruments":[{"name":"..","ndx":0},..],"offset":0,"more":false}
+ * json:{"presets":[{"name":"..","bank":0,"preset":0,"bagNdx":0},..],"offset":0,"more":false}
+ * where offset is the index of the first listed item of the matching items
+ * and more is true when there are more matching items after the last listed one (i.e. the next page)
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+#include "sf22aswt_json_writer.h"
+#include "sf22aswt_views.h"
+#include "sf22aswt_helpers.h"
+
+namespace SF22ASWT::JsonList
+{
+    /**
+     * lists at most limit items that matches filter (the name contains it, case insensitive, nullptr or "" matches all)
+     * starting with the offset matching item, the iteration stops when the page is full
+     * item(json, view) writes the values of a item
+     */
+    template<class ForEach, class Item>
+    bool PrintList(Print &printStream, const char *listName, uint32_t offset, uint32_t limit, const char *filter, ForEach forEach, Item item)
+    {
+        bool filtered = (filter != nullptr && filter[0] != '\0');
+        JsonWriter json(printStream);
+        json.print("json:");
+        json.beginObject();
+        json.beginArray(listName);
+        uint32_t skip = filtered ? offset : 0; // without a filter the iterator starts directly at offset
+        uint32_t count = 0;
+        bool more = false;
+        bool readOK = forEach([&](const auto &view) {
+            if (filtered && Helpers::containsIgnoreCase(view.name, view.nameLength, filter) == false) return true;
+            if (skip > 0) { skip--; return true; }
+            if (count == limit) { more = true; return false; }
+            json.beginObject();
+            item(json, view);
+            json.endObject();
+            count++;
+            return true;
+        }, filtered ? 0 : offset);
+        json.endArray();
+        json.value("offset", (long)offset);
+        json.value("more", more);
+        json.endObject();
+        json.println();
+        return readOK;
+    }
+
+    template<class Reader>
+    bool PrintInstruments(Reader &reader, Print &printStream, uint32_t offset, uint32_t limit, const char *filter)
+    {
+        return PrintList(printStream, "instruments", offset, limit, filter,
+            [&](auto callback, uint32_t first) { return reader.ForEachInstrument(callback, first); },
+            [](JsonWriter &json, const InstrumentView &inst) {
+                json.value("name", inst.name, inst.nameLength);
+                json.value("ndx", (long)inst.ibag_start);
+            });
+    }
+
+    template<class Reader>
+    bool PrintPresets(Reader &reader, Print &printStream, uint32_t offset, uint32_t limit, const char *filter)
+    {
+        return PrintList(printStream, "presets", offset, limit, filter,
+            [&](auto callback, uint32_t first) { return reader.ForEachPreset(callback, first); },
+            [](JsonWriter &json, const PresetView &preset) {
+                json.value("name", preset.name, preset.nameLength);
+                json.value("bank", (long)preset.bank);
+                json.value("preset", (long)preset.program);
+                json.value("bagNdx", (long)preset.pbag_start);
+            });
+    }
+}
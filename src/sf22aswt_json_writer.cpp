@@ -0,0 +1,113 @@
+#include "sf22aswt_json_writer.h"
+
+namespace SF22ASWT
+{
+    size_t JsonWriter::write(uint8_t c)
+    {
+        if (used == SF22ASWT_JSON_BUFFER_SIZE) flush();
+        buffer[used++] = c;
+        return 1;
+    }
+
+    size_t JsonWriter::write(const uint8_t *data, size_t size)
+    {
+        size_t left = size;
+        while (left > 0)
+        {
+            if (used == SF22ASWT_JSON_BUFFER_SIZE) flush();
+            size_t n = SF22ASWT_JSON_BUFFER_SIZE - used;
+            if (n > left) n = left;
+            memcpy(&buffer[used], data, n);
+            used += n;
+            data += n;
+            left -= n;
+        }
+        return size;
+    }
+
+    void JsonWriter::flush()
+    {
+        if (used == 0) return;
+        output.write(buffer, used);
+        used = 0;
+    }
+
+    void JsonWriter::beginItem(const char *key)
+    {
+        uint32_t bit = (uint32_t)1 << (depth & 31);
+        if (hasItems & bit) write(',');
+        hasItems |= bit;
+        if (key != nullptr) {
+            writeString(key, strlen(key));
+            write(':');
+        }
+    }
+
+    void JsonWriter::beginObject(const char *key)
+    {
+        beginItem(key);
+        write('{');
+        depth++;
+        hasItems &= ~((uint32_t)1 << (depth & 31));
+    }
+
+    void JsonWriter::endObject()
+    {
+        depth--;
+        write('}');
+    }
+
+    void JsonWriter::beginArray(const char *key)
+    {
+        beginItem(key);
+        write('[');
+        depth++;
+        hasItems &= ~((uint32_t)1 << (depth & 31));
+    }
+
+    void JsonWriter::endArray()
+    {
+        depth--;
+        write(']');
+    }
+
+    void JsonWriter::value(const char *key, const char *str, size_t length)
+    {
+        beginItem(key);
+        writeString(str, length);
+    }
+
+    void JsonWriter::value(const char *key, long number)
+    {
+        beginItem(key);
+        print(number);
+    }
+
+    void JsonWriter::value(const char *key, bool boolean)
+    {
+        beginItem(key);
+        print(boolean ? "true" : "false");
+    }
+
+    void JsonWriter::writeString(const char *str, size_t length)
+    {
+        static const char hex[] = "0123456789ABCDEF";
+        write('"');
+        for (size_t i=0;i<length && str[i] != '\0';i++)
+        {
+            uint8_t c = (uint8_t)str[i];
+            if (c == '"' || c == '\\') {
+                write('\\');
+                write(c);
+            }
+            else if (c < 32 || c > 126) {
+                // the names are not UTF-8, so everything outside printable ASCII is escaped
+                uint8_t escaped[6] = { '\\', 'u', '0', '0', (uint8_t)hex[c >> 4], (uint8_t)hex[c & 0x0F] };
+                write(escaped, 6);
+            }
+            else
+                write(c);
+        }
+        write('"');
+    }
+}
@@ -0,0 +1,61 @@
+/**
+ * buffered JSON writer used by PrintInstrumentListAsJson/PrintPresetListAsJson
+ *
+ * everything is collected in a buffer of SF22ASWT_JSON_BUFFER_SIZE bytes that is written to the output
+ * with a single write when full, so a USB serial gets full packets instead of many tiny writes
+ * the commas between the items are written by the writer, so there is never a trailing comma
+ * strings are escaped, names that are not printable ASCII are written as \u00XX
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+
+#ifndef SF22ASWT_JSON_BUFFER_SIZE
+#if defined(__IMXRT1062__)
+/** the size of a USB high speed bulk packet (Teensy 4.x) */
+#define SF22ASWT_JSON_BUFFER_SIZE 512
+#else
+/** the size of a USB full speed bulk packet */
+#define SF22ASWT_JSON_BUFFER_SIZE 64
+#endif
+#endif
+
+namespace SF22ASWT
+{
+    class JsonWriter : public Print
+    {
+      public:
+        JsonWriter(Print &output) : output(output) {}
+        JsonWriter(const JsonWriter&) = delete;
+        JsonWriter& operator=(const JsonWriter&) = delete;
+        ~JsonWriter() { flush(); }
+
+        using Print::write;
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t *buffer, size_t size) override;
+        /** writes the buffered data to the output */
+        void flush() override;
+
+        /** key is only used inside a object */
+        void beginObject(const char *key = nullptr);
+        void endObject();
+        void beginArray(const char *key = nullptr);
+        void endArray();
+        /** a escaped string of length chars (stops at a null char) */
+        void value(const char *key, const char *str, size_t length);
+        void value(const char *key, long number);
+        void value(const char *key, bool boolean);
+
+      private:
+        Print &output;
+        uint8_t buffer[SF22ASWT_JSON_BUFFER_SIZE];
+        size_t used = 0;
+        /** one bit per nesting level, set when the level have a item (so that the next needs a comma) */
+        uint32_t hasItems = 0;
+        uint8_t depth = 0;
+
+        /** the comma and the key of the next item */
+        void beginItem(const char *key);
+        void writeString(const char *str, size_t length);
+    };
+}
@@ -0,0 +1,167 @@
+#include "sf22aswt_name_index.h"
+
+namespace SF22ASWT
+{
+    static inline char toLower(char c) { return (c >= 'A' && c <= 'Z') ? (c + ('a' - 'A')) : c; }
+
+    /** the length of a name without the null padding and the trailing spaces, maxLength limits the search for the null */
+    static uint32_t getTrimmedLength(const char *name, uint32_t maxLength)
+    {
+        uint32_t length = 0;
+        while (length < maxLength && name[length] != '\0') length++;
+        while (length > 0 && name[length-1] == ' ') length--;
+        return length;
+    }
+
+    /** FNV-1a of the lower case name */
+    static uint32_t getHash(const char *name, uint32_t length)
+    {
+        uint32_t hash = 0x811C9DC5;
+        for (uint32_t i=0;i<length;i++)
+        {
+            hash ^= (uint8_t)toLower(name[i]);
+            hash *= 0x01000193;
+        }
+        return hash;
+    }
+
+    bool NameIndex::Alloc(uint32_t count)
+    {
+        Free();
+        if (count >= UINT16_MAX) return false; // the hash table stores index+1
+        uint32_t tableSize = 2;
+        while (tableSize < count*2) tableSize <<= 1; // max half full, so the probe sequences stays short
+
+        // the arrays are placed in order of alignment
+        size = count*4 + tableSize*2 + count*2 + count*NameSize + count;
+        useExtMem = (external_psram_size != 0);
+        block = (uint8_t*)(useExtMem ? extmem_malloc(size) : malloc(size));
+        if (block == nullptr) { size = 0; return false; }
+
+        uint8_t *ptr = block;
+        hashes = (uint32_t*)ptr; ptr += count*4;
+        hashTable = (uint16_t*)ptr; ptr += tableSize*2;
+        sorted = (uint16_t*)ptr; ptr += count*2;
+        names = (char*)ptr; ptr += count*NameSize;
+        lengths = ptr;
+
+        this->count = count;
+        hashMask = tableSize - 1;
+        return true;
+    }
+
+    void NameIndex::Free()
+    {
+        if (block != nullptr) {
+            if (useExtMem) extmem_free(block);
+            else free(block);
+        }
+        block = nullptr;
+        size = 0;
+        built = false;
+        count = 0;
+        hashMask = 0;
+        names = nullptr;
+        hashes = nullptr;
+        hashTable = nullptr;
+        sorted = nullptr;
+        lengths = nullptr;
+    }
+
+    void NameIndex::Set(uint32_t index, const char *name)
+    {
+        memcpy(&names[index*NameSize], name, NameSize);
+        lengths[index] = getTrimmedLength(name, NameSize);
+        hashes[index] = getHash(name, lengths[index]);
+    }
+
+    void NameIndex::Finish()
+    {
+        for (uint32_t i=0;i<=hashMask;i++) hashTable[i] = 0;
+        for (uint32_t i=0;i<count;i++)
+        {
+            uint32_t slot = hashes[i] & hashMask;
+            while (hashTable[slot] != 0) slot = (slot + 1) & hashMask;
+            hashTable[slot] = i + 1;
+        }
+
+        // shell sort, as the names are not sorted in the file and there can be a few thousands of them
+        for (uint32_t i=0;i<count;i++) sorted[i] = i;
+        uint32_t gap = 1;
+        while (gap < count/3) gap = gap*3 + 1;
+        for (;gap>0;gap/=3)
+        {
+            for (uint32_t i=gap;i<count;i++)
+            {
+                uint16_t item = sorted[i];
+                uint32_t j = i;
+                for (;j>=gap && compareItems(sorted[j-gap], item) > 0;j-=gap)
+                    sorted[j] = sorted[j-gap];
+                sorted[j] = item;
+            }
+        }
+        built = true;
+    }
+
+    int NameIndex::compare(uint32_t index, const char *str, uint32_t length, bool prefix)
+    {
+        const char *name = getName(index);
+        uint32_t nameLength = lengths[index];
+        if (prefix && nameLength > length) nameLength = length;
+        uint32_t n = (nameLength < length) ? nameLength : length;
+        for (uint32_t i=0;i<n;i++)
+        {
+            int diff = (uint8_t)toLower(name[i]) - (uint8_t)toLower(str[i]);
+            if (diff != 0) return diff;
+        }
+        return (int)nameLength - (int)length;
+    }
+
+    int NameIndex::compareItems(uint32_t a, uint32_t b)
+    {
+        int diff = compare(a, getName(b), lengths[b], false);
+        return (diff != 0) ? diff : ((int)a - (int)b); // items with the same name stays in file order
+    }
+
+    int NameIndex::Find(const char *name)
+    {
+        if (built == false) return -1;
+        // a longer name cannot match, +1 so that it's not cut to a matching name
+        uint32_t length = getTrimmedLength(name, NameSize + 1);
+        if (length > NameSize) return -1;
+        uint32_t hash = getHash(name, length);
+        int found = -1;
+        for (uint32_t slot = hash & hashMask; hashTable[slot] != 0; slot = (slot + 1) & hashMask)
+        {
+            uint32_t index = hashTable[slot] - 1;
+            if (hashes[index] != hash || compare(index, name, length, false) != 0) continue;
+            // the items are inserted in file order, but a probe sequence can wrap around the table
+            if (found == -1 || (int)index < found) found = index;
+        }
+        return found;
+    }
+
+    uint32_t NameIndex::FindPrefix(const char *prefix, uint16_t *indexes, uint32_t maxCount)
+    {
+        if (built == false) return 0;
+        uint32_t length = getTrimmedLength(prefix, NameSize + 1);
+        if (length > NameSize) return 0;
+
+        // the first sorted item that is not less than the prefix
+        uint32_t low = 0;
+        uint32_t high = count;
+        while (low < high)
+        {
+            uint32_t mid = (low + high) / 2;
+            if (compare(sorted[mid], prefix, length, true) < 0) low = mid + 1;
+            else high = mid;
+        }
+        uint32_t matches = 0;
+        for (uint32_t i=low;i<count && compare(sorted[i], prefix, length, true) == 0;i++)
+        {
+            if (indexes != nullptr && matches < maxCount) indexes[matches] = sorted[i];
+            matches++;
+        }
+        return matches;
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ * name lookup of the instruments (achInstName) or presets (achPresetName), built once on the first lookup
+ *
+ * the 20 byte names are copied into a single block (placed in PSRAM when available) together with
+ * a FNV-1a hash table for exact lookups and a list of the indexes sorted by name for prefix searches
+ * names are compared case insensitive and trailing spaces are ignored, as fonts are not consistent with either
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+
+namespace SF22ASWT
+{
+    class NameIndex
+    {
+      public:
+        /** the size of the name fields in the file */
+        static const uint32_t NameSize = 20;
+
+        NameIndex() {}
+        NameIndex(const NameIndex&) = delete;
+        NameIndex& operator=(const NameIndex&) = delete;
+        ~NameIndex() { Free(); }
+
+        /** allocates the index for count names (max 65534) */
+        bool Alloc(uint32_t count);
+        void Free();
+        /** name is the raw NameSize bytes field (don't need to be null terminated) */
+        void Set(uint32_t index, const char *name);
+        /** builds the hash table and the sorted list, must be called when all names are set */
+        void Finish();
+
+        /** returns the index of the first item with the name, or -1 when not found */
+        int Find(const char *name);
+        /**
+         * finds all items which name starts with prefix, the indexes are written to indexes in name order (at most maxCount)
+         * returns the total number of matches, that can be more than maxCount (indexes can then be nullptr to only count them)
+         */
+        uint32_t FindPrefix(const char *prefix, uint16_t *indexes, uint32_t maxCount);
+
+        bool isBuilt() { return built; }
+        uint32_t getCount() { return count; }
+        /** the raw name field of a item (not null terminated), use getNameLength for its length */
+        const char* getName(uint32_t index) { return &names[index*NameSize]; }
+        uint8_t getNameLength(uint32_t index) { return lengths[index]; }
+        /** the size in bytes of the index */
+        size_t getSize() { return size; }
+
+      private:
+        uint8_t *block = nullptr;
+        size_t size = 0;
+        bool useExtMem = false;
+        bool built = false;
+        uint32_t count = 0;
+        /** hashTableSize-1, the table size is a power of 2 */
+        uint32_t hashMask = 0;
+
+        char *names = nullptr;
+        uint32_t *hashes = nullptr;
+        /** index+1 of the items, 0 = empty slot (linear probing) */
+        uint16_t *hashTable = nullptr;
+        /** the indexes of the items sorted by name */
+        uint16_t *sorted = nullptr;
+        /** the length of the names without the null padding and trailing spaces */
+        uint8_t *lengths = nullptr;
+
+        /**
+         * case insensitive compare of a item name with the length chars of str,
+         * when prefix is true only the first length chars of the item name are compared
+         */
+        int compare(uint32_t index, const char *str, uint32_t length, bool prefix);
+        int compareItems(uint32_t a, uint32_t b);
+    };
+}
@@ -0,0 +1,31 @@
+/**
+ * platform specific functions that only exists on Teensy 4.x
+ * on other platforms (i.e. when running on a host together with
+ * SF22ASWT_STORAGE_POSIX/MMAP/MEMORY) they are replaced with
+ * internal ram versions so that the same code can be used
+ *
+ * this is the only place where the Arduino core and the audio library are included,
+ * without ARDUINO (a host build) sf22aswt_platform_host.h provides the parts that are used
+*/
+#pragma once
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include <Audio.h>
+#else
+#include "sf22aswt_platform_host.h"
+#endif
+
+#if defined(__IMXRT1062__)
+#define SF22ASWT_HAS_EXTMEM 1
+#else
+#define SF22ASWT_HAS_EXTMEM 0
+#endif
+
+/** size of the external ram (PSRAM) in MB, 0 if not available */
+extern "C" uint8_t external_psram_size;
+
+#if SF22ASWT_HAS_EXTMEM == 0
+inline void *extmem_malloc(size_t size) { return malloc(size); }
+inline void extmem_free(void *ptr) { free(ptr); }
+#endif
@@ -0,0 +1,80 @@
+#if !defined(ARDUINO)
+
+#include "sf22aswt_platform_host.h"
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+
+String::String(double value, int decimals)
+{
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+    s = buffer;
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+    while (n < size && write(buffer[n]) == 1) n++;
+    return n;
+}
+
+size_t Print::printSigned(long long n, int base)
+{
+    // like the Arduino Print only base 10 is printed with a sign, other bases prints the two's complement
+    if (base == DEC) return printNumber((n < 0) ? (0ull - (unsigned long long)n) : (unsigned long long)n, base, n < 0);
+    return printNumber((unsigned long long)n, base, false);
+}
+
+size_t Print::printNumber(unsigned long long n, int base, bool negative)
+{
+    if (base < 2) base = DEC;
+    char buffer[66];
+    char *str = &buffer[sizeof(buffer) - 1];
+    *str = '\0';
+    do {
+        int digit = (int)(n % base);
+        *--str = (char)((digit < 10) ? ('0' + digit) : ('A' + digit - 10));
+        n /= base;
+    } while (n != 0);
+    if (negative) *--str = '-';
+    return write(str);
+}
+
+size_t HostSerial::write(uint8_t c)
+{
+    return (fputc(c, stdout) == EOF) ? 0 : 1;
+}
+
+size_t HostSerial::write(const uint8_t *buffer, size_t size)
+{
+    return fwrite(buffer, 1, size, stdout);
+}
+
+void HostSerial::flush()
+{
+    fflush(stdout);
+}
+
+HostSerial Serial;
+HostSerial SerialUSB;
+HostSerial SerialUSB1;
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+uint32_t micros()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+uint32_t millis()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(uint32_t ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+#endif
@@ -0,0 +1,204 @@
+/**
+ * the parts of the Arduino core and the Teensy Audio library that the library uses,
+ * for building on a host (linux/mac) together with SF22ASWT_STORAGE_POSIX/MMAP/MEMORY
+ *
+ * only included by sf22aswt_platform.h when ARDUINO is not defined, so the Teensy build
+ * uses the real Arduino.h and Audio.h
+ *
+ * String and Print have the same interface as the Arduino ones (for what the library uses),
+ * Serial writes to stdout, micros/millis uses a monotonic clock
+ * AudioSynthWavetable only have the data structures and constants used by the converter,
+ * it don't play anything, AudioStream allocates the audio blocks from the heap and transmit does nothing
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/types.h>
+#include <string>
+
+#define PROGMEM
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class String
+{
+  public:
+    String() {}
+    String(const char *str) : s((str != nullptr) ? str : "") {}
+    String(const char *str, size_t length) : s(str, length) {}
+    String(char c) : s(1, c) {}
+    String(int value) : s(std::to_string(value)) {}
+    String(unsigned int value) : s(std::to_string(value)) {}
+    String(long value) : s(std::to_string(value)) {}
+    String(unsigned long value) : s(std::to_string(value)) {}
+    String(long long value) : s(std::to_string(value)) {}
+    String(unsigned long long value) : s(std::to_string(value)) {}
+    String(double value, int decimals = 2);
+
+    const char *c_str() const { return s.c_str(); }
+    unsigned int length() const { return (unsigned int)s.length(); }
+    char operator[](unsigned int index) const { return (index < s.length()) ? s[index] : '\0'; }
+
+    String& operator+=(const String &other) { s += other.s; return *this; }
+    friend String operator+(const String &a, const String &b) { String r(a); r += b; return r; }
+    friend String operator+(const String &a, const char *b) { return a + String(b); }
+    friend String operator+(const char *a, const String &b) { return String(a) + b; }
+
+    bool operator==(const String &other) const { return s == other.s; }
+    bool operator!=(const String &other) const { return s != other.s; }
+    bool operator==(const char *other) const { return s == ((other != nullptr) ? other : ""); }
+    bool operator!=(const char *other) const { return (*this == other) == false; }
+
+  private:
+    std::string s;
+};
+
+class Print
+{
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *str) { return write((const uint8_t*)str, strlen(str)); }
+    size_t write(const char *buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const char *str) { return write(str); }
+    size_t print(const String &str) { return write(str.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char n, int base = DEC) { return printNumber(n, base, false); }
+    size_t print(int n, int base = DEC) { return printSigned(n, base); }
+    size_t print(unsigned int n, int base = DEC) { return printNumber(n, base, false); }
+    size_t print(long n, int base = DEC) { return printSigned(n, base); }
+    size_t print(unsigned long n, int base = DEC) { return printNumber(n, base, false); }
+    size_t print(long long n, int base = DEC) { return printSigned(n, base); }
+    size_t print(unsigned long long n, int base = DEC) { return printNumber(n, base, false); }
+    size_t print(double n, int digits = 2) { return print(String(n, digits)); }
+
+    size_t println() { return write((uint8_t)'\n'); }
+    template<class T> size_t println(const T &value) { size_t n = print(value); return n + println(); }
+    template<class T> size_t println(const T &value, int format) { size_t n = print(value, format); return n + println(); }
+
+  private:
+    size_t printSigned(long long n, int base);
+    size_t printNumber(unsigned long long n, int base, bool negative);
+};
+
+/** writes to stdout */
+class HostSerial : public Print
+{
+  public:
+    void begin(uint32_t) {}
+    operator bool() { return true; }
+    int available() { return 0; }
+    int read() { return -1; }
+    using Print::write;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    void flush() override;
+};
+
+extern HostSerial Serial;
+extern HostSerial SerialUSB;
+extern HostSerial SerialUSB1;
+
+uint32_t micros();
+uint32_t millis();
+void delay(uint32_t ms);
+inline void yield() {}
+
+#define AUDIO_BLOCK_SAMPLES 128
+#define AUDIO_SAMPLE_RATE_EXACT 44117.64706f
+
+#define WAVETABLE_CENTS_SHIFT(C) (pow(2.0, (C)/1200.0))
+#define WAVETABLE_NOTE_TO_FREQUENCY(N) (440.0 * pow(2.0, ((N) - 69) / 12.0))
+#define WAVETABLE_DECIBEL_SHIFT(dB) (pow(10.0, (dB)/20.0))
+
+#define AudioNoInterrupts()
+#define AudioInterrupts()
+
+typedef struct audio_block_struct
+{
+    uint8_t ref_count;
+    uint8_t reserved1;
+    uint16_t memory_pool_index;
+    int16_t data[AUDIO_BLOCK_SAMPLES];
+} audio_block_t;
+
+class AudioStream
+{
+  public:
+    AudioStream(unsigned char ninput, audio_block_t **iqueue) { (void)ninput; (void)iqueue; }
+    virtual ~AudioStream() {}
+    virtual void update(void) = 0;
+
+  protected:
+    static audio_block_t *allocate(void) { return new audio_block_t(); }
+    static void release(audio_block_t *block) { delete block; }
+    void transmit(audio_block_t *block, unsigned char index = 0) { (void)block; (void)index; }
+};
+
+class AudioSynthWavetable : public AudioStream
+{
+  public:
+    /** the same layout as in the audio library, the converter creates these */
+    struct sample_data
+    {
+        const int16_t *sample;
+        const bool LOOP;
+        const int INDEX_BITS;
+        const float PER_HERTZ_PHASE_INCREMENT;
+        const uint32_t MAX_PHASE;
+        const uint32_t LOOP_PHASE_END;
+        const uint32_t LOOP_PHASE_LENGTH;
+        const uint16_t INITIAL_ATTENUATION_SCALAR;
+        const uint32_t DELAY_COUNT;
+        const uint32_t ATTACK_COUNT;
+        const uint32_t HOLD_COUNT;
+        const uint32_t DECAY_COUNT;
+        const uint32_t RELEASE_COUNT;
+        const int32_t SUSTAIN_MULT;
+        const uint32_t VIBRATO_DELAY;
+        const uint32_t VIBRATO_INCREMENT;
+        const float VIBRATO_PITCH_COEFFICIENT_INITIAL;
+        const float VIBRATO_PITCH_COEFFICIENT_SECOND;
+        const uint32_t MODULATION_DELAY;
+        const uint32_t MODULATION_INCREMENT;
+        const float MODULATION_PITCH_COEFFICIENT_INITIAL;
+        const float MODULATION_PITCH_COEFFICIENT_SECOND;
+        const int32_t MODULATION_AMPLITUDE_INITIAL_GAIN;
+        const int32_t MODULATION_AMPLITUDE_SECOND_GAIN;
+    };
+
+    struct instrument_data
+    {
+        const uint8_t sample_count;
+        const uint8_t *sample_note_ranges;
+        const sample_data *samples;
+    };
+
+    static const int32_t UNITY_GAIN = INT32_MAX;
+    static constexpr float SAMPLES_PER_MSEC = (AUDIO_SAMPLE_RATE_EXACT/1000.0);
+    static const int32_t LFO_SMOOTHNESS = 3;
+    static constexpr float LFO_PERIOD = (AUDIO_BLOCK_SAMPLES/(1 << (LFO_SMOOTHNESS-1)));
+    static constexpr float ENVELOPE_PERIOD = 8;
+
+    AudioSynthWavetable() : AudioStream(0, nullptr) {}
+
+    void setInstrument(const instrument_data &instrument) { this->instrument = &instrument; playing = false; }
+    void playNote(int note, int amplitude = 90) { (void)note; (void)amplitude; playing = (instrument != nullptr); }
+    void stop() { playing = false; }
+    bool isPlaying() { return playing; }
+    void update(void) override {}
+
+  private:
+    const instrument_data *instrument = nullptr;
+    bool playing = false;
+};
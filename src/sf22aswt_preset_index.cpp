@@ -0,0 +1,104 @@
+#include "sf22aswt_preset_index.h"
+
+namespace SF22ASWT
+{
+    bool PresetIndex::Alloc(uint32_t presetCount)
+    {
+        Free();
+        records = new preset_index_rec[presetCount + 1];
+        if (records == nullptr) return false;
+        this->presetCount = presetCount;
+        return true;
+    }
+
+    void PresetIndex::Free()
+    {
+        delete[] records;
+        records = nullptr;
+        delete[] banks;
+        banks = nullptr;
+        delete[] table;
+        table = nullptr;
+        presetCount = 0;
+        bankCount = 0;
+        built = false;
+    }
+
+    void PresetIndex::Set(uint32_t index, const phdr_rec &phdr)
+    {
+        records[index].bank = phdr.wBank;
+        records[index].program = phdr.wPreset;
+        records[index].pbag_start = phdr.wPresetBagNdx;
+    }
+
+    bool PresetIndex::Finish()
+    {
+        delete[] banks;
+        banks = nullptr;
+        delete[] table;
+        table = nullptr;
+        bankCount = 0;
+
+        // the used banks in ascending order (insertion sort, there are only a few banks)
+        banks = new uint16_t[(presetCount != 0) ? presetCount : 1];
+        if (banks == nullptr) return false;
+        for (uint32_t i=0;i<presetCount;i++)
+        {
+            uint16_t bank = records[i].bank;
+            int j = bankCount;
+            while (j > 0 && banks[j-1] > bank) j--;
+            if (j > 0 && banks[j-1] == bank) continue;
+            for (int k=bankCount;k>j;k--) banks[k] = banks[k-1];
+            banks[j] = bank;
+            bankCount++;
+        }
+
+        for (int i=0;i<DirectBanks;i++) bankRow[i] = 0xFF;
+        for (int i=0;i<bankCount && banks[i]<DirectBanks;i++) bankRow[banks[i]] = i;
+
+        table = new uint16_t[bankCount*128 + 1];
+        if (table == nullptr) return false;
+        for (int i=0;i<bankCount*128;i++) table[i] = NotFound;
+        for (uint32_t i=0;i<presetCount;i++)
+        {
+            if (records[i].program > 127) continue; // not reachable by a program change
+            uint16_t &entry = table[getRow(records[i].bank)*128 + records[i].program];
+            if (entry == NotFound) entry = i; // the first one is used when a bank/program is defined more than once
+        }
+        built = true;
+        return true;
+    }
+
+    bool PresetIndex::CloneInto(PresetIndex &other)
+    {
+        other.Free();
+        if (built == false) return true;
+        if (other.Alloc(presetCount) == false) return false;
+        memcpy(other.records, records, (presetCount + 1)*sizeof(preset_index_rec));
+        return other.Finish();
+    }
+
+    int PresetIndex::getRow(uint16_t bank)
+    {
+        if (bank < DirectBanks) return (bankRow[bank] == 0xFF) ? -1 : bankRow[bank];
+        int low = 0;
+        int high = bankCount - 1;
+        while (low <= high)
+        {
+            int mid = (low + high) / 2;
+            if (banks[mid] == bank) return mid;
+            if (banks[mid] < bank) low = mid + 1;
+            else high = mid - 1;
+        }
+        return -1;
+    }
+
+    int PresetIndex::Find(uint16_t bank, uint16_t program)
+    {
+        if (built == false || program > 127) return -1;
+        int row = getRow(bank);
+        if (row == -1) return -1;
+        uint16_t index = table[row*128 + program];
+        return (index == NotFound) ? -1 : index;
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ * bank/program to preset (phdr index) lookup table, built once by ReadFile
+ *
+ * the presets are stored in file order as preset_index_rec (bank, program and the first pbag)
+ * and a table of 128 programs per used bank gives the phdr index of every bank/program,
+ * the banks 0 to 128 (128 is percussion) are mapped directly to their table row
+ * so that a MIDI program change/bank select is resolved in O(1) without any file access
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+#include "sf22aswt_structures.h"
+
+namespace SF22ASWT
+{
+    class PresetIndex
+    {
+      public:
+        /** the value of the table when the bank/program is not used */
+        static const uint16_t NotFound = 0xFFFF;
+        /** the banks that are mapped directly to a table row, the others are found with a binary search */
+        static const uint16_t DirectBanks = 129;
+
+        PresetIndex() {}
+        PresetIndex(const PresetIndex&) = delete;
+        PresetIndex& operator=(const PresetIndex&) = delete;
+        ~PresetIndex() { Free(); }
+
+        /** allocates the records for presetCount presets (+1 for the EOP record, that gives the end of the last preset bags) */
+        bool Alloc(uint32_t presetCount);
+        void Free();
+        /** index presetCount is the EOP record */
+        void Set(uint32_t index, const phdr_rec &phdr);
+        /** builds the bank/program table from the records, returns false if it could not be allocated */
+        bool Finish();
+        bool CloneInto(PresetIndex &other);
+
+        /** returns the phdr index of the preset, or -1 when not found */
+        int Find(uint16_t bank, uint16_t program);
+
+        bool isBuilt() { return built; }
+        uint32_t getPresetCount() { return presetCount; }
+        uint16_t getBankCount() { return bankCount; }
+        /** the used banks in ascending order */
+        uint16_t getBank(uint16_t index) { return banks[index]; }
+        /** the bank/program/pbag of a preset, index presetCount is the EOP record */
+        const preset_index_rec& get(uint32_t index) { return records[index]; }
+        uint16_t getPbagStart(uint32_t index) { return records[index].pbag_start; }
+        uint16_t getPbagEnd(uint32_t index) { return records[index+1].pbag_start; }
+        /** the size in bytes of the records and the table */
+        size_t getSize() { return (presetCount + 1)*sizeof(preset_index_rec) + bankCount*(2 + 128*2); }
+
+        /** presetCount+1 records, used directly by the index file */
+        preset_index_rec *records = nullptr;
+
+      private:
+        uint32_t presetCount = 0;
+        uint16_t bankCount = 0;
+        bool built = false;
+        uint16_t *banks = nullptr;
+        /** bankCount rows of 128 phdr indexes */
+        uint16_t *table = nullptr;
+        /** the table row of the banks 0 to 128, 0xFF when not used */
+        uint8_t bankRow[DirectBanks];
+
+        int getRow(uint16_t bank);
+    };
+}
@@ -1,198 +1,381 @@
-
 #include "sf22aswt_reader.h"
 
 namespace SF22ASWT
 {
-    bool Reader::ReadFile(String filePath)
+    bool Reader::CloneInto(Reader &other)
+    {
+        if (lastReadWasOK == false) return false;
+        other.Close(); // the other reader could have a different file open
+        other.lastReadWasOK = true;
+        other.fileSize = fileSize;
+        other.filePath = filePath;
+        other.keepFileOpen = keepFileOpen; // the handle is shared using the FilePool
+        other.sfbk.size = sfbk.size;
+        other.sfbk.info = sfbk.info;
+        sfbk.sdta.CloneInto(other.sfbk.sdta);
+        sfbk.pdta.CloneInto(other.sfbk.pdta);
+        other.zoneIndex.Free(); // only built on demand
+        other.instrumentNames.Free();
+        other.presetNames.Free();
+        if (presetIndex.CloneInto(other.presetIndex) == false) { other.lastReadWasOK = false; return false; }
+        return true;
+    }
+
+    bool Reader::ReadFile(const char * filePath)
     {
-        File file = SD.open(filePath.c_str());
+        lastReadWasOK = false;
+        clearErrors();
+        CancelLoad();
+        Close();
+        zoneIndex.Free();
+        presetIndex.Free();
+        instrumentNames.Free();
+        presetNames.Free();
+        sfbk.info = INFO();
+        sfbk.sdta = sdta_rec_lazy(); // so that the sm24 chunk of the previous file is not left when the new file don't have one
+        sfbk.pdta.Free();
+        // the pdta block is placed in external ram (PSRAM) if available
+        sfbk.pdta.useExtMem = (external_psram_size != 0);
+
+        File file = Storage::Open(filePath);
         if (!file) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
         fileSize = file.size();
 
-        char fourCC[4];
+        bool readOK = walkLists(file, sfbk.size, [&](uint32_t listType, uint32_t listSize) {
+            switch (listType)
+            {
+                case FourCC::INFO:
+                    sfbk.info.size = listSize;
+                    return readInfoBlock(file, sfbk.info);
+                case FourCC::sdta:
+                    sfbk.sdta.size = listSize;
+                    return read_sdta_block(file, sfbk.sdta);
+                case FourCC::pdta:
+                    sfbk.pdta.size = listSize;
+                    return read_pdta_block(file);
+                default:
+                    return skipChunk(file, Error::RootLocation::LIST, listSize - 4);
+            }
+        });
+        if (readOK == false) return false;
 
-        if ((lastReadCount = file.readBytes(fourCC, 4)) != 4) FILE_ERROR(FILE_FOURCC_READ)//("read error - while reading fileTag")
-        if (verifyFourCC(fourCC) == false) FILE_ERROR(FILE_FOURCC_INVALID)//("error - invalid fileTag")
-        if (strncmp(fourCC, "RIFF", 4) != 0) FILE_ERROR(FILE_FOURCC_MISMATCH)//("error - not a RIFF fileformat")
-        
-        if ((lastReadCount = file.read(&sfbk.size, 4)) != 4) FILE_ERROR(RIFF_SIZE_READ)//("read error - while reading RIFF size")
-        if (fileSize != (sfbk.size + 8)) FILE_ERROR(RIFF_SIZE_MISMATCH)//("error - fileSize mismatch")
+        file.close();
+        if (BuildPresetIndex() == false) { lastError = SF22ASWT::Errors::RAM_DATA_MALLOC; return false; }
+        lastReadWasOK = true;
+        this->filePath = filePath;
+        return true;
+    }
+    template<class T>
+    bool Reader::read_pdta_records(File &file, uint32_t fourCC, uint32_t size, T *&records, uint32_t &count)
+    {
+        uint16_t sub = FourCC::pdtaSubLocation(fourCC);
+        if (size % T::Size != 0) FILE_ERROR_CODE(Error::Code(Error::RootLocation::PDTA, sub, Error::Type::SIZE, Error::Operation::MISMATCH)) //("error - pdta block size mismatch")
 
-        if ((lastReadCount = file.readBytes(fourCC, 4)) != 4) FILE_ERROR(RIFF_FOURCC_READ)//("read error - while reading fileformat")
-        if (verifyFourCC(fourCC) == false) FILE_ERROR(RIFF_FOURCC_INVALID)//("error - invalid fileformat")
-        
-        if (strncmp(fourCC, "sfbk", 4) != 0) FILE_ERROR(RIFF_FOURCC_MISMATCH)//("error - not a sfbk fileformat")
+        count = size/T::Size;
+        if (size == 0) return true;
+        if ((records = (T*)sfbk.pdta.Allocate(size)) == nullptr) FILE_MALLOC_ERROR(sfbk.pdta.useExtMem, size)
+        if ((lastReadCount = file.read(records, size)) != size) FILE_ERROR_CODE(Error::Code(Error::RootLocation::PDTA, sub, Error::Type::DATA, Error::Operation::READ)) //("read error - while reading pdta records")
+        return true;
+    }
 
-        uint32_t chunkSize = 0;
-        while (file.available() > 0)
-        {
-            // every block starts with a LIST tag
-            if ((lastReadCount = file.readBytes(fourCC, 4)) != 4) FILE_ERROR(LIST_FOURCC_READ)//("read error - while reading listTag")
-            if (verifyFourCC(fourCC) == false) FILE_ERROR(LIST_FOURCC_INVALID)//("error - listTag invalid")
-            if (strncmp(fourCC, "LIST", 4) != 0) FILE_ERROR(LIST_FOURCC_MISMATCH)//("error - listTag is not LIST")
-
-            
-            if ((lastReadCount = file.read(&chunkSize, 4)) != 4) FILE_ERROR(LIST_SIZE_READ)//("read error - while getting listSize")
-
-            if ((lastReadCount = file.readBytes(fourCC, 4)) != 4) FILE_ERROR(LISTTYPE_FOURCC_READ)//("read error - while reading listType")
-            DebugPrintFOURCC(fourCC);
-            DebugPrintFOURCC_size(chunkSize);
-            if (verifyFourCC(fourCC) == false) FILE_ERROR(LISTTYPE_FOURCC_INVALID)//("error - invalid listType")
-            
-            
-            if (strncmp(fourCC, "INFO", 4) == 0)
-            {
-                sfbk.info.size = chunkSize;
-                if (readInfoBlock(file, sfbk.info) == false) return false;
-                //file.close(); return true; // early return debug test
-            }
-            else if (strncmp(fourCC, "sdta", 4) == 0)
+    bool Reader::read_pdta_block(File &file)
+    {
+        return walkChunks(file, Error::RootLocation::PDTA, FourCC::pdtaSubLocation, [&](uint32_t fourCC, uint32_t size) {
+            switch (fourCC)
             {
-                sfbk.sdta.size = chunkSize;
-                if (read_sdta_block(file, sfbk.sdta) == false) return false;
-                //file.close(); return true; // early return debug test
+                case FourCC::phdr: return read_pdta_records(file, fourCC, size, sfbk.pdta.phdr, sfbk.pdta.phdr_count);
+                case FourCC::pbag: return read_pdta_records(file, fourCC, size, sfbk.pdta.pbag, sfbk.pdta.pbag_count);
+                case FourCC::pmod: return read_pdta_records(file, fourCC, size, sfbk.pdta.pmod, sfbk.pdta.pmod_count);
+                case FourCC::pgen: return read_pdta_records(file, fourCC, size, sfbk.pdta.pgen, sfbk.pdta.pgen_count);
+                case FourCC::inst: return read_pdta_records(file, fourCC, size, sfbk.pdta.inst, sfbk.pdta.inst_count);
+                case FourCC::ibag: return read_pdta_records(file, fourCC, size, sfbk.pdta.ibag, sfbk.pdta.ibag_count);
+                case FourCC::imod: return read_pdta_records(file, fourCC, size, sfbk.pdta.imod, sfbk.pdta.imod_count);
+                case FourCC::igen: return read_pdta_records(file, fourCC, size, sfbk.pdta.igen, sfbk.pdta.igen_count);
+                case FourCC::shdr: return read_pdta_records(file, fourCC, size, sfbk.pdta.shdr, sfbk.pdta.shdr_count);
+                default: return skipChunk(file, Error::RootLocation::PDTA, size);
             }
-            else if (strncmp(fourCC, "pdta", 4) == 0)
+        });
+    }
+
+    bool Reader::PrintInstrumentListAsJson(Print &printStream, uint32_t offset, uint32_t limit, const char *filter)
+    {
+        clearErrors();
+        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+        return JsonList::PrintInstruments(*this, printStream, offset, limit, filter);
+    }
+
+    bool Reader::PrintPresetListAsJson(Print &printStream, uint32_t offset, uint32_t limit, const char *filter)
+    {
+        clearErrors();
+        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+        return JsonList::PrintPresets(*this, printStream, offset, limit, filter);
+    }
+
+    bool Reader::BuildZoneIndex()
+    {
+        clearErrors();
+        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+        zoneIndex.Free();
+        if (sfbk.pdta.inst_count < 2) { lastError = SF22ASWT::Errors::PDTA_INST_DATA_READ; return false; } // the last is allways a EOI
+        uint32_t instCount = sfbk.pdta.inst_count - 1;
+
+        // the bags of all instruments are after each other, so the number of bags is the max number of zones
+        uint16_t ibag_firstIndex = sfbk.pdta.inst[0].wInstBagNdx;
+        uint16_t ibag_lastIndex = sfbk.pdta.inst[instCount].wInstBagNdx;
+        if (ibag_lastIndex < ibag_firstIndex) { lastError = SF22ASWT::Errors::PDTA_INST_DATA_READ; return false; }
+        if (zoneIndex.Alloc(instCount, ibag_lastIndex - ibag_firstIndex) == false) {
+            lastError = (external_psram_size != 0)?SF22ASWT::Errors::EXTRAM_DATA_MALLOC:SF22ASWT::Errors::RAM_DATA_MALLOC;
+            return false;
+        }
+
+        zone_gens zone;
+        sample_header_temp sample;
+        for (uint32_t i=0;i<instCount;i++)
+        {
+            zoneIndex.BeginInstrument(i);
+            uint16_t ibag_startIndex = sfbk.pdta.inst[i].wInstBagNdx;
+            uint16_t ibag_endIndex = sfbk.pdta.inst[i+1].wInstBagNdx;
+            if (ibag_endIndex <= ibag_startIndex) continue;
+            uint16_t ibag_count = ibag_endIndex - ibag_startIndex;
+
+            loadArena.Reset();
+            bag_of_gens *bags = nullptr;
+            if (fillBagsOfGens(bags, ibag_startIndex, ibag_count) == false) { zoneIndex.Free(); return false; }
+
+            // same as Load_instrument_data
+            bool globalExists = (bags[0].count != 0)?(bags[0].lastItem().sfGenOper != SFGenerator::sampleID):true;
+            int zone_count = globalExists?(ibag_count - 1):ibag_count;
+            for (int si=0;si<zone_count;si++)
             {
-                sfbk.pdta.size = chunkSize;
-                if (read_pdta_block(file) == false) return false;
-                //file.close(); return true; // early return debug test
+                get_zone_gens(bags, si, zone);
+                shdr_rec *shdr = get_sample_header(zone);
+                if (shdr == nullptr) {
+                    if (lastError != SF22ASWT::Errors::NONE) { zoneIndex.Free(); return false; } // sampleID out of range
+                    break; // classify the file as structually unsound
+                }
+                get_sample_header_values(zone, *shdr, sfbk.sdta.smpl.position, sample);
+                sample.sample = nullptr;
+                if (zoneIndex.Add(i, zone, sample) == false) break; // failsafe, cannot happen as there is at least one bag per zone
             }
-            else
-            {
-                // normally unknown blocks should be ignored
-                if (file.seek(chunkSize - 4, SeekCur) == false) FILE_SEEK_ERROR(LIST_UNKNOWN_BLOCK_DATA_SKIP, chunkSize - 4)//("seek error - while skipping unknown sfbk root block")
+        }
+        zoneIndex.Finish();
+        loadArena.Reset();
+        return true;
+    }
+
+    bool Reader::BuildNameIndex()
+    {
+        clearErrors();
+        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+        uint32_t instCount = (sfbk.pdta.inst_count != 0) ? (sfbk.pdta.inst_count - 1) : 0; // the last is allways a EOI
+        uint32_t presetCount = (sfbk.pdta.phdr_count != 0) ? (sfbk.pdta.phdr_count - 1) : 0; // the last is allways a EOP
+        if (instrumentNames.Alloc(instCount) == false || presetNames.Alloc(presetCount) == false) {
+            instrumentNames.Free();
+            presetNames.Free();
+            lastError = (external_psram_size != 0) ? SF22ASWT::Errors::EXTRAM_DATA_MALLOC : SF22ASWT::Errors::RAM_DATA_MALLOC;
+            return false;
+        }
+        for (uint32_t i=0;i<instCount;i++)
+            instrumentNames.Set(i, sfbk.pdta.inst[i].achInstName);
+        for (uint32_t i=0;i<presetCount;i++)
+            presetNames.Set(i, sfbk.pdta.phdr[i].achPresetName);
+        instrumentNames.Finish();
+        presetNames.Finish();
+        return true;
+    }
+
+    bool Reader::Load_instrument_data(uint index, SF22ASWT::instrument_data_temp &inst, bool useLoadArena)
+    {
+        clearErrors();
+        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+        if (zoneIndex.isBuilt()) return Load_instrument_data_from_zone_index(index, inst, useLoadArena);
+
+        if (index + 1 >= sfbk.pdta.inst_count) { // the last is allways a EOI
+            lastError = SF22ASWT::Errors::FUNCTION_LOAD_INST_INDEX_RANGE;
+            return false;
+        }
+
+        uint16_t ibag_startIndex = sfbk.pdta.inst[index].wInstBagNdx;
+        uint16_t ibag_endIndex = sfbk.pdta.inst[index+1].wInstBagNdx;
+
+        DebugPrint_Text_Var("\nibag_start index: ", ibag_startIndex);
+        DebugPrintln_Text_Var(", ibag_end index: ", ibag_endIndex);
+
+        if (ibag_endIndex <= ibag_startIndex) { lastError = SF22ASWT::Errors::PDTA_INST_DATA_READ; return false; }
+        uint16_t ibag_count = ibag_endIndex - ibag_startIndex;
+
+        loadArena.Reset();
+        bag_of_gens *bags = nullptr;
+        if (fillBagsOfGens(bags, ibag_startIndex, ibag_count) == false) return false;
+
+        // if the first zone ends with a sampleID gen type then there is not any global zone for that instrument
+        bool globalExists = (bags[0].count != 0)?(bags[0].lastItem().sfGenOper != SFGenerator::sampleID):true;
+
+        int zone_count = globalExists?(ibag_count - 1):ibag_count;
+        if (zone_count > UINT8_MAX) { lastError = SF22ASWT::Errors::FUNCTION_LOAD_INST_DATA_RANGE; lastReadCount = zone_count; return false; } // sample_count is a uint8_t
+        inst.sample_count = zone_count;
+
+        if (allocInstrumentArrays(inst, useLoadArena) == false) { lastError = SF22ASWT::Errors::RAM_DATA_MALLOC; return false; }
+
+        DebugPrint("\nsample count: "); DebugPrint(inst.sample_count);
+        zone_gens zone;
+        for (int si=0;si<inst.sample_count;si++)
+        {
+            // all generators of the zone are resolved once, the get_ functions below are then simple lookups
+            get_zone_gens(bags, si, zone);
+            shdr_rec *shdr = get_sample_header(zone);
+            if (shdr == nullptr) {
+                if (lastError != SF22ASWT::Errors::NONE) return false; // sampleID out of range
+                // a zone without a sample, the instrument is classified as structually unsound and ends here
+                DebugPrintln_Text_Var("error - while getting sample header @ ", si);
+                inst.sample_count = si;
+                break;
             }
+            inst.sample_note_ranges[si] = get_key_range_end(zone);
+            get_sample_header_values(zone, *shdr, sfbk.sdta.smpl.position, inst.samples[si]);
         }
-        this->filePath = filePath;
-        file.close();
         return true;
     }
-    bool Reader::read_pdta_block(File &file)
+
+    bool Reader::fillBagsOfGens(bag_of_gens*& bags, int ibag_startIndex, int ibag_count, bool preset)
     {
-        char fourCC[4];
-        uint32_t size = 0;
-        while (file.available())
+        bag_rec *bag = preset?sfbk.pdta.pbag:sfbk.pdta.ibag;
+        uint32_t bag_count = preset?sfbk.pdta.pbag_count:sfbk.pdta.ibag_count;
+        gen_rec *gen = preset?sfbk.pdta.pgen:sfbk.pdta.igen;
+        uint32_t gen_count = preset?sfbk.pdta.pgen_count:sfbk.pdta.igen_count;
+
+        // +1 because of the soundfont structure, the next bag gives the end of the gens
+        if ((uint32_t)(ibag_startIndex + ibag_count) >= bag_count) { lastError = preset?SF22ASWT::Errors::PDTA_PBAG_DATA_READ:SF22ASWT::Errors::PDTA_IBAG_DATA_READ; return false; }
+        bags = loadArena.New<bag_of_gens>(ibag_count);
+        if (bags == nullptr) { lastError = SF22ASWT::Errors::RAM_DATA_MALLOC; return false; }
+
+        for (int i=0;i<ibag_count;i++)
         {
-            if ((lastReadCount = file.readBytes(fourCC, 4)) != 4) FILE_ERROR(PDTA_FOURCC_READ)//("read error - while getting pdta block type")
-            DebugPrintFOURCC(fourCC);
-            if (verifyFourCC(fourCC) == false) FILE_ERROR(PDTA_FOURCC_INVALID)//("error - pdta type invalid")
+            uint16_t start = bag[ibag_startIndex + i].wGenNdx;
+            uint16_t end = bag[ibag_startIndex + i + 1].wGenNdx;
+            if (end < start || end > gen_count) { lastError = preset?SF22ASWT::Errors::PDTA_PGEN_DATA_READ:SF22ASWT::Errors::PDTA_IGEN_DATA_READ; return false; }
 
-            // store result for easier pinpoint of error handing
-            bool sizeReadFail = ((lastReadCount = file.read(&size, 4)) != 4);
+            // the gens are already in ram so they are used directly
+            bags[i].items = &gen[start];
+            bags[i].count = end-start;
+#ifdef SF22ASWT_DEBUG
+            DebugPrintBagContents(bags[i]);
+#endif
+        }
+        return true;
+    }
 
-            if (strncmp(fourCC, "phdr", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_PHDR_SIZE_READ) //("read error - while getting pdta phdr block size")
-                if (size % phdr_rec::Size != 0) FILE_ERROR(PDTA_PHDR_SIZE_MISMATCH)//("error - pdta phdr block size mismatch")
+    shdr_rec* Reader::get_sample_header(const zone_gens &zone)
+    {
+        SF2GeneratorAmount genval;
+        if (zone.get(SFGenerator::sampleID, &genval) == false) return nullptr;
+        if (genval.UAmount >= sfbk.pdta.shdr_count) { lastError = SF22ASWT::Errors::PDTA_SHDR_DATA_READ; return nullptr; }
+        return &sfbk.pdta.shdr[genval.UAmount];
+    }
 
-                sfbk.pdta.phdr_count = size/phdr_rec::Size;
-                sfbk.pdta.phdr = new phdr_rec[sfbk.pdta.phdr_count];
-                for (uint32_t i = 0; i < sfbk.pdta.phdr_count; i++) {
-                    if ((lastReadCount = file.read(&sfbk.pdta.phdr[i], phdr_rec::Size)) != phdr_rec::Size) FILE_ERROR(PDTA_SHDR_DATA_READ)//("read error - while reading pdta phdr record")
-                }
-            }
-            else if (strncmp(fourCC, "pbag", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_PBAG_SIZE_READ) //("read error - while getting pdta pbag block size")
-                if (size % bag_rec::Size != 0) FILE_ERROR(PDTA_PBAG_SIZE_MISMATCH)//("error - pdta pbag block size mismatch")
+#pragma region preset_load
+    bool Reader::BuildPresetIndex()
+    {
+        if (sfbk.pdta.phdr_count == 0) return true; // failsafe, a valid pdta block has at least the EOP record
+        uint32_t presetCount = sfbk.pdta.phdr_count - 1; // the last is allways a EOP
+        if (presetIndex.Alloc(presetCount) == false) return false;
+        for (uint32_t i=0;i<=presetCount;i++)
+            presetIndex.Set(i, sfbk.pdta.phdr[i]);
+        return presetIndex.Finish();
+    }
 
-                sfbk.pdta.pbag_count = size/bag_rec::Size;
-                sfbk.pdta.pbag = new bag_rec[sfbk.pdta.pbag_count];
-                for (uint32_t i = 0; i < sfbk.pdta.pbag_count; i++) {
-                    if ((lastReadCount = file.read(&sfbk.pdta.pbag[i], bag_rec::Size)) != bag_rec::Size) FILE_ERROR(PDTA_PBAG_DATA_READ)//("read error - while reading pdta pbag record")
-                }
-            }
-            else if (strncmp(fourCC, "pmod", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_PMOD_SIZE_READ) //("read error - while getting pdta pmod block size")
-                if (size % mod_rec::Size != 0) FILE_ERROR(PDTA_PMOD_SIZE_MISMATCH)//("error - pdta pmod block size mismatch")
+    bool Reader::get_preset_instrument(const zone_gens &presetZone, uint16_t &instIndex)
+    {
+        SF2GeneratorAmount genval;
+        if (presetZone.get(SFGenerator::instrument, &genval) == false) return false;
+        if ((uint32_t)genval.UAmount + 1 >= sfbk.pdta.inst_count) return false; // the last is allways a EOI
+        instIndex = genval.UAmount;
+        return true;
+    }
 
-                sfbk.pdta.pmod_count = size/mod_rec::Size;
-                sfbk.pdta.pmod = new mod_rec[sfbk.pdta.pmod_count];
-                for (uint32_t i = 0; i < sfbk.pdta.pmod_count; i++) {
-                    if ((lastReadCount = file.read(&sfbk.pdta.pmod[i], mod_rec::Size)) != mod_rec::Size) FILE_ERROR(PDTA_PMOD_DATA_READ)//("read error - while reading pdta pmod record")
-                }
-            }
-            else if (strncmp(fourCC, "pgen", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_PGEN_SIZE_READ) //("read error - while getting pdta pgen block size")
-                if (size % gen_rec::Size != 0) FILE_ERROR(PDTA_PGEN_SIZE_MISMATCH)//("error - pdta pgen block size mismatch")
+    bool Reader::Load_preset_data(uint16_t bank, uint16_t program, SF22ASWT::instrument_data_temp &inst, bool useLoadArena)
+    {
+        clearErrors();
+        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
 
-                sfbk.pdta.pgen_count = size/gen_rec::Size;
-                sfbk.pdta.pgen = new gen_rec[sfbk.pdta.pgen_count];
-                for (uint32_t i = 0; i < sfbk.pdta.pgen_count; i++) {
-                    if ((lastReadCount = file.read(&sfbk.pdta.pgen[i], gen_rec::Size)) != gen_rec::Size) FILE_ERROR(PDTA_PGEN_DATA_READ)//("read error - while reading pdta pgen record")
-                }
-            }
-            else if (strncmp(fourCC, "inst", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_INST_SIZE_READ) //("read error - while getting pdta inst block size")
-                if (size % inst_rec::Size != 0) FILE_ERROR(PDTA_INST_SIZE_MISMATCH)//("error - pdta inst block size mismatch")
+        int index = presetIndex.Find(bank, program);
+        if (index == -1) { lastError = SF22ASWT::Errors::FUNCTION_LOAD_PRESET_INDEX_RANGE; return false; }
 
-                sfbk.pdta.inst_count = size/inst_rec::Size;
-                sfbk.pdta.inst = new inst_rec[sfbk.pdta.inst_count];
-                for (uint32_t i = 0; i < sfbk.pdta.inst_count; i++) {
-                    if ((lastReadCount = file.read(&sfbk.pdta.inst[i], inst_rec::Size)) != inst_rec::Size) FILE_ERROR(PDTA_INST_DATA_READ)//("read error - while reading pdta inst record")
-                }
-            }
-            else if (strncmp(fourCC, "ibag", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_IBAG_SIZE_READ) //("read error - while getting pdta ibag block size")
-                if (size % bag_rec::Size != 0) FILE_ERROR(PDTA_IBAG_SIZE_MISMATCH)//("error - pdta ibag block size mismatch")
+        uint16_t pbag_startIndex = presetIndex.getPbagStart(index);
+        uint16_t pbag_endIndex = presetIndex.getPbagEnd(index);
+        if (pbag_endIndex <= pbag_startIndex) { lastError = SF22ASWT::Errors::PDTA_PHDR_DATA_READ; return false; }
+        uint16_t pbag_count = pbag_endIndex - pbag_startIndex;
 
-                sfbk.pdta.ibag_count = size/bag_rec::Size;
-                sfbk.pdta.ibag = new bag_rec[sfbk.pdta.ibag_count];
-                for (uint32_t i = 0; i < sfbk.pdta.ibag_count; i++) {
-                    if ((lastReadCount = file.read(&sfbk.pdta.ibag[i], bag_rec::Size)) != bag_rec::Size) FILE_ERROR(PDTA_IBAG_DATA_READ)//("read error - while reading pdta ibag record")
-                }
-            }
-            else if (strncmp(fourCC, "imod", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_IMOD_SIZE_READ) //("read error - while getting pdta imod block size")
-                if (size % mod_rec::Size != 0) FILE_ERROR(PDTA_IMOD_SIZE_MISMATCH)//("error - pdta imod block size mismatch")
+        loadArena.Reset();
+        bag_of_gens *pbags = nullptr;
+        if (fillBagsOfGens(pbags, pbag_startIndex, pbag_count, true) == false) return false;
+        int preset_zone_count = get_zone_count(pbags, pbag_count, SFGenerator::instrument);
 
-                sfbk.pdta.imod_count = size/mod_rec::Size;
-                sfbk.pdta.imod = new mod_rec[sfbk.pdta.imod_count];
-                for (uint32_t i = 0; i < sfbk.pdta.imod_count; i++) {
-                    if ((lastReadCount = file.read(&sfbk.pdta.imod[i], mod_rec::Size)) != mod_rec::Size) FILE_ERROR(PDTA_IMOD_DATA_READ)//("read error - while reading pdta imod record")
-                }
-            }
-            else if (strncmp(fourCC, "igen", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_IGEN_SIZE_READ) //("read error - while getting pdta igen block size")
-                if (size % gen_rec::Size != 0) FILE_ERROR(PDTA_IGEN_SIZE_MISMATCH)//("error - pdta igen block size mismatch")
+        // the zones of all used instruments is the upper limit, the zones outside the preset ranges are skipped later
+        zone_gens presetZone;
+        uint16_t instIndex = 0;
+        int capacity = 0;
+        for (int pi=0;pi<preset_zone_count;pi++)
+        {
+            get_zone_gens(pbags, pi, presetZone, SFGenerator::instrument);
+            if (get_preset_instrument(presetZone, instIndex) == false) continue;
+            capacity += sfbk.pdta.inst[instIndex+1].wInstBagNdx - sfbk.pdta.inst[instIndex].wInstBagNdx;
+        }
+        if (capacity > UINT8_MAX) capacity = UINT8_MAX; // sample_count is a uint8_t, addPresetZones fails if more zones are used
 
-                sfbk.pdta.igen_count = size/gen_rec::Size;
-                sfbk.pdta.igen = new gen_rec[sfbk.pdta.igen_count];
-                for (uint32_t i = 0; i < sfbk.pdta.igen_count; i++) {
-                    if ((lastReadCount = file.read(&sfbk.pdta.igen[i], gen_rec::Size)) != gen_rec::Size) FILE_ERROR(PDTA_IGEN_DATA_READ)//("read error - while reading pdta igen record")
-                }
-            }
-            else if (strncmp(fourCC, "shdr", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_SHDR_SIZE_READ) //("read error - while getting pdta shdr block size")
-                if (size % shdr_rec::Size != 0) FILE_ERROR(PDTA_SHDR_SIZE_MISMATCH)//("error - pdta shdr block size mismatch")
+        inst.sample_count = capacity;
+        if (allocInstrumentArrays(inst, useLoadArena) == false) { lastError = SF22ASWT::Errors::RAM_DATA_MALLOC; return false; }
+        inst.sample_count = 0;
 
-                sfbk.pdta.shdr_count = size/shdr_rec::Size;
-                sfbk.pdta.shdr = new shdr_rec[sfbk.pdta.shdr_count];
-                for (uint32_t i = 0; i < sfbk.pdta.shdr_count; i++) {
-                    if ((lastReadCount = file.read(&sfbk.pdta.shdr[i], shdr_rec::Size)) != shdr_rec::Size) FILE_ERROR(PDTA_SHDR_DATA_READ)//("read error - while reading pdta shdr record")
-                }
-            }
-            else if (strncmp(fourCC, "LIST", 4) == 0) // failsafe if file don't follow standard
-            {
-                // skip back
-                if (file.seek(file.position()-4) == false) FILE_SEEK_ERROR(PDTA_BACK_SEEK, file.position()-4)
-                return true;
-            }
-            else
-            {
-                // normally unknown blocks should be ignored
-                if (sizeReadFail) FILE_ERROR(PDTA_UNKNOWN_BLOCK_SIZE_READ) //("read error - while getting unknown block size")
-                if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR(PDTA_UNKNOWN_BLOCK_DATA_SKIP, size)//("seek error - while skipping unknown pdta block")
-            }
+        auto getShdr = [this](const zone_gens &zone, shdr_rec &shdr) {
+            shdr_rec *rec = get_sample_header(zone);
+            if (rec == nullptr) return false;
+            shdr = *rec;
+            return true;
+        };
+        for (int pi=0;pi<preset_zone_count;pi++)
+        {
+            get_zone_gens(pbags, pi, presetZone, SFGenerator::instrument);
+            if (get_preset_instrument(presetZone, instIndex) == false) continue; // a zone without a instrument is ignored
+            uint16_t ibag_startIndex = sfbk.pdta.inst[instIndex].wInstBagNdx;
+            uint16_t ibag_endIndex = sfbk.pdta.inst[instIndex+1].wInstBagNdx;
+            if (ibag_endIndex <= ibag_startIndex) continue;
+
+            bag_of_gens *ibags = nullptr;
+            if (fillBagsOfGens(ibags, ibag_startIndex, ibag_endIndex - ibag_startIndex) == false) return false;
+            if (addPresetZones(inst, capacity, presetZone, ibags, ibag_endIndex - ibag_startIndex, getShdr) == false) return false;
         }
+        sortZonesByKeyRange(inst);
+        DebugPrint("\nsample count: "); DebugPrint(inst.sample_count);
+        return true;
+    }
+
+    bool Reader::Load_preset(int bank, int program, AudioSynthWavetable::instrument_data*& aswt_id, Print &errPrintStream)
+    {
+        SF22ASWT::instrument_data_temp inst_temp = {0,0,nullptr};
+        if (Load_preset_data(bank, program, inst_temp, true) == false) return printLoadError(errPrintStream, "load_preset_data");
+        return loadAswtInstrument(inst_temp, aswt_id, errPrintStream);
+    }
+#pragma endregion
+
+    bool Reader::Load_instrument_from_file(const char * filePath, int instrumentIndex, AudioSynthWavetable::instrument_data **aswt_id, Print &errPrintStream)
+    {
+        if (ReadFile(filePath) == false) return printLoadError(errPrintStream, "Read file");
+        return Load_instrument(instrumentIndex, *aswt_id, errPrintStream);
+    }
+
+    bool Reader::Load_instrument(int instrumentIndex, AudioSynthWavetable::instrument_data*& aswt_id, Print &errPrintStream)
+    {
+        SF22ASWT::instrument_data_temp inst_temp = {0,0,nullptr};
+        if (Load_instrument_data(instrumentIndex, inst_temp, true) == false) return printLoadError(errPrintStream, "load_instrument_data");
+        return loadAswtInstrument(inst_temp, aswt_id, errPrintStream);
+    }
+
+    bool Reader::PrintInfoBlock(Print &printStream)
+    {
+        clearErrors();
+        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+        sfbk.info.PrintTo(printStream);
         return true;
     }
-}
\ No newline at end of file
+}
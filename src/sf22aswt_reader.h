@@ -1,26 +1,25 @@
 /**
- * this is a soundfont 2 reader that reads 
+ * this is a soundfont 2 reader that reads
  * the following blocks into ram:
  * info
- * pdta 
+ * pdta (every sub chunk is read with a single read, and is placed in PSRAM when available)
  * sdta (only store pointers to where the sample data is located in the file)
- * 
- * note. this class is not completed, and was created before the lazy reader 
- * mostly as a development guide
- * maybe it will be completed in the future to include the needed functions
- * see down 
- * 
+ *
+ * as all instrument data is in ram, loading a instrument
+ * only needs file access when reading the sample data
+ *
  */
 
 #pragma once
 
-#include <Arduino.h>
-#include <SD.h>
+#include "sf22aswt_platform.h"
 #include "sf22aswt_enums.h"
 #include "sf22aswt_structures.h"
 #include "sf22aswt_helpers.h"
 #include "sf22aswt_reader_base.h"
 #include "sf22aswt_converter.h"
+#include "sf22aswt_views.h"
+#include "sf22aswt_json_list.h"
 
 namespace SF22ASWT
 {
@@ -29,21 +28,110 @@ namespace SF22ASWT
       public:
         sfbk_rec sfbk;
 
-        bool ReadFile(String filePath);
+        bool CloneInto(Reader &other);
+        /** reads and verifies the sf2 file,
+         *  the info and pdta blocks are stored into ram
+         *  and only the position of the sample data is stored
+         */
+        bool ReadFile(const char * filePath);
+        /**
+         * resolves the zones of all instruments once and stores them in a flattened table (see getZoneIndex)
+         * Load_instrument_data then only copies the zones of the instrument from the table
+         * the table is placed in PSRAM when available and is freed by ReadFile
+        */
+        bool BuildZoneIndex();
+        /** copies the instrument and preset names into the name indexes (see ReaderBase::FindInstrument) */
+        bool BuildNameIndex();
+        /**
+         * prints at most limit instruments/presets which name contains filter (case insensitive, nullptr lists all),
+         * starting at the offset matching item (see sf22aswt_json_list.h for the format)
+         * the output is buffered and written in SF22ASWT_JSON_BUFFER_SIZE parts (a USB packet)
+        */
+        bool PrintInstrumentListAsJson(Print &printStream, uint32_t offset = 0, uint32_t limit = UINT32_MAX, const char *filter = nullptr);
+        bool PrintPresetListAsJson(Print &printStream, uint32_t offset = 0, uint32_t limit = UINT32_MAX, const char *filter = nullptr);
 
-      /* TODO implement the following functions
-        void printInstrumentListAsJson(Stream &stream);
-        void printPresetListAsJson(Stream &stream);
-        bool load_instrument_data(uint index, SF22ASWT::instrument_data_temp &inst);
-        bool load_instrument_from_file(const char * filePath, int instrumentIndex, AudioSynthWavetable::instrument_data **aswt_id);
-        void PrintInfoBlock(Print &stream);
-      */
+#pragma region iterators
+        /**
+         * calls callback(const InstrumentView&) for every instrument in file order, directly from the inst records in ram
+         * the callback returns false to stop the iteration, nothing is allocated
+         * first is the index of the first instrument, so a part of the list can be enumerated
+        */
+        template<class F>
+        bool ForEachInstrument(F callback, uint32_t first = 0)
+        {
+            clearErrors();
+            if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+            for (uint32_t i=first;i+1<sfbk.pdta.inst_count;i++) // the last is allways a EOI
+                if (callback(InstrumentView(i, sfbk.pdta.inst[i], sfbk.pdta.inst[i+1])) == false) break;
+            return true;
+        }
+        /** the same as ForEachInstrument but for the presets, callback(const PresetView&) */
+        template<class F>
+        bool ForEachPreset(F callback, uint32_t first = 0)
+        {
+            clearErrors();
+            if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+            for (uint32_t i=first;i+1<sfbk.pdta.phdr_count;i++) // the last is allways a EOP
+                if (callback(PresetView(i, sfbk.pdta.phdr[i], sfbk.pdta.phdr[i+1])) == false) break;
+            return true;
+        }
+        /** the same as ForEachInstrument but for the sample headers, callback(const SampleView&) */
+        template<class F>
+        bool ForEachSample(F callback, uint32_t first = 0)
+        {
+            clearErrors();
+            if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+            for (uint32_t i=first;i+1<sfbk.pdta.shdr_count;i++) // the last is allways a EOS
+                if (callback(SampleView(i, sfbk.pdta.shdr[i])) == false) break;
+            return true;
+        }
+#pragma endregion
+        /**
+         * this function do only load the sample preset headers for the instrument (soundfont igen data)
+         * to load the actual sample data the function <instance name>::ReadSampleDataFromFile should be used
+         * note. this function do not use any file access
+         * when useLoadArena is true the arrays of inst are allocated from the load arena,
+         * they are then only valid until the next instrument load
+        */
+        bool Load_instrument_data(uint index, SF22ASWT::instrument_data_temp &inst, bool useLoadArena = false);
+        /**
+         * this function is like Load_instrument_data but also loads the sample data
+         * the output is AudioSynthWavetable::instrument_data
+         * note that errPrintStream is default to Serial which can be changed into any Print Stream
+        */
+        bool Load_instrument(int instrumentIndex, AudioSynthWavetable::instrument_data*& aswt_id, Print &errPrintStream = Serial);
+        /**
+         * like Load_instrument_data but for the preset with the bank and program (bank 128 is percussion)
+         * the zones of all instruments of the preset are merged into inst,
+         * only the zones inside the key/velocity range of the preset zones are used
+         * and the generators of the preset zones are added to the instrument generators
+         * note. this function do not use any file access
+        */
+        bool Load_preset_data(uint16_t bank, uint16_t program, SF22ASWT::instrument_data_temp &inst, bool useLoadArena = false);
+        /**
+         * this function is like Load_preset_data but also loads the sample data
+         * the output is AudioSynthWavetable::instrument_data
+        */
+        bool Load_preset(int bank, int program, AudioSynthWavetable::instrument_data*& aswt_id, Print &errPrintStream = Serial);
+        /**
+         * this is mostly intended as a demo or to quickly use this library
+         * note that errPrintStream is default to Serial which can be changed into any Print Stream
+        */
+        bool Load_instrument_from_file(const char * filePath, int instrumentIndex, AudioSynthWavetable::instrument_data **aswt_id, Print &errPrintStream = Serial);
+        bool PrintInfoBlock(Print &printStream);
 
       private:
-        bool read_pdta_block(File &br);
-
-      /* TODO implement the following function
-        bool fillBagsOfGens(bag_of_gens* bags, int ibag_startIndex, int ibag_count);
-      */
+        sdta_rec_lazy& get_sdta() { return sfbk.sdta; }
+        bool read_pdta_block(File &file);
+        /** allocates and reads the records of a pdta sub chunk */
+        template<class T>
+        bool read_pdta_records(File &file, uint32_t fourCC, uint32_t size, T *&records, uint32_t &count);
+        /** the bags are allocated from the load arena, the items points directly into the igen (or pgen when preset is true) data */
+        bool fillBagsOfGens(bag_of_gens*& bags, int ibag_startIndex, int ibag_count, bool preset = false);
+        bool BuildPresetIndex();
+        /** the instrument index of a preset zone, returns false if it's not valid */
+        bool get_preset_instrument(const zone_gens &presetZone, uint16_t &instIndex);
+        /** returns nullptr if the zone don't have a sampleID, or when it's out of range (then lastError is set) */
+        shdr_rec* get_sample_header(const zone_gens &zone);
     };
-}
\ No newline at end of file
+}
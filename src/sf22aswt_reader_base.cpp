@@ -1,11 +1,15 @@
 
 #include "sf22aswt_reader_base.h"
+#include "sf22aswt_converter.h"
+
+#if SF22ASWT_HAS_EXTMEM == 0
+uint8_t external_psram_size = 0; // no PSRAM, C linkage from the declaration in sf22aswt_platform.h
+#endif
 
 namespace SF22ASWT
 {
     int Samples_Max_Internal_RAM_Cap = 400000;
 
-    extern "C" uint8_t external_psram_size;
     int samples_usedRam = 0;
 #ifdef SF22ASWT_DEBUG
     String ReaderBase::getLastErrorStr() { return lastErrorStr; }
@@ -27,6 +31,131 @@ namespace SF22ASWT
         lastReadCount = 0;
     }
 
+    void ReaderBase::setKeepFileOpen(bool keepOpen)
+    {
+        keepFileOpen = keepOpen;
+        if (keepOpen == false) Close();
+    }
+    bool ReaderBase::getKeepFileOpen() { return keepFileOpen; }
+
+    void ReaderBase::setMerge24bit(bool merge) { merge24bit = merge; }
+    bool ReaderBase::getMerge24bit() { return merge24bit; }
+
+    bool ReaderBase::has24bitSamples()
+    {
+        sdta_rec_lazy &sdta = get_sdta();
+        // one byte per sample, padded to a even size
+        uint32_t sampleCount = sdta.smpl.size / 2;
+        return sdta.sm24.size != 0 && sdta.sm24.size >= sampleCount && sdta.sm24.size <= sampleCount + 1;
+    }
+
+    void ReaderBase::Close()
+    {
+        FilePool::Release(sharedFile);
+        sharedFile = nullptr;
+    }
+
+    bool ReaderBase::Reopen()
+    {
+        if (lastReadWasOK == false) return false;
+        if (sharedFile == nullptr) {
+            sharedFile = FilePool::Acquire(filePath.c_str());
+            return sharedFile != nullptr;
+        }
+        return FilePool::Reopen(sharedFile);
+    }
+
+    File& ReaderBase::openFile(File &tempFile)
+    {
+        if (keepFileOpen)
+        {
+            if (sharedFile == nullptr)
+                sharedFile = FilePool::Acquire(filePath.c_str());
+            else if (!*sharedFile) // closed by a previous file error
+                FilePool::Reopen(sharedFile);
+
+            if (sharedFile != nullptr && *sharedFile) return *sharedFile;
+        }
+        tempFile = File(Storage::Open(filePath.c_str()));
+        return tempFile;
+    }
+
+    void ReaderBase::releaseFile(File &file)
+    {
+        // pooled handles (the shared file, streamed instruments and async loads) are only closed by FilePool::Release
+        if (&file != sharedFile && FilePool::getUserCount(&file) == 0) file.close();
+    }
+
+    Arena& ReaderBase::getLoadArena() { return loadArena; }
+
+    bool ReaderBase::hasZoneIndex() { return zoneIndex.isBuilt(); }
+    ZoneIndex& ReaderBase::getZoneIndex() { return zoneIndex; }
+    PresetIndex& ReaderBase::getPresetIndex() { return presetIndex; }
+    int ReaderBase::findPreset(uint16_t bank, uint16_t program) { return presetIndex.Find(bank, program); }
+
+#pragma region name_lookup
+    int ReaderBase::FindInstrument(const char *name)
+    {
+        if (instrumentNames.isBuilt() == false && BuildNameIndex() == false) return -1;
+        return instrumentNames.Find(name);
+    }
+
+    int ReaderBase::FindPreset(const char *name)
+    {
+        if (presetNames.isBuilt() == false && BuildNameIndex() == false) return -1;
+        return presetNames.Find(name);
+    }
+
+    uint32_t ReaderBase::FindInstrumentsByPrefix(const char *prefix, uint16_t *indexes, uint32_t maxCount)
+    {
+        if (instrumentNames.isBuilt() == false && BuildNameIndex() == false) return 0;
+        return instrumentNames.FindPrefix(prefix, indexes, maxCount);
+    }
+
+    uint32_t ReaderBase::FindPresetsByPrefix(const char *prefix, uint16_t *indexes, uint32_t maxCount)
+    {
+        if (presetNames.isBuilt() == false && BuildNameIndex() == false) return 0;
+        return presetNames.FindPrefix(prefix, indexes, maxCount);
+    }
+
+    NameIndex& ReaderBase::getInstrumentNameIndex() { return instrumentNames; }
+    NameIndex& ReaderBase::getPresetNameIndex() { return presetNames; }
+#pragma endregion
+
+    bool ReaderBase::Load_instrument_data_from_zone_index(uint index, instrument_data_temp &inst, bool useLoadArena)
+    {
+        if (index >= zoneIndex.getInstrumentCount()) {
+            lastError = SF22ASWT::Errors::FUNCTION_LOAD_INST_INDEX_RANGE;
+            return false;
+        }
+        uint32_t first = zoneIndex.getInstrumentZoneStart(index);
+        uint32_t zone_count = zoneIndex.getInstrumentZoneCount(index);
+        if (zone_count > UINT8_MAX) { lastError = SF22ASWT::Errors::FUNCTION_LOAD_INST_DATA_RANGE; lastReadCount = zone_count; return false; } // sample_count is a uint8_t
+        inst.sample_count = zone_count;
+        loadArena.Reset();
+        if (allocInstrumentArrays(inst, useLoadArena) == false) { lastError = SF22ASWT::Errors::RAM_DATA_MALLOC; return false; }
+
+        memcpy(inst.sample_note_ranges, &zoneIndex.keyHigh[first], inst.sample_count);
+        memcpy(inst.samples, &zoneIndex.samples[first], inst.sample_count*sizeof(sample_header_temp));
+        return true;
+    }
+
+    bool ReaderBase::allocInstrumentArrays(instrument_data_temp &inst, bool useLoadArena)
+    {
+        inst.arenaAllocated = useLoadArena;
+        if (useLoadArena)
+        {
+            inst.sample_note_ranges = loadArena.New<uint8_t>(inst.sample_count);
+            inst.samples = loadArena.New<sample_header_temp>(inst.sample_count);
+        }
+        else
+        {
+            inst.sample_note_ranges = new uint8_t[inst.sample_count];
+            inst.samples = new sample_header_temp[inst.sample_count];
+        }
+        return (inst.sample_note_ranges != nullptr) && (inst.samples != nullptr);
+    }
+
     void ReaderBase::printSF2ErrorInfo(Print &printStream)
     {
         SF22ASWT::printError(printStream, lastError); printStream.print("\n");
@@ -39,13 +168,32 @@ namespace SF22ASWT
         printStream.print(lastReadCount); printStream.print("\n");
     }
 
-    bool ReaderBase::ReadStringUsingLeadingSize(File &file, String& string)
+    bool ReaderBase::printLoadError(Print &errPrintStream, const char *step)
     {
-        uint32_t size = 0;
-        if ((lastReadCount = file.read(&size, 4)) != 4) FILE_ERROR(INFO_STRING_SIZE_READ) //FILE_ERROR("read error - while getting infoblock string size")
-        char bytes[size];
-        if ((lastReadCount = file.readBytes(bytes, size)) != size) FILE_ERROR(INFO_STRING_DATA_READ) //FILE_ERROR("read error - while reading infoblock string")
-        
+        errPrintStream.print(step); errPrintStream.println(" error:");
+        printSF2ErrorInfo(errPrintStream);
+        return false;
+    }
+
+    bool ReaderBase::loadAswtInstrument(instrument_data_temp &inst, AudioSynthWavetable::instrument_data*& aswt_id, Print &errPrintStream)
+    {
+        if (ReadSampleDataFromFile(inst) == false) return printLoadError(errPrintStream, "ReadSampleDataFromFile");
+        AudioSynthWavetable::instrument_data* new_inst = new AudioSynthWavetable::instrument_data(SF22ASWT::converter::to_AudioSynthWavetable_instrument_data(inst));
+        if (new_inst == nullptr) // failsafe
+        {
+            errPrintStream.println("convert to AudioSynthWavetable::instrument_data error!");
+            return false;
+        }
+        aswt_id = new_inst;
+        return true;
+    }
+
+    bool ReaderBase::ReadString(File &file, uint32_t size, uint16_t subLocation, String& string)
+    {
+        char bytes[size + 1];
+        if ((lastReadCount = file.readBytes(bytes, size)) != size) FILE_ERROR_CODE(Error::Code(Error::RootLocation::INFO, subLocation, Error::Type::DATA, Error::Operation::READ)) //FILE_ERROR("read error - while reading infoblock string")
+        bytes[size] = '\0'; // failsafe, the string should allready be zero terminated
+
         // TODO. sanitize bytes
         string = String(bytes);
 
@@ -59,107 +207,115 @@ namespace SF22ASWT
         return true;
     }
 
+    bool ReaderBase::skipChunk(File &file, Error::RootLocation root, uint32_t size)
+    {
+        // normally unknown blocks should be ignored
+        if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR_CODE(Error::Code(root, 0, Error::Type::UNKNOWN_BLOCK_DATA, Error::Operation::SEEKSKIP), size) //("seek error - while skipping unknown block")
+        return true;
+    }
+
     bool ReaderBase::readInfoBlock(File &file, INFO &info)
     {
-        char fourCC[4];
-        while (file.available() > 0)
-        {
-            if ((lastReadCount = file.readBytes(fourCC, 4)) != 4) FILE_ERROR(INFO_FOURCC_READ) //FILE_ERROR("read error - while getting infoblock type")
-            DebugPrintFOURCC(fourCC);
-            if (verifyFourCC(fourCC) == false) FILE_ERROR(INFO_FOURCC_INVALID) //FILE_ERROR("error - infoblock type invalid")
-
-            uint32_t dummy = 0;
-            if (strncmp(fourCC, "ifil", 4) == 0) {
-                if ((lastReadCount = file.read(&dummy, 4)) != 4) FILE_ERROR(INFO_IFIL_SIZE_READ) //FILE_ERROR("read error - ifil size dummy read")
-                if ((lastReadCount = file.read(&info.ifil, 4)) != 4) FILE_ERROR(INFO_IFIL_DATA_READ) //FILE_ERROR("read error - while ifil read")
-            }
-            else if (strncmp(fourCC, "isng", 4) == 0) { if (ReadStringUsingLeadingSize(file, info.isng) == false){ FILE_ERROR_APPEND_SUB(INFO, ISNG) return false; }}// ReadStringUsingLeadingSize takes care of the error report
-            else if (strncmp(fourCC, "INAM", 4) == 0) { if (ReadStringUsingLeadingSize(file, info.INAM) == false){ FILE_ERROR_APPEND_SUB(INFO, INAM) return false; }}// ReadStringUsingLeadingSize takes care of the error report
-            else if (strncmp(fourCC, "irom", 4) == 0) { if (ReadStringUsingLeadingSize(file, info.irom) == false){ FILE_ERROR_APPEND_SUB(INFO, IROM) return false; }}// ReadStringUsingLeadingSize takes care of the error report
-            else if (strncmp(fourCC, "iver", 4) == 0) {
-                if ((lastReadCount = file.read(&dummy, 4)) != 4) FILE_ERROR(INFO_IVER_SIZE_READ) //FILE_ERROR("read error - iver size dummy read")
-                if ((lastReadCount = file.read(&info.iver, 4)) != 4) FILE_ERROR(INFO_IVER_DATA_READ) //FILE_ERROR("read error - while iver read")
-            }
-            else if (strncmp(fourCC, "ICRD", 4) == 0) { if (ReadStringUsingLeadingSize(file, info.ICRD) == false){ FILE_ERROR_APPEND_SUB(INFO, ICRD) return false; }}// ReadStringUsingLeadingSize takes care of the error report
-            else if (strncmp(fourCC, "IENG", 4) == 0) { if (ReadStringUsingLeadingSize(file, info.IENG) == false){ FILE_ERROR_APPEND_SUB(INFO, IENG) return false; }}// ReadStringUsingLeadingSize takes care of the error report
-            else if (strncmp(fourCC, "IPRD", 4) == 0) { if (ReadStringUsingLeadingSize(file, info.IPRD) == false){ FILE_ERROR_APPEND_SUB(INFO, IPRD) return false; }}// ReadStringUsingLeadingSize takes care of the error report
-            else if (strncmp(fourCC, "ICOP", 4) == 0) { if (ReadStringUsingLeadingSize(file, info.ICOP) == false){ FILE_ERROR_APPEND_SUB(INFO, ICOP) return false; }}// ReadStringUsingLeadingSize takes care of the error report
-            else if (strncmp(fourCC, "ICMT", 4) == 0) { if (ReadStringUsingLeadingSize(file, info.ICMT) == false){ FILE_ERROR_APPEND_SUB(INFO, ICMT) return false; }}// ReadStringUsingLeadingSize takes care of the error report
-            else if (strncmp(fourCC, "ISFT", 4) == 0) { if (ReadStringUsingLeadingSize(file, info.ISFT) == false){ FILE_ERROR_APPEND_SUB(INFO, ISFT) return false; }}// ReadStringUsingLeadingSize takes care of the error report
-            else if (strncmp(fourCC, "LIST", 4) == 0)
+        return walkChunks(file, Error::RootLocation::INFO, FourCC::infoSubLocation, [&](uint32_t fourCC, uint32_t size) {
+            switch (fourCC)
             {
-                // skip back
-                if (file.seek(-4, SeekCur) == false) FILE_SEEK_ERROR(INFO_BACK_SEEK, -4)
-                return true;
+                case FourCC::ifil:
+                    if ((lastReadCount = file.read(&info.ifil, 4)) != 4) FILE_ERROR(INFO_IFIL_DATA_READ) //FILE_ERROR("read error - while ifil read")
+                    return true;
+                case FourCC::iver:
+                    if ((lastReadCount = file.read(&info.iver, 4)) != 4) FILE_ERROR(INFO_IVER_DATA_READ) //FILE_ERROR("read error - while iver read")
+                    return true;
+                case FourCC::isng: return ReadString(file, size, FourCC::infoSubLocation(fourCC), info.isng);
+                case FourCC::INAM: return ReadString(file, size, FourCC::infoSubLocation(fourCC), info.INAM);
+                case FourCC::irom: return ReadString(file, size, FourCC::infoSubLocation(fourCC), info.irom);
+                case FourCC::ICRD: return ReadString(file, size, FourCC::infoSubLocation(fourCC), info.ICRD);
+                case FourCC::IENG: return ReadString(file, size, FourCC::infoSubLocation(fourCC), info.IENG);
+                case FourCC::IPRD: return ReadString(file, size, FourCC::infoSubLocation(fourCC), info.IPRD);
+                case FourCC::ICOP: return ReadString(file, size, FourCC::infoSubLocation(fourCC), info.ICOP);
+                case FourCC::ICMT: return ReadString(file, size, FourCC::infoSubLocation(fourCC), info.ICMT);
+                case FourCC::ISFT: return ReadString(file, size, FourCC::infoSubLocation(fourCC), info.ISFT);
+                default: return skipChunk(file, Error::RootLocation::INFO, size);
             }
-            else
-            {
-                // normally unknown blocks should be ignored
-                if ((lastReadCount = file.read(&dummy, 4)) != 4) FILE_ERROR(INFO_UNKNOWN_BLOCK_SIZE_READ) //FILE_ERROR("read error - while getting unknown INFO block size")
-                if (file.seek(file.position() + dummy) == false) FILE_SEEK_ERROR(INFO_UNKNOWN_BLOCK_DATA_SKIP, file.position() + dummy) //FILE_ERROR("seek error - while skipping unknown INFO block")
-            }
-        }
-        return true;
+        });
     }
 
     bool ReaderBase::read_sdta_block(File &file, sdta_rec_lazy &sdta)
     {
-        char fourCC[4];
-        while (file.available())
-        {
-            if ((lastReadCount = file.readBytes(fourCC, 4)) != 4) FILE_ERROR(SDTA_FOURCC_READ) //("read error - while getting sdtablock type")
-            DebugPrintFOURCC(fourCC);
-            if (verifyFourCC(fourCC) == false) FILE_ERROR(SDTA_FOURCC_INVALID) //("error - sdtablock type invalid")
-            
-            if (strncmp(fourCC, "smpl", 4) == 0)
+        return walkChunks(file, Error::RootLocation::SDTA, FourCC::sdtaSubLocation, [&](uint32_t fourCC, uint32_t size) {
+            switch (fourCC)
             {
-                if ((lastReadCount = file.read(&sdta.smpl.size, 4)) != 4) FILE_ERROR(SDTA_SMPL_SIZE_READ) //("read error - while reading smpl size")
-                sdta.smpl.position = file.position();
-                // skip sample data
-                if (file.seek(sdta.smpl.size, SeekCur) == false) FILE_SEEK_ERROR(SDTA_SMPL_DATA_SKIP, sdta.smpl.size) //("seek error - while skipping smpl data")
+                case FourCC::smpl:
+                    sdta.smpl.size = size;
+                    sdta.smpl.position = file.position();
+                    // skip sample data
+                    if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR(SDTA_SMPL_DATA_SKIP, size) //("seek error - while skipping smpl data")
+                    return true;
+                case FourCC::sm24:
+                    sdta.sm24.size = size;
+                    sdta.sm24.position = file.position();
+                    // skip sample data
+                    if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR(SDTA_SM24_DATA_SKIP, size) //("seek error - while skipping sm24 data")
+                    return true;
+                default: return skipChunk(file, Error::RootLocation::SDTA, size);
             }
-            else if (strncmp(fourCC, "sm24", 4) == 0)
-            {
-                if ((lastReadCount = file.read(&sdta.sm24.size, 4)) != 4) FILE_ERROR(SDTA_SM24_SIZE_READ) //("read error - while reading sm24 size")
-                sdta.sm24.position = file.position();
-                // skip sample data
-                if (file.seek(sdta.sm24.size, SeekCur) == false) FILE_SEEK_ERROR(SDTA_SM24_DATA_SKIP, sdta.sm24.size) //("seek error - while skipping sm24 data")
-            }
-            else if (strncmp(fourCC, "LIST", 4) == 0)
-            {
-                // skip back
-                if (file.seek(file.position()-4) == false) FILE_SEEK_ERROR(SDTA_BACK_SEEK, -4)
-                return true;
-            }
-            else
+        });
+    }
+
+#pragma region preset_load
+    int ReaderBase::get_zone_count(bag_of_gens* bags, int bag_count, SFGenerator terminal)
+    {
+        if (bag_count == 0) return 0;
+        // if the first zone ends with the terminal gen type then there is not any global zone
+        bool globalExists = (bags[0].count != 0)?(bags[0].lastItem().sfGenOper != terminal):true;
+        return globalExists?(bag_count - 1):bag_count;
+    }
+
+    void ReaderBase::sortZonesByKeyRange(instrument_data_temp &inst)
+    {
+        for (int i=1;i<inst.sample_count;i++)
+        {
+            uint8_t range = inst.sample_note_ranges[i];
+            sample_header_temp sample = inst.samples[i];
+            int j = i;
+            for (;j>0 && inst.sample_note_ranges[j-1] > range;j--)
             {
-                // normally unknown blocks should be ignored
-                uint32_t size = 0;
-                if ((lastReadCount = file.read(&size, 4)) != 4) FILE_ERROR(SDTA_UNKNOWN_BLOCK_SIZE_READ) //("read error - while getting unknown sdta block size")
-                if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR(SDTA_UNKNOWN_BLOCK_DATA_SKIP, size) //("seek error - while skipping unknown sdta block")
+                inst.sample_note_ranges[j] = inst.sample_note_ranges[j-1];
+                inst.samples[j] = inst.samples[j-1];
             }
+            inst.sample_note_ranges[j] = range;
+            inst.samples[j] = sample;
         }
-        return true;
     }
+#pragma endregion
 
     void ReaderBase::FreePrevSampleData()
     {
         DebugPrintln("try to free prev loaded sampledata");
-        for (int i = 0;i<sample_count;i++)
-        {
-            if (samples[i].data != nullptr) {
-                DebugPrintln("freeing " + String(i) + " @ " + String((uint64_t)samples[i].data));
-                if (samples_useExtMem == false)
-                    free(samples[i].data);
-                else
-                    extmem_free(samples[i].data);
-
-                samples_usedRam -= samples[i].dataSize;
-            }
-        }
-        delete[] samples;
+        samples_usedRam -= samplePool.getSize();
+        samplePool.Free();
         DebugPrintln("[OK]");
-        samples = nullptr;
+    }
+
+    void ReaderBase::DetachSamplePool(SamplePool &pool)
+    {
+        // a previous content of pool is freed
+        samples_usedRam -= pool.getSize();
+        pool.Free();
+        pool.Swap(samplePool);
+    }
+
+    void ReaderBase::FreeReplacedSampleData()
+    {
+        samples_usedRam -= replacedPool.getSize();
+        replacedPool.Free();
+    }
+
+    int ReaderBase::get_sample_data_size_bytes(int length)
+    {
+        int length_32 = (int)std::ceil((double)length / 2.0f);
+        int pad_length = (length_32 % 128 == 0) ? 0 : (128 - length_32 % 128);
+        int ary_length = length_32 + pad_length;
+        return ary_length*4;
     }
 
     bool ReaderBase::ReadSampleDataFromFile(instrument_data_temp &inst, bool forceUseInternalRam)
@@ -167,22 +323,16 @@ namespace SF22ASWT
         clearErrors();
         if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
         
-        if (samples != nullptr) {
-            FreePrevSampleData();
-        } 
+        FreePrevSampleData();
+        if (stereoDownmix) pairStereoZones(inst);
         // first calculate totalSampleDataSizeBytes as an early check to minimize unnecessary loading
-        totalSampleDataSizeBytes = 0;
-        for (int si=0;si<inst.sample_count;si++)
-        {
-            int length_32 = (int)std::ceil((double)inst.samples[si].LENGTH / 2.0f);
-            int pad_length = (length_32 % 128 == 0) ? 0 : (128 - length_32 % 128);
-            int ary_length = length_32 + pad_length;
-            totalSampleDataSizeBytes+=ary_length*4;
-        }
-        samples_useExtMem = (external_psram_size != 0) && (forceUseInternalRam == false);
+        totalSampleDataSizeBytes = getResampledDataSize(inst, false);
+        bool decimate = (decimateBudget != 0) && ((size_t)totalSampleDataSizeBytes > decimateBudget);
+        if (decimate) totalSampleDataSizeBytes = getResampledDataSize(inst, true);
+        bool useExtMem = (external_psram_size != 0) && (forceUseInternalRam == false);
         
         // early check for available ram
-        if (samples_useExtMem == false) {
+        if (useExtMem == false) {
             if (totalSampleDataSizeBytes > (SF22ASWT::Samples_Max_Internal_RAM_Cap - samples_usedRam)) {
                 lastError = SF22ASWT::Errors::RAM_SIZE_INSUFF;
                 return false;
@@ -196,182 +346,750 @@ namespace SF22ASWT
             }
         }
 
-        samples = new sample_data[inst.sample_count];
-        sample_count = inst.sample_count;
-        int allocatedSize = 0;
+        // all samples are placed in a single block
+        if (samplePool.Alloc(totalSampleDataSizeBytes, useExtMem) == false) {
+            lastError = useExtMem?SF22ASWT::Errors::EXTRAM_DATA_MALLOC:SF22ASWT::Errors::RAM_DATA_MALLOC;
+            lastReadCount = totalSampleDataSizeBytes;
+#ifdef SF22ASWT_DEBUG
+            lastErrorStr = "could not allocate " + String(totalSampleDataSizeBytes) + " bytes for the sample data";
+#endif
+            return false;
+        }
+        samples_usedRam += samplePool.getSize();
 #ifdef SF22ASWT_DEBUG
-        if (samples_useExtMem)
+        if (useExtMem)
             USerial.println("using external ram (PSRAM)");
 #endif
 
-        File file = SD.open(filePath.c_str());
-        if (!file) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; } // extra failsafe
+        File tempFile;
+        File &file = openFile(tempFile);
+        if (!file) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; FreePrevSampleData(); return false; } // extra failsafe
 
+        bool merge24 = merge24bit && has24bitSamples();
+        uint8_t *poolPtr = samplePool.getData();
         for (int si=0;si<inst.sample_count;si++)
         {
             DebugPrintln_Text_Var("reading sample: ", si);
+            sample_header_temp resampled;
+            uint64_t step = 0;
+            if (getResampled(inst.samples[si], decimate, resampled, step)) {
+                int16_t *data = (int16_t*)poolPtr;
+                int ary_length = get_sample_data_size_bytes(resampled.LENGTH) / 2;
+                poolPtr += SamplePool::alignSize(ary_length*2);
+                if (readSampleDataResampled(file, inst.samples[si], data, 0, resampled.LENGTH, step, merge24) == false) { FreePrevSampleData(); return false; }
+                for (int i = resampled.LENGTH; i < ary_length;i++)
+                {
+                    data[i] = 0;
+                }
+                resampled.sample = data;
+                inst.samples[si] = resampled;
+                continue;
+            }
             int length_32 = (int)std::ceil((double)inst.samples[si].LENGTH / 2.0f);
             size_t length_8 = length_32*4;
             int pad_length = (length_32 % 128 == 0) ? 0 : (128 - length_32 % 128);
             int ary_length = length_32 + pad_length;
-            int ary_length_8 = ary_length*4;
-
-            if (samples_useExtMem == false) { // use internal ram
-                samples[si].data = (uint32_t*)malloc(ary_length_8);
-            }
-            else {
-                samples[si].data = (uint32_t*)extmem_malloc(ary_length_8);
-            }
+            uint32_t *data = (uint32_t*)poolPtr;
+            poolPtr += SamplePool::alignSize(ary_length*4);
 
-            if (samples[si].data == nullptr) {
-                lastError = SF22ASWT::Errors::RAM_DATA_MALLOC;
-#ifdef SF22ASWT_DEBUG
-                lastErrorStr = "@ sample " + String(si) + " could not allocate additional " + String(ary_length_8) + " bytes, allocated " + String(allocatedSize*4) + " of " + String(totalSampleDataSizeBytes) + " bytes";
-#endif
-                file.close();
-                FreePrevSampleData();
-                return false;
+            if (merge24 || inst.samples[si].link_start != 0) {
+                if (readSamplePart(file, inst.samples[si], 0, (int16_t*)data, length_32*2, merge24) == false) { FreePrevSampleData(); return false; }
             }
-            samples[si].dataSize = ary_length_8;
-            samples_usedRam += ary_length_8;
-
-            if (file.seek(inst.samples[si].sample_start) == false) {
+            else if (file.seek(inst.samples[si].sample_start) == false) {
                 //lastError = "@ sample " +  String(si) + " could not seek to data location in file";
                 lastError = SF22ASWT::Errors::SDTA_SMPL_DATA_SEEK;
                 lastErrorPosition = file.position();
                 lastReadCount = inst.samples[si].sample_start;
-                file.close();
+                releaseFile(file);
                 FreePrevSampleData();
                 return false;
             }
-            if ((lastReadCount = file.readBytes((char*)samples[si].data, length_8)) != length_8) {
+            else if ((lastReadCount = file.readBytes((char*)data, length_8)) != length_8) {
                 //lastError = "@ sample " +  String(si) + " could not read sample data from file, wanted:" + length_8 + " but could only read " + lastReadCount;
                 lastError = SF22ASWT::Errors::SDTA_SMPL_DATA_READ;
                 lastErrorPosition = inst.samples[si].sample_start;
-                file.close();
+                releaseFile(file);
                 FreePrevSampleData();
                 return false;
             }
             for (int i = length_32; i < ary_length;i++)
             {
-                samples[si].data[i] = 0x00000000;
+                data[i] = 0x00000000;
             }
-            inst.samples[si].sample = (int16_t*)samples[si].data;
-            allocatedSize+=ary_length;
+            inst.samples[si].sample = (int16_t*)data;
         }
 #ifdef SF22ASWT_DEBUG
         USerial.print("Used ram for samples:"); USerial.println(samples_usedRam);
 #endif
-        file.close();
+        releaseFile(file);
         return true;
     }
 
-#pragma region gen_get
-    bool ReaderBase::get_parameter_value(bag_of_gens* bags, int sampleIndex, SFGenerator genType, SF2GeneratorAmount *amount)
+    bool ReaderBase::readSampleData24(File &file, uint32_t sample_start, int first, int16_t *data, int count)
     {
-        bool globalExists = (bags[0].count != 0)?(bags[0].lastItem().sfGenOper != SFGenerator::sampleID):true;
-        int bagIndex = globalExists?(sampleIndex+1):sampleIndex;
+        sdta_rec_lazy &sdta = get_sdta();
+        uint32_t sm24_start = sdta.sm24.position + (sample_start - sdta.smpl.position) / 2 + first;
+        uint32_t smpl_start = sample_start + first*2;
+        // the smpl and sm24 parts are read and merged a chunk at a time so that the merge is done while the data is still in the cache
+        uint8_t low[SF22ASWT_SM24_CHUNK_SAMPLES];
+        for (int offset=0;offset<count;offset+=SF22ASWT_SM24_CHUNK_SAMPLES)
+        {
+            size_t n = ((count - offset) > SF22ASWT_SM24_CHUNK_SAMPLES) ? SF22ASWT_SM24_CHUNK_SAMPLES : (count - offset);
+            if (file.seek(smpl_start + offset*2) == false) FILE_SEEK_ERROR(SDTA_SMPL_DATA_SEEK, smpl_start + offset*2)
+            if ((lastReadCount = file.readBytes((char*)(data + offset), n*2)) != n*2) FILE_ERROR(SDTA_SMPL_DATA_READ)
+            if (file.seek(sm24_start + offset) == false) FILE_SEEK_ERROR(SDTA_SM24_DATA_SEEK, sm24_start + offset)
+            if ((lastReadCount = file.readBytes((char*)low, n)) != n) FILE_ERROR(SDTA_SM24_DATA_READ)
+            Sm24::Merge(data + offset, low, n, dither);
+        }
+        return true;
+    }
+
+    bool ReaderBase::readSampleChannel(File &file, uint32_t sample_start, int first, int16_t *data, int count, bool merge24)
+    {
+        if (merge24) return readSampleData24(file, sample_start, first, data, count);
+        if (file.seek(sample_start + first*2) == false) FILE_SEEK_ERROR(SDTA_SMPL_DATA_SEEK, sample_start + first*2)
+        if ((lastReadCount = file.readBytes((char*)data, count*2)) != (size_t)count*2) FILE_ERROR(SDTA_SMPL_DATA_READ)
+        return true;
+    }
+
+    bool ReaderBase::readSamplePart(File &file, const sample_header_temp &sample, int first, int16_t *data, int count, bool merge24)
+    {
+        if (sample.link_start == 0) return readSampleChannel(file, sample.sample_start, first, data, count, merge24);
+        // both channels are read a chunk at a time and the other channel is mixed into data directly after the read
+        int16_t other[SF22ASWT_STEREO_CHUNK_SAMPLES];
+        for (int offset=0;offset<count;offset+=SF22ASWT_STEREO_CHUNK_SAMPLES)
+        {
+            int n = ((count - offset) > SF22ASWT_STEREO_CHUNK_SAMPLES) ? SF22ASWT_STEREO_CHUNK_SAMPLES : (count - offset);
+            if (readSampleChannel(file, sample.sample_start, first + offset, data + offset, n, merge24) == false) return false;
+            if (readSampleChannel(file, sample.link_start, first + offset, other, n, merge24) == false) return false;
+            Stereo::Downmix(data + offset, other, n);
+        }
+        return true;
+    }
+
+    void ReaderBase::setStereoDownmix(bool downmix) { stereoDownmix = downmix; }
+    bool ReaderBase::getStereoDownmix() { return stereoDownmix; }
+
+    void ReaderBase::pairStereoZones(instrument_data_temp &inst)
+    {
+        for (int a=0;a<inst.sample_count;a++)
+        {
+            sample_header_temp &sample = inst.samples[a];
+            if (((uint16_t)sample.sample_type & ((uint16_t)SFSampleLink::leftSample | (uint16_t)SFSampleLink::rightSample)) == 0) continue;
+            if (sample.link_start != 0) continue;
+            for (int b=a+1;b<inst.sample_count;b++)
+            {
+                sample_header_temp &other = inst.samples[b];
+                // the zones of a stereo pair links to each other and covers the same keys
+                if (other.sample_id != sample.sample_link || other.sample_link != sample.sample_id) continue;
+                if (inst.sample_note_ranges[b] != inst.sample_note_ranges[a]) continue;
+
+                sample.link_start = other.sample_start;
+                if (other.LENGTH < sample.LENGTH) {
+                    sample.LENGTH = other.LENGTH;
+                    sample.LENGTH_BITS = get_length_bits(sample.LENGTH);
+                }
+                // the other zone is removed
+                for (int i=b;i<inst.sample_count-1;i++)
+                {
+                    inst.samples[i] = inst.samples[i+1];
+                    inst.sample_note_ranges[i] = inst.sample_note_ranges[i+1];
+                }
+                inst.sample_count--;
+                break;
+            }
+        }
+    }
+
+    void ReaderBase::setResampleRate(float targetRate) { resampleRate = targetRate; }
+    float ReaderBase::getResampleRate() { return resampleRate; }
+    void ReaderBase::setDecimateBudget(size_t bytes) { decimateBudget = bytes; }
+    size_t ReaderBase::getDecimateBudget() { return decimateBudget; }
+
+    bool ReaderBase::getResampled(const sample_header_temp &sample, bool decimate, sample_header_temp &resampled, uint64_t &step)
+    {
+        double ratio = 1.0;
+        if (resampleRate > 0 && sample.SAMPLE_RATE > resampleRate) ratio = resampleRate / sample.SAMPLE_RATE;
+        if (decimate) ratio *= 0.5;
+        if (ratio >= 1.0 || sample.LENGTH < Resampler::Taps) return false;
+
+        resampled = sample;
+        if (sample.LOOP && sample.LOOP_END > sample.LOOP_START) {
+            // the loop length is rounded to whole samples and the ratio (and the rate) follows it,
+            // so that the loop is still seamless and the pitch is exact
+            int loopLength = sample.LOOP_END - sample.LOOP_START;
+            int newLoopLength = (int)(loopLength * ratio + 0.5);
+            if (newLoopLength < 1 || newLoopLength >= loopLength) return false;
+            ratio = (double)newLoopLength / loopLength;
+            resampled.LOOP_START = (int)(sample.LOOP_START * ratio + 0.5);
+            resampled.LOOP_END = resampled.LOOP_START + newLoopLength;
+        }
+        else {
+            resampled.LOOP_START = (int)(sample.LOOP_START * ratio + 0.5);
+            resampled.LOOP_END = (int)(sample.LOOP_END * ratio + 0.5);
+        }
+        resampled.LENGTH = (int)std::ceil(sample.LENGTH * ratio);
+        if (sample.LENGTH > sample.LOOP_END && resampled.LENGTH <= resampled.LOOP_END) resampled.LENGTH = resampled.LOOP_END + 1;
+        resampled.LENGTH_BITS = get_length_bits(resampled.LENGTH);
+        resampled.SAMPLE_RATE = sample.SAMPLE_RATE * ratio;
+        step = Resampler::getStep(ratio);
+        return true;
+    }
+
+    int ReaderBase::getResampledDataSize(const instrument_data_temp &inst, bool decimate)
+    {
+        int size = 0;
+        for (int si=0;si<inst.sample_count;si++)
+        {
+            sample_header_temp resampled;
+            uint64_t step;
+            int length = getResampled(inst.samples[si], decimate, resampled, step) ? resampled.LENGTH : inst.samples[si].LENGTH;
+            size += SamplePool::alignSize(get_sample_data_size_bytes(length));
+        }
+        return size;
+    }
+
+    /** the output samples resampled from one chunk of input */
+    static int getResampledChunkLength(uint64_t step)
+    {
+        int outPerChunk = (int)(((uint64_t)SF22ASWT_RESAMPLER_CHUNK_SAMPLES << 32) / step);
+        return (outPerChunk < 1) ? 1 : outPerChunk;
+    }
 
-        uint16_t sampleGenCount = bags[bagIndex].count;
-        for (int i=0;i<sampleGenCount;i++)
+    bool ReaderBase::readSampleDataResampled(File &file, const sample_header_temp &sample, int16_t *data, int first, int count, uint64_t step, bool merge24)
+    {
+        if (Resampler::Init((double)4294967296.0 / step) == false) {
+            lastError = SF22ASWT::Errors::RAM_DATA_MALLOC;
+            lastReadCount = Resampler::Phases * Resampler::Taps * sizeof(int16_t);
+            releaseFile(file);
+            return false;
+        }
+        // the input is read a chunk at a time into the window, the parts outside the sample are silence
+        int16_t window[SF22ASWT_RESAMPLER_CHUNK_SAMPLES + Resampler::Taps + 2];
+        int outPerChunk = getResampledChunkLength(step);
+        int end = first + count;
+        for (int o=first;o<end;o+=outPerChunk)
         {
-            if (bags[bagIndex].items[i].sfGenOper == genType) {
-                *amount = bags[bagIndex].items[i].genAmount;
-                return true;
+            int n = ((end - o) > outPerChunk) ? outPerChunk : (end - o);
+            int inFirst = Resampler::getFirstInput(o, step);
+            int inLast = Resampler::getLastInput(o + n - 1, step);
+            int readFirst = (inFirst < 0) ? 0 : inFirst;
+            int readLast = (inLast >= sample.LENGTH) ? (sample.LENGTH - 1) : inLast;
+            for (int i=inFirst;i<readFirst;i++) window[i - inFirst] = 0;
+            for (int i=readLast+1;i<=inLast;i++) window[i - inFirst] = 0;
+            if (readLast >= readFirst) {
+                int16_t *dst = window + (readFirst - inFirst);
+                if (readSamplePart(file, sample, readFirst, dst, readLast - readFirst + 1, merge24) == false) return false;
             }
+            Resampler::Process(window, inFirst, data + o, o, n, step);
         }
-        if (globalExists == false) return false;
-        // try again with global bag
-        uint16_t globalGenCount = bags[0].count;
-        for (int i = 0; i < globalGenCount; i++)
+        return true;
+    }
+
+    uint32_t ReaderBase::getSampleCacheId(uint32_t fileId, const sample_header_temp &sample, uint64_t step, bool merge24)
+    {
+        // unprocessed samples uses the file id directly, the others are keyed by the options that changes the data
+        if (step == 0 && merge24 == false && sample.link_start == 0) return fileId;
+        uint32_t id = Helpers::fnv1a32(&step, sizeof(step), fileId);
+        id = Helpers::fnv1a32(&sample.link_start, sizeof(sample.link_start), id);
+        return Helpers::fnv1a32(&merge24, sizeof(merge24), id);
+    }
+
+    bool ReaderBase::ReadSampleDataCached(instrument_data_temp &inst, bool forceUseInternalRam)
+    {
+        clearErrors();
+        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+
+        // the same processing as ReadSampleDataFromFile, the zones keeps the file header until all samples are read
+        if (stereoDownmix) pairStereoZones(inst);
+        bool decimate = (decimateBudget != 0) && ((size_t)getResampledDataSize(inst, false) > decimateBudget);
+        bool merge24 = merge24bit && has24bitSamples();
+
+        uint32_t fileId = SampleCache::getFileId(filePath.c_str(), fileSize);
+        // first take all samples that are allready in the cache, and calculate the size of the rest
+        totalSampleDataSizeBytes = 0;
+        int missingSizeBytes = 0;
+        for (int si=0;si<inst.sample_count;si++)
         {
-            if (bags[0].items[i].sfGenOper == genType) {
-                *amount = bags[0].items[i].genAmount;
-                return true;
+            sample_header_temp &sample = inst.samples[si];
+            sample_header_temp resampled;
+            uint64_t step = 0;
+            int length = getResampled(sample, decimate, resampled, step) ? resampled.LENGTH : sample.LENGTH;
+            int size = SamplePool::alignSize(get_sample_data_size_bytes(length));
+            totalSampleDataSizeBytes += size;
+            sample.sample = SampleCache::Acquire(getSampleCacheId(fileId, sample, step, merge24), sample.sample_start, length);
+            if (sample.sample != nullptr) continue;
+            // a sample used by more than one zone is read once (see the prev scan below) so it's counted once
+            int prev = 0;
+            while (prev < si && (inst.samples[prev].sample_start != sample.sample_start || inst.samples[prev].LENGTH != sample.LENGTH || inst.samples[prev].link_start != sample.link_start)) prev++;
+            if (prev == si) missingSizeBytes += size;
+        }
+        bool useExtMem = (external_psram_size != 0) && (forceUseInternalRam == false);
+
+        // early check for available ram, released samples of other instruments are evicted to make room
+        int available = (useExtMem?(external_psram_size * 1024 * 1024):SF22ASWT::Samples_Max_Internal_RAM_Cap) - samples_usedRam;
+        if (available > 0 && (size_t)available > SampleCache::getAvailable(useExtMem)) available = (int)SampleCache::getAvailable(useExtMem);
+        if (missingSizeBytes > available) {
+            if (SampleCache::Evict(missingSizeBytes - available, useExtMem) == false) {
+                lastError = useExtMem?SF22ASWT::Errors::EXTRAM_SIZE_INSUFF:SF22ASWT::Errors::RAM_SIZE_INSUFF;
+                SampleCache::Release(inst);
+                return false;
             }
         }
-        return false;
+
+        if (missingSizeBytes != 0)
+        {
+            File tempFile;
+            File &file = openFile(tempFile);
+            if (!file) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; SampleCache::Release(inst); return false; } // extra failsafe
+
+            for (int si=0;si<inst.sample_count;si++)
+            {
+                sample_header_temp &sample = inst.samples[si];
+                if (sample.sample != nullptr) continue;
+                sample_header_temp resampled;
+                uint64_t step = 0;
+                int length = getResampled(sample, decimate, resampled, step) ? resampled.LENGTH : sample.LENGTH;
+                uint32_t id = getSampleCacheId(fileId, sample, step, merge24);
+                // the same sample can be used by more than one zone
+                int prev = 0;
+                while (prev < si && (inst.samples[prev].sample_start != sample.sample_start || inst.samples[prev].LENGTH != sample.LENGTH || inst.samples[prev].link_start != sample.link_start)) prev++;
+                if (prev < si && (sample.sample = SampleCache::Acquire(id, sample.sample_start, length)) != nullptr) continue;
+
+                int ary_length_8 = get_sample_data_size_bytes(length);
+                int16_t *data = SampleCache::Insert(id, sample.sample_start, length, ary_length_8, useExtMem);
+                if (data == nullptr) {
+                    lastError = useExtMem?SF22ASWT::Errors::EXTRAM_DATA_MALLOC:SF22ASWT::Errors::RAM_DATA_MALLOC;
+                    lastReadCount = ary_length_8;
+                    releaseFile(file);
+                    SampleCache::Release(inst);
+                    return false;
+                }
+                // like ReadSampleDataFromFile the unresampled samples are read in whole 32 bit words
+                int count = (step != 0) ? length : (int)std::ceil((double)length / 2.0f)*2;
+                bool readOK = (step != 0) ? readSampleDataResampled(file, sample, data, 0, length, step, merge24)
+                                          : readSamplePart(file, sample, 0, data, count, merge24);
+                if (readOK == false) {
+                    // the file is allready released
+                    SampleCache::Discard(data);
+                    SampleCache::Release(inst);
+                    return false;
+                }
+                memset((uint8_t*)data + count*2, 0, ary_length_8 - count*2);
+                sample.sample = data;
+            }
+            releaseFile(file);
+        }
+        // all samples are read, now the zones gets the header of the processed data
+        for (int si=0;si<inst.sample_count;si++)
+        {
+            sample_header_temp resampled;
+            uint64_t step;
+            if (getResampled(inst.samples[si], decimate, resampled, step) == false) continue;
+            resampled.sample = inst.samples[si].sample;
+            inst.samples[si] = resampled;
+        }
+        return true;
     }
-    float ReaderBase::get_decibel_value(bag_of_gens* bags, int sampleIndex, SFGenerator genType, float DEFAULT, float MIN, float MAX)
+
+    bool ReaderBase::ReadSampleDataCompressed(instrument_data_temp &inst, CompressedInstrument &compressed, bool forceUseInternalRam)
     {
-        SF2GeneratorAmount genval;
-        float val = get_parameter_value(bags, sampleIndex, genType, &genval)?genval.centibels(): DEFAULT;
-        return (val > MAX) ? MAX : ((val < MIN) ? MIN : val);
+        clearErrors();
+        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+
+        totalSampleDataSizeBytes = 0;
+        for (int si=0;si<inst.sample_count;si++)
+            totalSampleDataSizeBytes += SamplePool::alignSize(Adpcm::getEncodedSize(inst.samples[si].LENGTH));
+        bool useExtMem = (external_psram_size != 0) && (forceUseInternalRam == false);
+
+        // early check for available ram
+        if (totalSampleDataSizeBytes > (useExtMem?(external_psram_size * 1024 * 1024):SF22ASWT::Samples_Max_Internal_RAM_Cap) - samples_usedRam) {
+            lastError = useExtMem?SF22ASWT::Errors::EXTRAM_SIZE_INSUFF:SF22ASWT::Errors::RAM_SIZE_INSUFF;
+            return false;
+        }
+        if (compressed.Alloc(inst, SampleCache::getFileId(filePath.c_str(), fileSize), useExtMem) == false) {
+            lastError = useExtMem?SF22ASWT::Errors::EXTRAM_DATA_MALLOC:SF22ASWT::Errors::RAM_DATA_MALLOC;
+            lastReadCount = totalSampleDataSizeBytes;
+            return false;
+        }
+
+        File tempFile;
+        File &file = openFile(tempFile);
+        if (!file) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; compressed.Free(); return false; } // extra failsafe
+
+        // the samples are read and encoded one block at a time
+        int16_t block[SF22ASWT_ADPCM_BLOCK_SAMPLES];
+        for (int si=0;si<inst.sample_count;si++)
+        {
+            if (file.seek(inst.samples[si].sample_start) == false) {
+                lastError = SF22ASWT::Errors::SDTA_SMPL_DATA_SEEK;
+                lastErrorPosition = file.position();
+                lastReadCount = inst.samples[si].sample_start;
+                releaseFile(file);
+                compressed.Free();
+                return false;
+            }
+            uint8_t *out = compressed.getSampleData(si);
+            size_t remaining = (inst.samples[si].LENGTH > 0) ? inst.samples[si].LENGTH : 0;
+            while (remaining > 0)
+            {
+                size_t count = (remaining > SF22ASWT_ADPCM_BLOCK_SAMPLES) ? SF22ASWT_ADPCM_BLOCK_SAMPLES : remaining;
+                if ((lastReadCount = file.readBytes((char*)block, count*2)) != count*2) {
+                    lastError = SF22ASWT::Errors::SDTA_SMPL_DATA_READ;
+                    lastErrorPosition = inst.samples[si].sample_start;
+                    releaseFile(file);
+                    compressed.Free();
+                    return false;
+                }
+                Adpcm::EncodeBlock(block, count, out);
+                out += Adpcm::BlockSize;
+                remaining -= count;
+            }
+        }
+        releaseFile(file);
+        return true;
+    }
+
+    bool ReaderBase::ReadSampleDataStreamed(instrument_data_temp &inst, StreamedInstrument &streamed, uint32_t headMs, bool forceUseInternalRam)
+    {
+        clearErrors();
+        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+
+        if (streamed.Init(filePath.c_str(), inst.sample_count) == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+        // first calculate the parts that are kept in ram
+        totalSampleDataSizeBytes = 0;
+        for (int si=0;si<inst.sample_count;si++)
+        {
+            sample_header_temp &sh = inst.samples[si];
+            streamed_sample &ss = streamed.samples[si];
+            streamed.sample_note_ranges[si] = inst.sample_note_ranges[si];
+            ss.sample_start = sh.sample_start;
+            ss.length = (sh.LENGTH > 0) ? sh.LENGTH : 0;
+            ss.headLength = (uint32_t)std::ceil(sh.SAMPLE_RATE * headMs / 1000.0f);
+            if (ss.headLength > ss.length) ss.headLength = ss.length;
+            // the same loop points as the converter gives AudioSynthWavetable
+            ss.LOOP = sh.LOOP && sh.LOOP_START >= 1 && sh.LOOP_END > sh.LOOP_START && (uint32_t)sh.LOOP_END <= ss.length;
+            ss.loopStart = ss.LOOP ? (sh.LOOP_START - 1) : 0;
+            ss.loopEnd = ss.LOOP ? (sh.LOOP_END - 1) : 0;
+            ss.streamEnd = ss.LOOP ? ss.loopStart : ss.length;
+            if (ss.streamEnd < ss.headLength) ss.streamEnd = ss.headLength;
+            ss.SAMPLE_NOTE = sh.SAMPLE_NOTE;
+            ss.CENTS_OFFSET = sh.CENTS_OFFSET;
+            ss.SAMPLE_RATE = sh.SAMPLE_RATE;
+            ss.INIT_ATTENUATION = sh.INIT_ATTENUATION;
+            ss.RELEASE_ENV = sh.RELEASE_ENV;
+
+            totalSampleDataSizeBytes += SamplePool::alignSize(ss.headLength*2);
+            if (ss.LOOP) totalSampleDataSizeBytes += SamplePool::alignSize((ss.loopEnd - ss.loopStart + 1)*2);
+        }
+        bool useExtMem = (external_psram_size != 0) && (forceUseInternalRam == false);
+
+        // early check for available ram
+        if (totalSampleDataSizeBytes > (useExtMem?(external_psram_size * 1024 * 1024):SF22ASWT::Samples_Max_Internal_RAM_Cap) - samples_usedRam) {
+            lastError = useExtMem?SF22ASWT::Errors::EXTRAM_SIZE_INSUFF:SF22ASWT::Errors::RAM_SIZE_INSUFF;
+            streamed.Free();
+            return false;
+        }
+        if (streamed.getResident().Alloc(totalSampleDataSizeBytes, useExtMem) == false) {
+            lastError = useExtMem?SF22ASWT::Errors::EXTRAM_DATA_MALLOC:SF22ASWT::Errors::RAM_DATA_MALLOC;
+            lastReadCount = totalSampleDataSizeBytes;
+            streamed.Free();
+            return false;
+        }
+        samples_usedRam += streamed.getResident().getSize();
+
+        File *file = streamed.getFile();
+        uint8_t *poolPtr = streamed.getResident().getData();
+        for (int si=0;si<inst.sample_count;si++)
+        {
+            streamed_sample &ss = streamed.samples[si];
+            int16_t *head = (int16_t*)poolPtr;
+            poolPtr += SamplePool::alignSize(ss.headLength*2);
+            ss.head = head;
+            ss.loopData = nullptr;
+
+            uint32_t loopLength = ss.LOOP ? (ss.loopEnd - ss.loopStart) : 0;
+            int16_t *loopData = (int16_t*)poolPtr;
+            if (ss.LOOP) poolPtr += SamplePool::alignSize((loopLength + 1)*2);
+
+            // the head and then the loop
+            for (int part=0;part<2;part++)
+            {
+                uint32_t position = ss.sample_start + ((part == 0) ? 0 : ss.loopStart*2);
+                size_t length_8 = ((part == 0) ? ss.headLength : loopLength)*2;
+                if (length_8 == 0) continue;
+                if (file->seek(position) == false) {
+                    lastError = SF22ASWT::Errors::SDTA_SMPL_DATA_SEEK;
+                    lastErrorPosition = file->position();
+                    lastReadCount = position;
+                    streamed.Free();
+                    return false;
+                }
+                if ((lastReadCount = file->readBytes((part == 0) ? (char*)head : (char*)loopData, length_8)) != length_8) {
+                    lastError = SF22ASWT::Errors::SDTA_SMPL_DATA_READ;
+                    lastErrorPosition = position;
+                    streamed.Free();
+                    return false;
+                }
+            }
+            if (ss.LOOP) {
+                loopData[loopLength] = loopData[0]; // for the interpolation at the loop end
+                ss.loopData = loopData;
+            }
+        }
+        return true;
+    }
+
+#pragma region async_load
+    /** the samples read of a zone, the same as ReadSampleDataFromFile where the unprocessed samples are read in whole 32 bit words */
+    static uint32_t getAsyncReadLength(const sample_header_temp &sample, bool isResampled, const sample_header_temp &resampled)
+    {
+        return isResampled ? resampled.LENGTH : (int)std::ceil((double)sample.LENGTH / 2.0f)*2;
+    }
+
+    AsyncLoadState ReaderBase::getLoadState() { return asyncLoad.state; }
+    int ReaderBase::getLoadInstrumentIndex() { return asyncLoad.instrumentIndex; }
+    AudioSynthWavetable::instrument_data* ReaderBase::getLoadedInstrument() { return asyncLoad.result; }
+    int ReaderBase::getLoadProgress()
+    {
+        if (asyncLoad.state == AsyncLoadState::Done) return 100;
+        if (asyncLoad.bytesTotal == 0) return 0;
+        return (int)((uint64_t)asyncLoad.bytesRead * 100 / asyncLoad.bytesTotal);
+    }
+
+    bool ReaderBase::BeginLoad(int instrumentIndex, AsyncLoadCallback callback, bool forceUseInternalRam)
+    {
+        CancelLoad();
+        clearErrors();
+        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+        asyncLoad.instrumentIndex = instrumentIndex;
+        asyncLoad.callback = callback;
+        asyncLoad.forceUseInternalRam = forceUseInternalRam;
+        asyncLoad.sampleIndex = -1;
+        asyncLoad.sampleOffset = 0;
+        asyncLoad.bytesRead = 0;
+        asyncLoad.bytesTotal = 0;
+        asyncLoad.result = nullptr;
+        asyncLoad.state = AsyncLoadState::Loading;
+        return true;
+    }
+
+    void ReaderBase::CancelLoad()
+    {
+        if (asyncLoad.state == AsyncLoadState::Loading) {
+            samples_usedRam -= asyncLoad.pool.getSize();
+            asyncLoad.pool.Free();
+        }
+        if (asyncLoad.file == &asyncLoad.tempFile) asyncLoad.tempFile.close();
+        else if (asyncLoad.file != nullptr) FilePool::Release(asyncLoad.file);
+        asyncLoad.file = nullptr;
+        asyncLoad.inst.Free();
+        asyncLoad.state = AsyncLoadState::Idle;
+    }
+
+    AsyncLoadState ReaderBase::Step(uint32_t budget_us)
+    {
+        if (asyncLoad.state != AsyncLoadState::Loading) return asyncLoad.state;
+        uint32_t start = micros();
+        do {
+            bool ok = (asyncLoad.sampleIndex == -1) ? asyncLoadBegin() : asyncLoadRead();
+            if (ok == false) { asyncLoadFinish(false); break; }
+            if (asyncLoad.sampleIndex >= asyncLoad.inst.sample_count) { asyncLoadFinish(true); break; }
+        } while ((micros() - start) < budget_us);
+        return asyncLoad.state;
+    }
+
+    bool ReaderBase::asyncLoadBegin()
+    {
+        instrument_data_temp &inst = asyncLoad.inst;
+        // the zones must outlive the steps, the load arena is reset by every other load
+        if (Load_instrument_data(asyncLoad.instrumentIndex, inst, false) == false) return false;
+
+        // the same processing as ReadSampleDataFromFile
+        if (stereoDownmix) pairStereoZones(inst);
+        int sizeBytes = getResampledDataSize(inst, false);
+        asyncLoad.decimate = (decimateBudget != 0) && ((size_t)sizeBytes > decimateBudget);
+        if (asyncLoad.decimate) sizeBytes = getResampledDataSize(inst, true);
+        asyncLoad.merge24 = merge24bit && has24bitSamples();
+        bool useExtMem = (external_psram_size != 0) && (asyncLoad.forceUseInternalRam == false);
+
+        // the samples of the previous instrument are still in use, so both must fit
+        if (sizeBytes > (useExtMem?(external_psram_size * 1024 * 1024):SF22ASWT::Samples_Max_Internal_RAM_Cap) - samples_usedRam) {
+            lastError = useExtMem?SF22ASWT::Errors::EXTRAM_SIZE_INSUFF:SF22ASWT::Errors::RAM_SIZE_INSUFF;
+            return false;
+        }
+        if (asyncLoad.pool.Alloc(sizeBytes, useExtMem) == false) {
+            lastError = useExtMem?SF22ASWT::Errors::EXTRAM_DATA_MALLOC:SF22ASWT::Errors::RAM_DATA_MALLOC;
+            lastReadCount = sizeBytes;
+            return false;
+        }
+        samples_usedRam += asyncLoad.pool.getSize();
+        totalSampleDataSizeBytes = sizeBytes;
+        // the file is kept open between the steps, a own handle is used when the FilePool is full (the same as openFile)
+        if ((asyncLoad.file = FilePool::Acquire(filePath.c_str())) == nullptr) {
+            asyncLoad.tempFile = File(Storage::Open(filePath.c_str()));
+            if (!asyncLoad.tempFile) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+            asyncLoad.file = &asyncLoad.tempFile;
+        }
+
+        uint8_t *poolPtr = asyncLoad.pool.getData();
+        for (int si=0;si<inst.sample_count;si++)
+        {
+            sample_header_temp resampled;
+            uint64_t step = 0;
+            bool isResampled = getResampled(inst.samples[si], asyncLoad.decimate, resampled, step);
+            int size = get_sample_data_size_bytes(isResampled ? resampled.LENGTH : inst.samples[si].LENGTH);
+            // the zone keeps the file header until the sample is read, only the data pointer is set here
+            inst.samples[si].sample = (int16_t*)poolPtr;
+            // the padding is cleared here so that only the sample data needs to be read
+            memset(poolPtr, 0, size);
+            poolPtr += SamplePool::alignSize(size);
+            asyncLoad.bytesTotal += getAsyncReadLength(inst.samples[si], isResampled, resampled)*2;
+        }
+        asyncLoad.sampleIndex = 0;
+        asyncLoad.sampleOffset = 0;
+        return true;
+    }
+
+    bool ReaderBase::asyncLoadRead()
+    {
+        sample_header_temp &sample = asyncLoad.inst.samples[asyncLoad.sampleIndex];
+        File &file = *asyncLoad.file;
+        sample_header_temp resampled;
+        uint64_t step = 0;
+        bool isResampled = getResampled(sample, asyncLoad.decimate, resampled, step);
+        uint32_t length = getAsyncReadLength(sample, isResampled, resampled);
+        uint32_t count = length - asyncLoad.sampleOffset;
+        uint32_t maxCount = SF22ASWT_ASYNC_LOAD_CHUNK_SIZE/2;
+        if (isResampled) {
+            // whole input chunks, so that the input is read the same as by ReadSampleDataFromFile
+            uint32_t outPerChunk = getResampledChunkLength(step);
+            maxCount = (maxCount > outPerChunk) ? (maxCount - maxCount % outPerChunk) : outPerChunk;
+        }
+        if (count > maxCount) count = maxCount;
+
+        // the file can be shared so the position is set by every read
+        int16_t *data = (int16_t*)sample.sample;
+        bool readOK = isResampled ? readSampleDataResampled(file, sample, data, asyncLoad.sampleOffset, count, step, asyncLoad.merge24)
+                                  : readSamplePart(file, sample, asyncLoad.sampleOffset, data + asyncLoad.sampleOffset, count, asyncLoad.merge24);
+        if (readOK == false) return false;
+        asyncLoad.sampleOffset += count;
+        asyncLoad.bytesRead += count*2;
+        if (asyncLoad.sampleOffset >= length) {
+            if (isResampled) {
+                resampled.sample = sample.sample;
+                sample = resampled;
+            }
+            asyncLoad.sampleIndex++;
+            asyncLoad.sampleOffset = 0;
+        }
+        return true;
+    }
+
+    void ReaderBase::asyncLoadFinish(bool ok)
+    {
+        int instrumentIndex = asyncLoad.instrumentIndex;
+        AsyncLoadCallback callback = asyncLoad.callback;
+        if (ok) {
+            // the previous samples can still be played, they are moved aside and freed by FreeReplacedSampleData
+            // (the ones replaced by the load before are not used anymore)
+            FreeReplacedSampleData();
+            replacedPool.Swap(samplePool);
+            samplePool.Swap(asyncLoad.pool);
+            asyncLoad.result = new AudioSynthWavetable::instrument_data(SF22ASWT::converter::to_AudioSynthWavetable_instrument_data(asyncLoad.inst));
+        }
+        AudioSynthWavetable::instrument_data *result = asyncLoad.result;
+        CancelLoad();
+        asyncLoad.state = ok ? AsyncLoadState::Done : AsyncLoadState::Failed;
+        if (callback != nullptr) callback(instrumentIndex, result);
     }
-    float ReaderBase::get_timecents_value(bag_of_gens* bags, int sampleIndex, SFGenerator genType, float DEFAULT, float MIN)
+#pragma endregion
+
+#pragma region gen_get
+    void ReaderBase::get_zone_gens(bag_of_gens* bags, int sampleIndex, zone_gens &zone, SFGenerator terminal)
     {
+        bool globalExists = (bags[0].count != 0)?(bags[0].lastItem().sfGenOper != terminal):true;
+        int bagIndex = globalExists?(sampleIndex+1):sampleIndex;
+
+        zone.Clear();
+        if (globalExists) zone.Set(bags[0]);
+        // the values of the zone itself replaces the global ones
+        zone.Set(bags[bagIndex]);
+    }
+    float ReaderBase::get_decibel_value(const zone_gens &zone, SFGenerator genType, float DEFAULT)
+    {
+        if (zone.isSet(genType) == false) return DEFAULT;
         SF2GeneratorAmount genval;
-        float val = get_parameter_value(bags, sampleIndex, genType, &genval)?genval.cents()*1000.0f: DEFAULT;
-        return (val > MIN) ? val : MIN;
+        genval.Amount = zone.getClamped(genType);
+        return genval.centibels();
     }
-    float ReaderBase::get_hertz(bag_of_gens* bags, int sampleIndex, SFGenerator genType, float DEFAULT, float MIN, float MAX)
+    float ReaderBase::get_timecents_value(const zone_gens &zone, SFGenerator genType, float DEFAULT)
     {
+        if (zone.isSet(genType) == false) return DEFAULT;
         SF2GeneratorAmount genval;
-        float val = get_parameter_value(bags, sampleIndex, genType, &genval)?genval.absolute_cents(): DEFAULT;
-        return (val > MAX) ? MAX : ((val < MIN) ? MIN : val);
+        genval.Amount = zone.getClamped(genType);
+        return genval.cents()*1000.0f;
     }
-    int ReaderBase::get_pitch_cents(bag_of_gens* bags, int sampleIndex, SFGenerator genType, int DEFAULT, int MIN, int MAX)
+    float ReaderBase::get_hertz(const zone_gens &zone, SFGenerator genType, float DEFAULT)
     {
+        if (zone.isSet(genType) == false) return DEFAULT;
         SF2GeneratorAmount genval;
-        int val = get_parameter_value(bags, sampleIndex, genType, &genval)?genval.Amount: DEFAULT;
-        return (val > MAX) ? MAX : ((val < MIN) ? MIN : val);
+        genval.Amount = zone.getClamped(genType);
+        return genval.absolute_cents();
+    }
+    int ReaderBase::get_pitch_cents(const zone_gens &zone, SFGenerator genType, int DEFAULT)
+    {
+        if (zone.isSet(genType) == false) return DEFAULT;
+        return zone.getClamped(genType);
     }
-    int ReaderBase::get_cooked_loop_start(bag_of_gens* bags, int sampleIndex, shdr_rec &shdr)
+    int ReaderBase::get_cooked_loop_start(const zone_gens &zone, shdr_rec &shdr)
     {
+        // not set offsets have the default value 0
         int result = (int)(shdr.dwStartloop - shdr.dwStart);
-        SF2GeneratorAmount genval;
-        result += get_parameter_value(bags, sampleIndex, SFGenerator::startloopAddrsOffset, &genval)?genval.Amount:0;
-        result += get_parameter_value(bags, sampleIndex, SFGenerator::startloopAddrsCoarseOffset, &genval)?genval.coarse_offset():0;
+        result += zone.get(SFGenerator::startloopAddrsOffset).Amount;
+        result += zone.get(SFGenerator::startloopAddrsCoarseOffset).coarse_offset();
         return result;
     }
-    int ReaderBase::get_cooked_loop_end(bag_of_gens* bags, int sampleIndex, shdr_rec &shdr)
+    int ReaderBase::get_cooked_loop_end(const zone_gens &zone, shdr_rec &shdr)
     {
         int result = (int)(shdr.dwEndloop - shdr.dwStart);
-        SF2GeneratorAmount genval;
-        result += get_parameter_value(bags, sampleIndex, SFGenerator::endloopAddrsOffset, &genval)?genval.Amount:0;
-        result += get_parameter_value(bags, sampleIndex, SFGenerator::endloopAddrsCoarseOffset, &genval)?genval.coarse_offset():0;
+        result += zone.get(SFGenerator::endloopAddrsOffset).Amount;
+        result += zone.get(SFGenerator::endloopAddrsCoarseOffset).coarse_offset();
         return result;
     }
-    int ReaderBase::get_sample_note(bag_of_gens* bags, int sampleIndex, shdr_rec &shdr)
+    int ReaderBase::get_sample_note(const zone_gens &zone, shdr_rec &shdr)
     {
         SF2GeneratorAmount genval;
-        return get_parameter_value(bags, sampleIndex, SFGenerator::overridingRootKey, &genval)?genval.UAmount:((shdr.byOriginalKey <= 127)?shdr.byOriginalKey:60);
+        return zone.get(SFGenerator::overridingRootKey, &genval)?genval.UAmount:((shdr.byOriginalKey <= 127)?shdr.byOriginalKey:60);
     }
-    int ReaderBase::get_fine_tuning(bag_of_gens* bags, int sampleIndex)
+    int ReaderBase::get_fine_tuning(const zone_gens &zone)
     {
-        SF2GeneratorAmount genval;
-        return get_parameter_value(bags, sampleIndex, SFGenerator::fineTune, &genval)?genval.Amount:0;
+        return zone.getClamped(SFGenerator::fineTune);
     }
-    bool ReaderBase::get_sample_header(File &file, sfbk_rec_lazy &sfbk, bag_of_gens* bags, int sampleIndex, shdr_rec *shdr)
+    bool ReaderBase::get_sample_repeat(const zone_gens &zone, bool defaultValue)
     {
-        SF2GeneratorAmount genval;
-        if (get_parameter_value(bags, sampleIndex, SFGenerator::sampleID, &genval) == false) return false;
-        uint32_t seekPos = sfbk.pdta.shdr_position + genval.UAmount*shdr_rec::Size;
-        if (file.seek(seekPos) == false) FILE_SEEK_ERROR(PDTA_SHDR_DATA_SEEK, seekPos)
-        if (file.read(shdr, shdr_rec::Size) != shdr_rec::Size) FILE_ERROR(PDTA_SHDR_DATA_READ)
-        return true;
-    }
-    bool ReaderBase::get_sample_repeat(bag_of_gens* bags, int sampleIndex, bool defaultValue)
-    {
-        SF2GeneratorAmount genVal;
-        if (get_parameter_value(bags, sampleIndex, SFGenerator::sampleModes, &genVal) == false){ DebugPrintln("could not get samplemode"); return defaultValue; }
+        if (zone.isSet(SFGenerator::sampleModes) == false){ DebugPrintln("could not get samplemode"); return defaultValue; }
         
-        return (genVal.sample_mode() == SFSampleMode::kLoopContinuously);// || (val.sample_mode == SampleMode.kLoopEndsByKeyDepression);
+        return (zone.get(SFGenerator::sampleModes).sample_mode() == SFSampleMode::kLoopContinuously);// || (val.sample_mode == SampleMode.kLoopEndsByKeyDepression);
     }
-    int ReaderBase::get_length(bag_of_gens* bags, int sampleIndex, shdr_rec &shdr)
+    int ReaderBase::get_length(const zone_gens &zone, shdr_rec &shdr)
     {
         int length = (int)(shdr.dwEnd - shdr.dwStart);
-        int cooked_loop_end_val = get_cooked_loop_end(bags, sampleIndex, shdr);
-        if (get_sample_repeat(bags, sampleIndex, false) && cooked_loop_end_val < length)
+        int cooked_loop_end_val = get_cooked_loop_end(zone, shdr);
+        if (get_sample_repeat(zone, false) && cooked_loop_end_val < length)
         {
             return cooked_loop_end_val + 1;
         }
         return length;
     }
-    int ReaderBase::get_key_range_end(bag_of_gens* bags, int sampleIndex)
+    int ReaderBase::get_key_range_start(const zone_gens &zone)
     {
-        SF2GeneratorAmount genval;
-        return get_parameter_value(bags, sampleIndex, SFGenerator::keyRange, &genval)?genval.rangeHigh():127;
+        // the default range is 0-127
+        return zone.get(SFGenerator::keyRange).rangeLow();
+    }
+    int ReaderBase::get_key_range_end(const zone_gens &zone)
+    {
+        return zone.get(SFGenerator::keyRange).rangeHigh();
     }
     int ReaderBase::get_length_bits(int len)
     {
@@ -384,6 +1102,46 @@ namespace SF22ASWT
         return length_bits;
     }
 
+    void ReaderBase::get_sample_header_values(const zone_gens &zone, shdr_rec &shdr, uint32_t smpl_position, sample_header_temp &sample)
+    {
+        sample.sample_start = shdr.dwStart*2 + smpl_position;
+        sample.sample_id = zone.get(SFGenerator::sampleID).UAmount;
+        sample.sample_link = shdr.wSampleLink;
+        sample.sample_type = shdr.sfSampleType;
+        sample.link_start = 0;
+        sample.LOOP = get_sample_repeat(zone, false);
+        sample.SAMPLE_NOTE = get_sample_note(zone, shdr);
+        sample.CENTS_OFFSET = get_fine_tuning(zone);
+        sample.LENGTH = get_length(zone, shdr);
+        sample.LENGTH_BITS = get_length_bits(sample.LENGTH);
+        sample.SAMPLE_RATE = shdr.dwSampleRate;
+        sample.LOOP_START = get_cooked_loop_start(zone, shdr);
+        sample.LOOP_END = get_cooked_loop_end(zone, shdr);
+        sample.INIT_ATTENUATION = get_decibel_value(zone, SFGenerator::initialAttenuation, 0) * -1;
+        DebugPrintln("getting vol env");
+        // VOLUME ENVELOPE VALUES
+        sample.DELAY_ENV = get_timecents_value(zone, SFGenerator::delayVolEnv, 0);
+        sample.ATTACK_ENV = get_timecents_value(zone, SFGenerator::attackVolEnv, 1);
+        sample.HOLD_ENV = get_timecents_value(zone, SFGenerator::holdVolEnv, 0);
+        sample.DECAY_ENV = get_timecents_value(zone, SFGenerator::decayVolEnv, 1);
+        sample.RELEASE_ENV = get_timecents_value(zone, SFGenerator::releaseVolEnv, 1);
+        sample.SUSTAIN_FRAC = get_decibel_value(zone, SFGenerator::sustainVolEnv, 0) * -1;
+        DebugPrintln("getting vib vals");
+        // VIRBRATO VALUES
+        sample.VIB_DELAY_ENV = get_timecents_value(zone, SFGenerator::delayVibLFO, 0);
+        sample.VIB_INC_ENV = get_hertz(zone, SFGenerator::freqVibLFO, 8.176);
+        sample.VIB_PITCH_INIT = get_pitch_cents(zone, SFGenerator::vibLfoToPitch, 0);
+        sample.VIB_PITCH_SCND = sample.VIB_PITCH_INIT * -1; //pitch_cents(zone, SFGenerator::vibLfoToPitch, 0, -12000, 12000) * -1;
+        DebugPrintln("getting mod vals");
+        // MODULATION VALUES
+        sample.MOD_DELAY_ENV = get_timecents_value(zone, SFGenerator::delayModLFO, 0);
+        sample.MOD_INC_ENV = get_hertz(zone, SFGenerator::freqModLFO, 8.176);
+        sample.MOD_PITCH_INIT = get_pitch_cents(zone, SFGenerator::modLfoToPitch, 0);
+        sample.MOD_PITCH_SCND = sample.MOD_PITCH_INIT * -1; //pitch_cents(zone, SFGenerator::modLfoToPitch, 0, -12000, 12000) * -1;
+        sample.MOD_AMP_INIT_GAIN = get_decibel_value(zone, SFGenerator::modLfoToVolume, 0);
+        sample.MOD_AMP_SCND_GAIN = sample.MOD_AMP_INIT_GAIN * -1; //decibel_value(zone, SFGenerator::modLfoToVolume, 0, -96, 96) * -1;
+    }
+
     void ReaderBase::DebugPrintBagContents(bag_of_gens &gen)
     {
         DebugPrint("bag contents:\n");
@@ -393,6 +1151,8 @@ namespace SF22ASWT
             DebugPrint_Text_Var("  sfGenOper:", (uint16_t)gen.items[i2].sfGenOper);
             DebugPrintln_Text_Var(", value:", gen.items[i2].genAmount.UAmount);
         }
+#else
+        (void)gen;
 #endif
     }
 #pragma endregion
@@ -1,10 +1,24 @@
 #pragma once
 
-#include <Arduino.h>
-#include <SD.h>
+#include "sf22aswt_platform.h"
+#include "sf22aswt_buffered_file.h"
+#include "sf22aswt_file_pool.h"
+#include "sf22aswt_arena.h"
+#include "sf22aswt_zone_index.h"
+#include "sf22aswt_preset_index.h"
+#include "sf22aswt_name_index.h"
+#include "sf22aswt_riff.h"
+#include "sf22aswt_sample_pool.h"
+#include "sf22aswt_sample_cache.h"
+#include "sf22aswt_sample_stream.h"
+#include "sf22aswt_compressed_instrument.h"
+#include "sf22aswt_sm24.h"
+#include "sf22aswt_resampler.h"
+#include "sf22aswt_stereo.h"
 #include "sf22aswt_enums.h"
 #include "sf22aswt_error_enums.h"
 #include "sf22aswt_structures.h"
+#include "sf22aswt_generators.h"
 #include "sf22aswt_helpers.h"
 
 #ifndef USerial
@@ -32,11 +46,20 @@
   #define DebugPrintFOURCC_size(size)
 #endif
 
-#define FILE_ERROR(ERROR_TYPE) {lastError=SF22ASWT::Errors::ERROR_TYPE; lastErrorPosition = file.position() - lastReadCount; file.close(); return false;}
-#define FILE_SEEK_ERROR(ERROR_TYPE, SEEK_POS) {lastError=SF22ASWT::Errors::ERROR_TYPE; lastErrorPosition = file.position(); lastReadCount = SEEK_POS; file.close(); return false; }
-#define FILE_ERROR_APPEND_SUB(ROOT_TYPE, SUB_TYPE) lastError = (SF22ASWT::Errors)((uint16_t)lastError & (uint16_t)SF22ASWT::Error::ROOT_TYPE::SUB_TYPE);
+/** the file is released with releaseFile, so a shared (pooled) handle is never closed by a error */
+#define FILE_ERROR(ERROR_TYPE) {lastError=SF22ASWT::Errors::ERROR_TYPE; lastErrorPosition = file.position() - lastReadCount; releaseFile(file); return false;}
+#define FILE_SEEK_ERROR(ERROR_TYPE, SEEK_POS) {lastError=SF22ASWT::Errors::ERROR_TYPE; lastErrorPosition = file.position(); lastReadCount = SEEK_POS; releaseFile(file); return false; }
+#define FILE_MALLOC_ERROR(USE_EXTMEM, SIZE) {lastError=(USE_EXTMEM)?SF22ASWT::Errors::EXTRAM_DATA_MALLOC:SF22ASWT::Errors::RAM_DATA_MALLOC; lastErrorPosition = file.position(); lastReadCount = SIZE; releaseFile(file); return false; }
+/** same as FILE_ERROR and FILE_SEEK_ERROR but takes the error value, i.e. from SF22ASWT::Error::Code */
+#define FILE_ERROR_CODE(ERROR_CODE) {lastError=(ERROR_CODE); lastErrorPosition = file.position() - lastReadCount; releaseFile(file); return false;}
+#define FILE_SEEK_ERROR_CODE(ERROR_CODE, SEEK_POS) {lastError=(ERROR_CODE); lastErrorPosition = file.position(); lastReadCount = SEEK_POS; releaseFile(file); return false; }
         
 
+#ifndef SF22ASWT_ASYNC_LOAD_CHUNK_SIZE
+/** the max bytes of sample data read by every file read of a async load (BeginLoad/Step), smaller values gives shorter steps */
+#define SF22ASWT_ASYNC_LOAD_CHUNK_SIZE 8192
+#endif
+
 namespace SF22ASWT
 {
     extern int Samples_Max_Internal_RAM_Cap;
@@ -46,6 +69,16 @@ namespace SF22ASWT
      * and for future use when multiple instruments can be loaded at once
     */
     extern int samples_usedRam; // 
+    enum class AsyncLoadState : uint8_t
+    {
+        Idle,
+        Loading,
+        Done,
+        Failed
+    };
+    /** called by ReaderBase::Step when a async load is done, inst is nullptr if the load failed (see getLastError) */
+    typedef void (*AsyncLoadCallback)(int instrumentIndex, AudioSynthWavetable::instrument_data *inst);
+
     /**
      * this class is only intended for inherited use
      * and contains the 'common' stuff that is used on both lazy reader and 'normal' reader
@@ -65,10 +98,146 @@ namespace SF22ASWT
 
         void printSF2ErrorInfo(Print &print);
         bool ReadSampleDataFromFile(instrument_data_temp &inst, bool forceUseInternalRam = false);
+        /**
+         * moves the sample data of the last ReadSampleDataFromFile (or async load) into pool,
+         * it's then not freed by the next load and must be freed by the new owner (and subtracted from samples_usedRam)
+         */
+        void DetachSamplePool(SamplePool &pool);
+        /**
+         * frees the samples that was replaced by the last async load (see BeginLoad),
+         * call it when no voice plays the previous instrument anymore
+         */
+        void FreeReplacedSampleData();
+        /**
+         * like ReadSampleDataFromFile but the samples are taken from the shared SampleCache,
+         * samples that are allready used by other loaded instruments (of any reader) are not read again
+         * the samples gets the same processing (stereo downmix, resampling and sm24 merge) as ReadSampleDataFromFile,
+         * the options are part of the cache key so the same sample loaded with other options is a own entry
+         * the samples of the instrument are not freed by the next call and must be released with SampleCache::Release
+         * when the instrument is not used anymore, released samples stays cached until they are evicted
+         * when there is not enough ram, released samples (least recently used first) are evicted before failing
+         */
+        bool ReadSampleDataCached(instrument_data_temp &inst, bool forceUseInternalRam = false);
+        /**
+         * reads the samples and keeps them ADPCM compressed in compressed (PSRAM if available)
+         * use compressed.Decode to get a playable instrument (see sf22aswt_compressed_instrument.h)
+         */
+        bool ReadSampleDataCompressed(instrument_data_temp &inst, CompressedInstrument &compressed, bool forceUseInternalRam = false);
+        /**
+         * for long samples that don't fit in ram, only the first headMs of every sample
+         * and the loop region is read into streamed, the rest is streamed from file while playing
+         * the instrument is played with StreamVoice (see sf22aswt_sample_stream.h) instead of AudioSynthWavetable
+         * the samples are streamed as they are in the file (16 bit mono at the sample rate of the file),
+         * so setMerge24bit, setStereoDownmix, setResampleRate and setDecimateBudget are not used here
+         */
+        bool ReadSampleDataStreamed(instrument_data_temp &inst, StreamedInstrument &streamed, uint32_t headMs = SF22ASWT_STREAM_HEAD_MS, bool forceUseInternalRam = false);
+
+        /**
+         * opt-in, keeps the file open between calls instead of opening and closing it in every function
+         * readers that uses the same file (i.e. CloneInto copies) shares the same handle (see SF22ASWT_FILE_POOL_SIZE)
+         * if the pool is full the file is opened/closed in every call as normal
+         */
+        void setKeepFileOpen(bool keepOpen);
+        bool getKeepFileOpen();
+        /** releases the kept open file, it's opened again on the next call if keepFileOpen is set */
+        void Close();
+        /** closes and opens the kept open file again, i.e. after the sd card was changed */
+        bool Reopen();
+
+        /**
+         * opt-in, ReadSampleDataFromFile (and Load_instrument) merges the extra low bytes of 24 bit fonts (sm24) with the samples
+         * and dithers the result down to 16 bit (see sf22aswt_sm24.h), it has no effect on fonts without valid sm24 data
+         */
+        void setMerge24bit(bool merge);
+        bool getMerge24bit();
+        /** true when the file has a sm24 chunk that matches the smpl chunk */
+        bool has24bitSamples();
+        /**
+         * opt-in, ReadSampleDataFromFile (and Load_instrument) converts samples with a higher rate than targetRate
+         * (i.e. 48 kHz or 96 kHz samples to AUDIO_SAMPLE_RATE_EXACT) with a polyphase filter (see sf22aswt_resampler.h)
+         * this saves ram and the instrument data gets the adjusted SAMPLE_RATE, LENGTH, LOOP_START and LOOP_END, 0 = off
+         */
+        void setResampleRate(float targetRate);
+        float getResampleRate();
+        /** opt-in, when the sample data of a instrument is larger than bytes all samples are also decimated by 2, 0 = off */
+        void setDecimateBudget(size_t bytes);
+        size_t getDecimateBudget();
+        /**
+         * opt-in, ReadSampleDataFromFile (and Load_instrument) pairs the zones of stereo samples (linked by wSampleLink)
+         * and loads each pair as a single mono zone that is the downmix of both channels, this halves the ram of stereo instruments
+         * as AudioSynthWavetable only plays mono, the other channel is otherwise played as a own zone or not at all
+         */
+        void setStereoDownmix(bool downmix);
+        bool getStereoDownmix();
+
+        /** implemented by the readers */
+        virtual bool Load_instrument_data(uint index, SF22ASWT::instrument_data_temp &inst, bool useLoadArena = false) = 0;
+        virtual bool Load_preset_data(uint16_t bank, uint16_t program, SF22ASWT::instrument_data_temp &inst, bool useLoadArena = false) = 0;
+
+#pragma region async_load
+        /**
+         * starts a non blocking load of a instrument (the same result as Load_instrument)
+         * that is then done in small parts by calling Step from loop(), so that MIDI and the UI stays responsive
+         * a load that is allready in progress is cancelled, so a newer program change pre-empts a older one
+         * the samples of the previous loaded instrument are not freed by the load, when it's done they are moved aside
+         * and freed by FreeReplacedSampleData (or at the latest when the next async load is done),
+         * so the voices can still play the previous instrument until the caller switches them
+         * callback is called by Step when the load is done or failed
+         * the samples are processed the same as by ReadSampleDataFromFile (24 bit, resampling, stereo downmix and forceUseInternalRam)
+         * note. the other load functions of the reader must not be used while loading
+         */
+        bool BeginLoad(int instrumentIndex, AsyncLoadCallback callback = nullptr, bool forceUseInternalRam = false);
+        /**
+         * continues the load for about budget_us microseconds (at least one read is done)
+         * the zones of the instrument are loaded in the first step, then the sample data is read
+         * in parts of at most SF22ASWT_ASYNC_LOAD_CHUNK_SIZE bytes
+         */
+        AsyncLoadState Step(uint32_t budget_us);
+        /** stops the load and frees the partly loaded samples, the callback is not called */
+        void CancelLoad();
+        AsyncLoadState getLoadState();
+        /** 0 to 100 percent of the sample data */
+        int getLoadProgress();
+        int getLoadInstrumentIndex();
+        /** the loaded instrument when the state is Done (also given to the callback), it's owned by the caller the same as with Load_instrument */
+        AudioSynthWavetable::instrument_data* getLoadedInstrument();
+#pragma endregion
+
+        /** the temporary data of the last instrument load, use getHighWaterMark to size SF22ASWT_LOAD_ARENA_SIZE */
+        Arena& getLoadArena();
+        /** true when BuildZoneIndex was called after the last ReadFile */
+        bool hasZoneIndex();
+        ZoneIndex& getZoneIndex();
+        /** the bank/program table built by ReadFile (see sf22aswt_preset_index.h) */
+        PresetIndex& getPresetIndex();
+        /** returns the phdr index of the preset with the bank and program (bank 128 is percussion), or -1 when not found, no file access is used */
+        int findPreset(uint16_t bank, uint16_t program);
+
+#pragma region name_lookup
+        /**
+         * reads the names of all instruments and presets once into the name indexes (see sf22aswt_name_index.h)
+         * this is done by the first Find function below, so it's only needed to control when the time is spent
+         * the indexes are freed by ReadFile
+         */
+        virtual bool BuildNameIndex() = 0;
+        /** returns the index of the first instrument with the name (case insensitive), or -1 when not found */
+        int FindInstrument(const char *name);
+        /** returns the phdr index of the first preset with the name (case insensitive), or -1 when not found */
+        int FindPreset(const char *name);
+        /**
+         * finds the instruments which name starts with prefix (case insensitive), at most maxCount indexes are written to indexes in name order
+         * returns the total number of matches
+         */
+        uint32_t FindInstrumentsByPrefix(const char *prefix, uint16_t *indexes, uint32_t maxCount);
+        /** the same as FindInstrumentsByPrefix but for the presets (phdr indexes) */
+        uint32_t FindPresetsByPrefix(const char *prefix, uint16_t *indexes, uint32_t maxCount);
+        NameIndex& getInstrumentNameIndex();
+        NameIndex& getPresetNameIndex();
+#pragma endregion
 
       protected:
         ReaderBase() {}
-        ~ReaderBase() {}
+        ~ReaderBase() { CancelLoad(); FreeReplacedSampleData(); Close(); }
 
         void clearErrors();
 #ifdef SF22ASWT_DEBUG
@@ -83,15 +252,176 @@ namespace SF22ASWT
         
         bool lastReadWasOK = false;
 
-        // TODO make all samples load into a single array for easier allocation / deallocation
-        // also maybe have it as a own contained memory pool
-        sample_data *samples;
-        bool samples_useExtMem = false;
-        int sample_count = 0;
+        bool keepFileOpen = false;
+        /** from the FilePool, only used when keepFileOpen is set */
+        File *sharedFile = nullptr;
+        /** returns the kept open file when keepFileOpen is set, otherwise tempFile is opened and returned */
+        File& openFile(File &tempFile);
+        /** closes the file if it is not a pooled handle (the kept open file or the file of a async load or streamed instrument) */
+        void releaseFile(File &file);
+
+        bool merge24bit = false;
+        /** kept between loads so that the dither noise don't restart for every sample */
+        Sm24::Dither dither;
+        /** implemented by the readers, the positions of the sample data */
+        virtual sdta_rec_lazy& get_sdta() = 0;
+        /** reads count samples (from the sample index first) of the sample at sample_start with the sm24 data merged into data, returns false on errors (the file is then released, see releaseFile) */
+        bool readSampleData24(File &file, uint32_t sample_start, int first, int16_t *data, int count);
+        /** reads count samples (from the sample index first) of the sample at sample_start, returns false on errors (the file is then released, see releaseFile) */
+        bool readSampleChannel(File &file, uint32_t sample_start, int first, int16_t *data, int count, bool merge24);
+        /** the same as readSampleChannel but also mixes in the other channel of a stereo pair */
+        bool readSamplePart(File &file, const sample_header_temp &sample, int first, int16_t *data, int count, bool merge24);
+
+        bool stereoDownmix = false;
+        /** replaces the zones of stereo pairs with a single zone that has link_start set to the other channel */
+        void pairStereoZones(instrument_data_temp &inst);
+
+        float resampleRate = 0;
+        size_t decimateBudget = 0;
+        /** returns false if sample is not resampled, else resampled is the adjusted header and step is the input samples per output sample (32.32) */
+        bool getResampled(const sample_header_temp &sample, bool decimate, sample_header_temp &resampled, uint64_t &step);
+        /** the ram needed for the samples of inst after the resampling */
+        int getResampledDataSize(const instrument_data_temp &inst, bool decimate);
+        /** reads and resamples the output samples [first, first+count) of sample into the same positions of data, returns false on errors (the file is then released, see releaseFile) */
+        bool readSampleDataResampled(File &file, const sample_header_temp &sample, int16_t *data, int first, int count, uint64_t step, bool merge24);
+        /** the SampleCache file id of the processed data of sample (the options that changes the data are hashed into fileId) */
+        uint32_t getSampleCacheId(uint32_t fileId, const sample_header_temp &sample, uint64_t step, bool merge24);
+
+        /** prints "<step> error:" and the error info to errPrintStream, allways returns false */
+        bool printLoadError(Print &errPrintStream, const char *step);
+        /** the common part of Load_instrument and Load_preset (both readers), reads the sample data of inst and converts it to aswt_id */
+        bool loadAswtInstrument(instrument_data_temp &inst, AudioSynthWavetable::instrument_data*& aswt_id, Print &errPrintStream);
+
+        /** reset at the start of every instrument load */
+        Arena loadArena;
+        /** allocates inst.sample_note_ranges and inst.samples for inst.sample_count samples, returns false if out of memory */
+        bool allocInstrumentArrays(instrument_data_temp &inst, bool useLoadArena);
+
+        /** built by BuildZoneIndex */
+        ZoneIndex zoneIndex;
+        PresetIndex presetIndex;
+        NameIndex instrumentNames;
+        NameIndex presetNames;
+        /** Load_instrument_data when the zone index is built, only copies the zones of the instrument */
+        bool Load_instrument_data_from_zone_index(uint index, instrument_data_temp &inst, bool useLoadArena);
+
+        /** the sample data of the last ReadSampleDataFromFile, all samples are in a single block */
+        SamplePool samplePool;
+        /** the samplePool that was replaced by the last async load, still played until FreeReplacedSampleData */
+        SamplePool replacedPool;
         int totalSampleDataSizeBytes = 0;
 
-        bool ReadStringUsingLeadingSize(File &file, String& string);
+        struct AsyncLoad
+        {
+            AsyncLoadState state = AsyncLoadState::Idle;
+            int instrumentIndex = 0;
+            AsyncLoadCallback callback = nullptr;
+            bool forceUseInternalRam = false;
+            /** the options of ReadSampleDataFromFile, decided when the zones are loaded */
+            bool decimate = false;
+            bool merge24 = false;
+            /** owns its arrays, the zones keeps the file header until the sample is read */
+            instrument_data_temp inst = {0,0,nullptr};
+            /** -1 = the zones are not loaded yet */
+            int sampleIndex = -1;
+            /** samples of the current zone that are read (after the resampling) */
+            uint32_t sampleOffset = 0;
+            uint32_t bytesRead = 0;
+            uint32_t bytesTotal = 0;
+            /** replaces samplePool when the load is done */
+            SamplePool pool;
+            /** a pooled file, or tempFile when the FilePool is full */
+            File *file = nullptr;
+            File tempFile;
+            AudioSynthWavetable::instrument_data *result = nullptr;
+        };
+        AsyncLoad asyncLoad;
+        /** the first Step, loads the zones and allocates the sample data */
+        bool asyncLoadBegin();
+        /** reads the next part of the sample data, returns false on errors */
+        bool asyncLoadRead();
+        void asyncLoadFinish(bool ok);
+
+        /** reads a INFO string of size bytes, subLocation is used for the error code */
+        bool ReadString(File &file, uint32_t size, uint16_t subLocation, String& string);
         bool verifyFourCC(const char* fourCC);
+        bool verifyFourCC(uint32_t fourCC) { return verifyFourCC((const char*)&fourCC); }
+
+#pragma region riff_walkers
+        /** skips size bytes of a unknown chunk, root is used for the error code */
+        bool skipChunk(File &file, Error::RootLocation root, uint32_t size);
+        /**
+         * reads and verifies the RIFF sfbk header and then walks all LIST blocks of the file
+         * handler(listType, listSize) is called with the file positioned after the list type
+         * and must read or skip the list data (skipChunk(file, Error::RootLocation::LIST, listSize - 4))
+         * it returns false on errors (lastError is then set and the file is closed)
+        */
+        template<class Handler>
+        bool walkLists(File &file, uint32_t &riffSize, Handler handler)
+        {
+            uint32_t fourCC = 0;
+            if ((lastReadCount = file.read(&fourCC, 4)) != 4) FILE_ERROR(FILE_FOURCC_READ) //("read error - while reading fileTag")
+            if (verifyFourCC(fourCC) == false) FILE_ERROR(FILE_FOURCC_INVALID) //("error - invalid fileTag")
+            if (fourCC != FourCC::RIFF) FILE_ERROR(FILE_FOURCC_MISMATCH) //("error - not a RIFF fileformat")
+
+            if ((lastReadCount = file.read(&riffSize, 4)) != 4) FILE_ERROR(RIFF_SIZE_READ) //("read error - while reading RIFF size")
+            if (fileSize != (riffSize + 8)) FILE_ERROR(RIFF_SIZE_MISMATCH) //("error - fileSize mismatch")
+
+            if ((lastReadCount = file.read(&fourCC, 4)) != 4) FILE_ERROR(RIFF_FOURCC_READ) //("read error - while reading fileformat")
+            if (verifyFourCC(fourCC) == false) FILE_ERROR(RIFF_FOURCC_INVALID) //("error - invalid fileformat")
+            if (fourCC != FourCC::sfbk) FILE_ERROR(RIFF_FOURCC_MISMATCH) //("error - not a sfbk fileformat")
+
+            uint32_t listSize = 0;
+            while (file.available() > 0)
+            {
+                // every block starts with a LIST tag
+                if ((lastReadCount = file.read(&fourCC, 4)) != 4) FILE_ERROR(LIST_FOURCC_READ) //("read error - while reading listTag")
+                if (verifyFourCC(fourCC) == false) FILE_ERROR(LIST_FOURCC_INVALID) //("error - listTag invalid")
+                if (fourCC != FourCC::LIST) FILE_ERROR(LIST_FOURCC_MISMATCH) //("error - listTag is not LIST")
+
+                if ((lastReadCount = file.read(&listSize, 4)) != 4) FILE_ERROR(LIST_SIZE_READ) //("read error - while getting listSize")
+
+                if ((lastReadCount = file.read(&fourCC, 4)) != 4) FILE_ERROR(LISTTYPE_FOURCC_READ) //("read error - while reading listType")
+                DebugPrintFOURCC((const char*)&fourCC);
+                DebugPrintFOURCC_size(listSize);
+                if (verifyFourCC(fourCC) == false) FILE_ERROR(LISTTYPE_FOURCC_INVALID) //("error - invalid listType")
+
+                if (handler(fourCC, listSize) == false) return false;
+            }
+            return true;
+        }
+        /**
+         * walks the sub chunks of a LIST block until the next LIST block (the file is then positioned at it) or the end of the file
+         * subLocation(fourCC) gives the error sub location of the known sub chunks (0 = unknown chunk)
+         * handler(fourCC, size) is called with the file positioned at the chunk data
+         * and must read or skip (skipChunk) the data, it returns false on errors (lastError is then set and the file is closed)
+        */
+        template<class SubLocation, class Handler>
+        bool walkChunks(File &file, Error::RootLocation root, SubLocation subLocation, Handler handler)
+        {
+            uint32_t fourCC = 0;
+            uint32_t size = 0;
+            while (file.available() > 0)
+            {
+                if ((lastReadCount = file.read(&fourCC, 4)) != 4) FILE_ERROR_CODE(Error::Code(root, 0, Error::Type::FOURCC, Error::Operation::READ))
+                DebugPrintFOURCC((const char*)&fourCC);
+                if (verifyFourCC(fourCC) == false) FILE_ERROR_CODE(Error::Code(root, 0, Error::Type::FOURCC, Error::Operation::INVALID))
+
+                if (fourCC == FourCC::LIST) // the end of this block, or a failsafe if file don't follow standard
+                {
+                    // skip back
+                    if (file.seek(file.position() - 4) == false) FILE_SEEK_ERROR_CODE(Error::Code(root, 0, Error::Type::BACK, Error::Operation::SEEK), -4)
+                    return true;
+                }
+                uint16_t sub = subLocation(fourCC);
+                if ((lastReadCount = file.read(&size, 4)) != 4)
+                    FILE_ERROR_CODE(Error::Code(root, sub, (sub != 0)?Error::Type::SIZE:Error::Type::UNKNOWN_BLOCK_SIZE, Error::Operation::READ))
+
+                if (handler(fourCC, size) == false) return false;
+            }
+            return true;
+        }
+#pragma endregion
 
         bool readInfoBlock(File &file, INFO &info);
         /// <summary>
@@ -102,23 +432,72 @@ namespace SF22ASWT
         /// <returns></returns>
         bool read_sdta_block(File &file, sdta_rec_lazy &sdta);
 
+#pragma region preset_load
+        /** the number of zones (excluding the global zone) of bag_count bags that ends with terminal */
+        int get_zone_count(bag_of_gens* bags, int bag_count, SFGenerator terminal);
+        /**
+         * adds the zones of a instrument (ibags) that are used by presetZone to inst (the arrays have room for capacity zones)
+         * getShdr(zone, shdr) returns the sample header of a instrument zone, or false if it has none (or on file errors)
+         * returns false on file errors or when there are more zones than capacity (then lastError is set)
+        */
+        template<class GetShdr>
+        bool addPresetZones(instrument_data_temp &inst, int capacity, const zone_gens &presetZone, bag_of_gens* ibags, int ibag_count, GetShdr getShdr)
+        {
+            int zone_count = get_zone_count(ibags, ibag_count, SFGenerator::sampleID);
+            zone_gens zone;
+            shdr_rec shdr;
+            for (int si=0;si<zone_count;si++)
+            {
+                get_zone_gens(ibags, si, zone);
+                if (zone.ApplyPreset(presetZone) == false) continue; // not in the key/velocity range of the preset zone
+                // capacity is only smaller than the used zones when it's limited to what sample_count can hold
+                if (inst.sample_count >= capacity) { lastError = SF22ASWT::Errors::FUNCTION_LOAD_PRESET_DATA_RANGE; lastReadCount = capacity; return false; }
+                if (getShdr(zone, shdr) == false) {
+                    if (lastError != SF22ASWT::Errors::NONE) return false;
+                    break; // classify the instrument as structually unsound, the same as Load_instrument_data
+                }
+                inst.sample_note_ranges[inst.sample_count] = get_key_range_end(zone);
+                get_sample_header_values(zone, shdr, get_sdta().smpl.position, inst.samples[inst.sample_count]);
+                inst.sample_count++;
+            }
+            return true;
+        }
+        /**
+         * AudioSynthWavetable plays the first zone which range end is >= the note,
+         * so the zones of the instruments used by a preset are sorted by the range end (stable)
+         */
+        void sortZonesByKeyRange(instrument_data_temp &inst);
+#pragma endregion
+
         void FreePrevSampleData();
+        /** the size in bytes a sample of length (in samples) takes in ram inclusive padding */
+        int get_sample_data_size_bytes(int length);
 
 #pragma region gen_get_functions
-        bool get_parameter_value(bag_of_gens* bags, int sampleIndex, SFGenerator genType, SF2GeneratorAmount *amount);
-        float get_decibel_value(bag_of_gens* bags, int sampleIndex, SFGenerator genType, float DEFAULT, float MIN, float MAX);
-        float get_timecents_value(bag_of_gens* bags, int sampleIndex, SFGenerator genType, float DEFAULT, float MIN);
-        float get_hertz(bag_of_gens* bags, int sampleIndex, SFGenerator genType, float DEFAULT, float MIN, float MAX);
-        int get_pitch_cents(bag_of_gens* bags, int sampleIndex, SFGenerator genType, int DEFAULT, int MIN, int MAX);
-        int get_cooked_loop_start(bag_of_gens* bags, int sampleIndex, shdr_rec &shdr);
-        int get_cooked_loop_end(bag_of_gens* bags, int sampleIndex, shdr_rec &shdr);
-        int get_sample_note(bag_of_gens* bags, int sampleIndex, shdr_rec &shdr);
-        int get_fine_tuning(bag_of_gens* bags, int sampleIndex);
-        bool get_sample_header(File &file, sfbk_rec_lazy &sfbk, bag_of_gens* bags, int sampleIndex, shdr_rec *shdr);
-        bool get_sample_repeat(bag_of_gens* bags, int sampleIndex, bool defaultValue);
-        int get_length(bag_of_gens* bags, int sampleIndex, shdr_rec &shdr);
-        int get_key_range_end(bag_of_gens* bags, int sampleIndex);
+        /**
+         * resolves all generators of a zone in a single pass (the global zone first and then the zone itself)
+         * terminal is the generator that ends every non global zone (instrument for preset zones)
+         */
+        void get_zone_gens(bag_of_gens* bags, int sampleIndex, zone_gens &zone, SFGenerator terminal = SFGenerator::sampleID);
+        /**
+         * the value in dB, ms, Hz or cents clamped to the range of the generator in GenDescriptors,
+         * DEFAULT (the value used by AudioSynthWavetable) when the generator is not set
+         */
+        float get_decibel_value(const zone_gens &zone, SFGenerator genType, float DEFAULT);
+        float get_timecents_value(const zone_gens &zone, SFGenerator genType, float DEFAULT);
+        float get_hertz(const zone_gens &zone, SFGenerator genType, float DEFAULT);
+        int get_pitch_cents(const zone_gens &zone, SFGenerator genType, int DEFAULT);
+        int get_cooked_loop_start(const zone_gens &zone, shdr_rec &shdr);
+        int get_cooked_loop_end(const zone_gens &zone, shdr_rec &shdr);
+        int get_sample_note(const zone_gens &zone, shdr_rec &shdr);
+        int get_fine_tuning(const zone_gens &zone);
+        bool get_sample_repeat(const zone_gens &zone, bool defaultValue);
+        int get_length(const zone_gens &zone, shdr_rec &shdr);
+        int get_key_range_start(const zone_gens &zone);
+        int get_key_range_end(const zone_gens &zone);
         int get_length_bits(int len);
+        /** fills all values of a sample header, shdr must be the sample header used by the zone */
+        void get_sample_header_values(const zone_gens &zone, shdr_rec &shdr, uint32_t smpl_position, sample_header_temp &sample);
 #pragma endregion
         void DebugPrintBagContents(bag_of_gens &gen);
     };
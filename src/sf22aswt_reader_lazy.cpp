@@ -7,176 +7,431 @@
 
 namespace SF22ASWT
 {
+    ReaderLazy::~ReaderLazy()
+    {
+        FreeInstrumentIndex();
+    }
+
     bool ReaderLazy::CloneInto(ReaderLazy &other)
     {
         if (lastReadWasOK == false) return false;
+        other.Close(); // the other reader could have a different file open
         other.lastReadWasOK = true;
         other.fileSize = fileSize;
         other.filePath = filePath;
+        other.keepFileOpen = keepFileOpen; // the handle is shared using the FilePool
         sfbk.CloneInto(other.sfbk);
+        other.shdrCache.Reset(sfbk.pdta.shdr_position, sfbk.pdta.shdr_count);
+        other.zoneIndex.Free(); // only built on demand
+        other.instrumentNames.Free();
+        other.presetNames.Free();
+        other.FreeInstrumentIndex();
+        if (presetIndex.CloneInto(other.presetIndex) == false) { other.lastReadWasOK = false; return false; }
+        if (instIndex != nullptr)
+        {
+            other.instIndex = new inst_index_rec[instIndex_count];
+            memcpy(other.instIndex, instIndex, instIndex_count*sizeof(inst_index_rec));
+            other.instIndex_count = instIndex_count;
+        }
         return true;
     }
-    bool ReaderLazy::ReadFile(const char * filePath)
+    bool ReaderLazy::ReadFile(const char * filePath, bool useIndexFile)
     {
         lastReadWasOK = false;
         clearErrors();
+        CancelLoad();
+        Close();
+        FreeInstrumentIndex();
+        shdrCache.Free();
+        zoneIndex.Free();
+        presetIndex.Free();
+        instrumentNames.Free();
+        presetNames.Free();
+        sfbk = sfbk_rec_lazy(); // value initialized, so nothing (like sm24) is left from the previous file
+
+        if (useIndexFile && ReadIndexFile(filePath))
+        {
+            shdrCache.Reset(sfbk.pdta.shdr_position, sfbk.pdta.shdr_count);
+            lastReadWasOK = true;
+            this->filePath = filePath;
+            return true;
+        }
+        clearErrors();
 
-        File file = SD.open(filePath);
+        File file = Storage::Open(filePath);
         if (!file) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; } // extra failsafe
 
         fileSize = file.size();
 
-        char fourCC[4];
-
-        if ((lastReadCount = file.readBytes(fourCC, 4)) != 4) FILE_ERROR(FILE_FOURCC_READ) //("read error - while reading fileTag")
-        if (verifyFourCC(fourCC) == false) FILE_ERROR(FILE_FOURCC_INVALID) //("error - invalid fileTag")
-        if (strncmp(fourCC, "RIFF", 4) != 0) FILE_ERROR(FILE_FOURCC_MISMATCH) //("error - not a RIFF fileformat")
-        
-        if ((lastReadCount = file.read(&sfbk.size, 4)) != 4) FILE_ERROR(RIFF_SIZE_READ) //("read error - while reading RIFF size")
-        if (fileSize != (sfbk.size + 8)) FILE_ERROR(RIFF_SIZE_MISMATCH) //("error - fileSize mismatch")
-
-        if ((lastReadCount = file.readBytes(fourCC, 4)) != 4) FILE_ERROR(RIFF_FOURCC_READ) //("read error - while reading fileformat")
-        if (verifyFourCC(fourCC) == false) FILE_ERROR(RIFF_FOURCC_INVALID) //("error - invalid fileformat")
-        
-        if (strncmp(fourCC, "sfbk", 4) != 0) FILE_ERROR(RIFF_FOURCC_MISMATCH) //("error - not a sfbk fileformat")
-
-        uint32_t chunkSize = 0;
-        while (file.available() > 0)
-        {
-            // every block starts with a LIST tag
-            if ((lastReadCount = file.readBytes(fourCC, 4)) != 4) FILE_ERROR(LIST_FOURCC_READ) //("read error - while reading listTag")
-            if (verifyFourCC(fourCC) == false) FILE_ERROR(LIST_FOURCC_INVALID) //("error - listTag invalid")
-            if (strncmp(fourCC, "LIST", 4) != 0) FILE_ERROR(LIST_FOURCC_MISMATCH) //("error - listTag is not LIST")
-
-            
-            if ((lastReadCount = file.read(&chunkSize, 4)) != 4) FILE_ERROR(LIST_SIZE_READ) //("read error - while getting listSize")
-
-            if ((lastReadCount = file.readBytes(fourCC, 4)) != 4) FILE_ERROR(LISTTYPE_FOURCC_READ) //("read error - while reading listType")
-            DebugPrintFOURCC(fourCC);
-            DebugPrintFOURCC_size(chunkSize);
-            if (verifyFourCC(fourCC) == false) FILE_ERROR(LISTTYPE_FOURCC_INVALID) //("error - invalid listType")
-            
-            
-            if (strncmp(fourCC, "INFO", 4) == 0)
-            {
-                sfbk.info_position = file.position(); // normally don't read info chunk to save ram
-                sfbk.info_size = chunkSize;
-                if (file.seek(chunkSize - 4, SeekCur) == false) FILE_SEEK_ERROR(INFO_DATA_SKIP, chunkSize - 4) //("seek error - while skipping INFO block")
-                
-                //file.close(); return true; // early return debug test
-            }
-            else if (strncmp(fourCC, "sdta", 4) == 0)
-            {
-                sfbk.sdta.size = chunkSize;
-                if (read_sdta_block(file, sfbk.sdta) == false) return false;
-                //file.close(); return true; // early return debug test
-            }
-            else if (strncmp(fourCC, "pdta", 4) == 0)
-            {
-                sfbk.pdta.size = chunkSize;
-                if (read_pdta_block(file, sfbk.pdta) == false) return false;
-                //file.close(); return true; // early return debug test
-            }
-            else
+        bool readOK = walkLists(file, sfbk.size, [&](uint32_t listType, uint32_t listSize) {
+            switch (listType)
             {
-                // normally unknown blocks should be ignored
-                if (file.seek(chunkSize - 4, SeekCur) == false) FILE_SEEK_ERROR(LIST_UNKNOWN_BLOCK_DATA_SKIP, chunkSize - 4) //("seek error - while skipping unknown sfbk root block")
+                case FourCC::INFO:
+                    sfbk.info_position = file.position(); // normally don't read info chunk to save ram
+                    sfbk.info_size = listSize;
+                    if (file.seek(listSize - 4, SeekCur) == false) FILE_SEEK_ERROR(INFO_DATA_SKIP, listSize - 4) //("seek error - while skipping INFO block")
+                    return true;
+                case FourCC::sdta:
+                    sfbk.sdta.size = listSize;
+                    return read_sdta_block(file, sfbk.sdta);
+                case FourCC::pdta:
+                    sfbk.pdta.size = listSize;
+                    return read_pdta_block(file, sfbk.pdta);
+                default:
+                    return skipChunk(file, Error::RootLocation::LIST, listSize - 4);
             }
-        }
+        });
+        if (readOK == false) return false;
+        if (BuildPresetIndex(file) == false) return false;
 
         file.close();
+        shdrCache.Reset(sfbk.pdta.shdr_position, sfbk.pdta.shdr_count);
         lastReadWasOK = true;
         this->filePath = filePath;
+        // the index file is only a cache, so a failure here don't affect the result of ReadFile
+        if (useIndexFile) WriteIndexFile();
         return true;
     }
 
-    bool ReaderLazy::PrintInstrumentListAsJson(Print &printStream)
+    bool ReaderLazy::hasInstrumentIndex() { return instIndex != nullptr; }
+
+    const inst_index_rec* ReaderLazy::getInstrumentIndexEntry(uint index)
     {
-        clearErrors();
-        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
-        File file = SD.open(filePath.c_str());
-        if (!file) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; } // extra failsafe
+        if (index >= instIndex_count) return nullptr;
+        return &instIndex[index];
+    }
 
-        if (file.seek(sfbk.pdta.inst_position) == false) FILE_ERROR(PDTA_INST_DATA_SEEK)
+    void ReaderLazy::FreeInstrumentIndex()
+    {
+        delete[] instIndex;
+        instIndex = nullptr;
+        instIndex_count = 0;
+    }
 
-        SF22ASWT::inst_rec inst;
-        printStream.print("json:{\"instruments\":[");
-        for (uint32_t i = 0; i < sfbk.pdta.inst_count - 1; i++) // -1 the last is allways a EOI
+    bool ReaderLazy::getIndexFileValidation(File &file, const pdta_rec_lazy &pdta, uint32_t &modifyTime, uint32_t &hash)
+    {
+        modifyTime = Storage::ModifyTime(file);
+
+        uint8_t block[index_file_header::HashBlockSize];
+        if (file.seek(0) == false) FILE_SEEK_ERROR(FILE_FOURCC_READ, 0)
+        if ((lastReadCount = file.read(block, 12)) != 12) FILE_ERROR(FILE_FOURCC_READ)
+        hash = Helpers::fnv1a32(block, 12);
+
+        uint32_t hashSize = pdta.inst_count*inst_rec::Size;
+        if (hashSize > index_file_header::HashBlockSize) hashSize = index_file_header::HashBlockSize;
+        if (file.seek(pdta.inst_position) == false) FILE_SEEK_ERROR(PDTA_INST_DATA_SEEK, pdta.inst_position)
+        if ((lastReadCount = file.read(block, hashSize)) != hashSize) FILE_ERROR(PDTA_INST_DATA_READ)
+        hash = Helpers::fnv1a32(block, hashSize, hash);
+        return true;
+    }
+
+    bool ReaderLazy::ReadIndexFile(const char * filePath)
+    {
+        String indexFilePath = String(filePath) + SF22ASWT_INDEX_FILE_EXTENSION;
+        File indexFile = Storage::Open(indexFilePath.c_str());
+        if (!indexFile) return false;
+
+        uint32_t indexFileSize = indexFile.size();
+        if (indexFileSize < sizeof(index_file_header) + sizeof(sfbk_rec_lazy)) { indexFile.close(); return false; }
+        // the whole index is loaded using a single read
+        uint8_t *data = new uint8_t[indexFileSize];
+        bool readOK = ((uint32_t)indexFile.read(data, indexFileSize) == indexFileSize);
+        indexFile.close();
+
+        index_file_header header;
+        memcpy(&header, data, sizeof(index_file_header));
+        if (readOK == false ||
+            header.magic != index_file_header::Magic ||
+            header.version != index_file_header::Version ||
+            header.sfbk_rec_size != sizeof(sfbk_rec_lazy) ||
+            header.inst_index_rec_size != sizeof(inst_index_rec) ||
+            header.preset_index_rec_size != sizeof(preset_index_rec) ||
+            indexFileSize != sizeof(index_file_header) + sizeof(sfbk_rec_lazy) + header.inst_count*sizeof(inst_index_rec) + (header.preset_count + 1)*sizeof(preset_index_rec))
         {
-            file.read(&inst, SF22ASWT::inst_rec::Size);
-            printStream.print("{\"name\":\"");
-            Helpers::printRawBytesUntil(printStream, inst.achInstName, 20, '\0');
-            printStream.print("\",\"ndx\":");
-            printStream.print(inst.wInstBagNdx);
-            printStream.print("},");
+            delete[] data;
+            return false;
+        }
+        // decoded into a local record, sfbk is only replaced when the index is valid for the file
+        sfbk_rec_lazy indexSfbk;
+        memcpy(&indexSfbk, data + sizeof(index_file_header), sizeof(sfbk_rec_lazy));
+
+        File file = Storage::Open(filePath);
+        if (!file) { delete[] data; lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+        fileSize = file.size();
+
+        uint32_t modifyTime = 0;
+        uint32_t hash = 0;
+        if (getIndexFileValidation(file, indexSfbk.pdta, modifyTime, hash) == false) { delete[] data; return false; } // getIndexFileValidation have allready closed the file
+        file.close();
+
+        if (header.fileSize != fileSize ||
+            header.modifyTime != modifyTime ||
+            header.hash != hash ||
+            header.inst_count != ((indexSfbk.pdta.inst_count != 0) ? (indexSfbk.pdta.inst_count - 1) : 0) ||
+            header.preset_count != ((indexSfbk.pdta.phdr_count != 0) ? (indexSfbk.pdta.phdr_count - 1) : 0))
+        {
+            DebugPrintln("index file is outdated");
+            delete[] data;
+            return false;
+        }
+        sfbk = indexSfbk;
+
+        instIndex = new inst_index_rec[header.inst_count];
+        memcpy(instIndex, data + sizeof(index_file_header) + sizeof(sfbk_rec_lazy), header.inst_count*sizeof(inst_index_rec));
+        instIndex_count = header.inst_count;
+
+        // the preset index is read from the index file, so the phdr chunk is not read at all
+        if (presetIndex.Alloc(header.preset_count) == false) { delete[] data; FreeInstrumentIndex(); return false; }
+        memcpy(presetIndex.records, data + sizeof(index_file_header) + sizeof(sfbk_rec_lazy) + header.inst_count*sizeof(inst_index_rec), (header.preset_count + 1)*sizeof(preset_index_rec));
+        delete[] data;
+        if (presetIndex.Finish() == false) { FreeInstrumentIndex(); presetIndex.Free(); return false; }
+        return true;
+    }
+
+    bool ReaderLazy::WriteIndexFile()
+    {
+        File file = Storage::Open(filePath.c_str());
+        if (!file) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+
+        index_file_header header;
+        header.fileSize = fileSize;
+        if (getIndexFileValidation(file, sfbk.pdta, header.modifyTime, header.hash) == false) return false; // getIndexFileValidation have allready closed the file
+
+        header.inst_count = (sfbk.pdta.inst_count != 0) ? (sfbk.pdta.inst_count - 1) : 0; // the last is allways a EOI
+        header.preset_count = presetIndex.getPresetCount();
+        instIndex = new inst_index_rec[header.inst_count];
+        instIndex_count = header.inst_count;
+        for (uint32_t i = 0; i < header.inst_count; i++)
+        {
+            if (buildInstrumentIndexEntry(file, i, instIndex[i]) == false) {
+                // buildInstrumentIndexEntry have allready closed the file
+                DebugPrintln_Text_Var("could not build index entry for instrument: ", i);
+                FreeInstrumentIndex();
+                return false;
+            }
         }
         file.close();
-        printStream.println("]}");
+
+        String indexFilePath = filePath + SF22ASWT_INDEX_FILE_EXTENSION;
+        File indexFile = Storage::OpenWrite(indexFilePath.c_str());
+        if (!indexFile) return false; // the index in ram is still valid
+
+        size_t instIndexSize = header.inst_count*sizeof(inst_index_rec);
+        size_t presetIndexSize = (header.preset_count + 1)*sizeof(preset_index_rec);
+        bool writeOK = (indexFile.write((const uint8_t*)&header, sizeof(index_file_header)) == sizeof(index_file_header)) &&
+                       (indexFile.write((const uint8_t*)&sfbk, sizeof(sfbk_rec_lazy)) == sizeof(sfbk_rec_lazy)) &&
+                       (indexFile.write((const uint8_t*)instIndex, instIndexSize) == instIndexSize) &&
+                       (indexFile.write((const uint8_t*)presetIndex.records, presetIndexSize) == presetIndexSize);
+        indexFile.close();
+        // never leave a broken index file
+        if (writeOK == false) Storage::Remove(indexFilePath.c_str());
+        return writeOK;
+    }
+
+    bool ReaderLazy::buildInstrumentIndexEntry(File &file, uint index, inst_index_rec &entry)
+    {
+        uint16_t ibag_startIndex = 0;
+        uint16_t ibag_endIndex = 0;
+        if (read_ibag_range(file, index, ibag_startIndex, ibag_endIndex) == false) return false;
+        entry.ibag_start = ibag_startIndex;
+        entry.ibag_end = ibag_endIndex;
+        entry.zone_count = 0;
+        entry.sample_data_size = 0;
+
+        uint16_t ibag_count = ibag_endIndex - ibag_startIndex;
+        if (ibag_count == 0) return true;
+
+        loadArena.Reset();
+        bag_of_gens *bags = nullptr;
+        if (fillBagsOfGens(file, bags, ibag_startIndex, ibag_count) == false) return false;
+
+        bool globalExists = (bags[0].count != 0)?(bags[0].lastItem().sfGenOper != SFGenerator::sampleID):true;
+        entry.zone_count = globalExists?(ibag_count - 1):ibag_count;
+        entry.key_low = 127;
+        entry.key_high = 0;
+        zone_gens zone;
+        for (int si=0;si<entry.zone_count;si++)
+        {
+            get_zone_gens(bags, si, zone);
+            shdr_rec shdr;
+            if (get_sample_header(file, zone, &shdr) == false) {
+                if (lastError != SF22ASWT::Errors::NONE) return false; // the file is allready closed
+                break; // same as Load_instrument_data
+            }
+            entry.sample_data_size += get_sample_data_size_bytes(get_length(zone, shdr));
+            int keyLow = get_key_range_start(zone);
+            int keyHigh = get_key_range_end(zone);
+            if (keyLow < entry.key_low) entry.key_low = keyLow;
+            if (keyHigh > entry.key_high) entry.key_high = keyHigh;
+        }
+        if (entry.key_low > entry.key_high) { entry.key_low = 0; entry.key_high = 127; }
         return true;
     }
 
-    bool ReaderLazy::PrintPresetListAsJson(Print &printStream)
+    bool ReaderLazy::get_sample_header(File &file, const zone_gens &zone, shdr_rec *shdr)
+    {
+        if (zone.isSet(SFGenerator::sampleID) == false) return false;
+        uint32_t sampleID = zone.get(SFGenerator::sampleID).UAmount;
+        if (sampleID >= sfbk.pdta.shdr_count) { lastError = SF22ASWT::Errors::PDTA_SHDR_DATA_READ; releaseFile(file); return false; } // the same as Reader
+        if (shdrCache.Get(file, sampleID, *shdr) == false) FILE_ERROR(PDTA_SHDR_DATA_READ)
+        return true;
+    }
+
+    ShdrCache& ReaderLazy::getShdrCache() { return shdrCache; }
+
+    bool ReaderLazy::read_ibag_range(File &file, uint index, uint16_t &ibag_startIndex, uint16_t &ibag_endIndex)
+    {
+        uint32_t seekPos = sfbk.pdta.inst_position + inst_rec::Size*index + 20;
+        if (file.seek(seekPos) == false) FILE_SEEK_ERROR(PDTA_INST_DATA_SEEK, seekPos)
+        if ((lastReadCount = file.read(&ibag_startIndex, 2)) != 2) FILE_ERROR(PDTA_INST_DATA_READ)
+        // skipping next inst name
+        if (file.seek(20, SeekCur) == false) FILE_SEEK_ERROR(PDTA_INST_DATA_SKIP, 20)
+        if ((lastReadCount = file.read(&ibag_endIndex, 2)) != 2) FILE_ERROR(PDTA_INST_DATA_READ)
+        return true;
+    }
+
+    bool ReaderLazy::PrintInstrumentListAsJson(Print &printStream, uint32_t offset, uint32_t limit, const char *filter)
+    {
+        clearErrors();
+        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+        return JsonList::PrintInstruments(*this, printStream, offset, limit, filter);
+    }
+
+    bool ReaderLazy::PrintPresetListAsJson(Print &printStream, uint32_t offset, uint32_t limit, const char *filter)
+    {
+        clearErrors();
+        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+        return JsonList::PrintPresets(*this, printStream, offset, limit, filter);
+    }
+
+    bool ReaderLazy::BuildZoneIndex()
     {
         clearErrors();
         if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
-        File file = SD.open(filePath.c_str());
+        zoneIndex.Free();
+        if (sfbk.pdta.inst_count < 2) { lastError = SF22ASWT::Errors::PDTA_INST_DATA_READ; return false; } // the last is allways a EOI
+        uint32_t instCount = sfbk.pdta.inst_count - 1;
+
+        File tempFile;
+        File &file = openFile(tempFile);
         if (!file) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; } // extra failsafe
 
-        if (file.seek(sfbk.pdta.phdr_position) == false) FILE_ERROR(PDTA_PHDR_DATA_SEEK)
-        
-        SF22ASWT::phdr_rec phdr;
+        // the bags of all instruments are after each other, so the number of bags is the max number of zones
+        uint16_t ibag_startIndex = 0;
+        uint16_t ibag_endIndex = 0;
+        uint16_t ibag_firstIndex = 0;
+        if (read_ibag_range(file, 0, ibag_firstIndex, ibag_endIndex) == false) return false;
+        if (read_ibag_range(file, instCount - 1, ibag_startIndex, ibag_endIndex) == false) return false;
+        if (ibag_endIndex < ibag_firstIndex) FILE_ERROR(PDTA_INST_DATA_READ)
 
-        printStream.print("json:{\"presets\":[");
+        if (zoneIndex.Alloc(instCount, ibag_endIndex - ibag_firstIndex) == false) FILE_MALLOC_ERROR(external_psram_size != 0, (ibag_endIndex - ibag_firstIndex)*sizeof(sample_header_temp))
 
-        for (uint32_t i = 0; i < sfbk.pdta.phdr_count - 1; i++) // -1 the last is allways a EOP
+        zone_gens zone;
+        shdr_rec shdr;
+        sample_header_temp sample;
+        for (uint32_t i=0;i<instCount;i++)
         {
-            file.read(&phdr, SF22ASWT::phdr_rec::Size);
-            printStream.print("{\"name\":\"");
-            Helpers::printRawBytesUntil(printStream, phdr.achPresetName, 20, '\0');
-            printStream.print("\",\"bank\":");
-            printStream.print(phdr.wBank);
-            printStream.print(",\"preset\":");
-            printStream.print(phdr.wPreset);
-            printStream.print(",\"bagNdx\":");
-            printStream.print(phdr.wPresetBagNdx);
-            printStream.print("},");
+            zoneIndex.BeginInstrument(i);
+            if (i < instIndex_count) {
+                ibag_startIndex = instIndex[i].ibag_start;
+                ibag_endIndex = instIndex[i].ibag_end;
+            }
+            else if (read_ibag_range(file, i, ibag_startIndex, ibag_endIndex) == false) { zoneIndex.Free(); return false; }
+            if (ibag_endIndex <= ibag_startIndex) continue;
+            uint16_t ibag_count = ibag_endIndex - ibag_startIndex;
+
+            loadArena.Reset();
+            bag_of_gens *bags = nullptr;
+            if (fillBagsOfGens(file, bags, ibag_startIndex, ibag_count) == false) { zoneIndex.Free(); return false; }
+
+            // same as Load_instrument_data
+            bool globalExists = (bags[0].count != 0)?(bags[0].lastItem().sfGenOper != SFGenerator::sampleID):true;
+            int zone_count = globalExists?(ibag_count - 1):ibag_count;
+            for (int si=0;si<zone_count;si++)
+            {
+                get_zone_gens(bags, si, zone);
+                if (get_sample_header(file, zone, &shdr) == false) {
+                    if (lastError != SF22ASWT::Errors::NONE) { zoneIndex.Free(); return false; } // the file is allready closed
+                    break; // classify the file as structually unsound
+                }
+                get_sample_header_values(zone, shdr, sfbk.sdta.smpl.position, sample);
+                sample.sample = nullptr;
+                if (zoneIndex.Add(i, zone, sample) == false) break; // failsafe, cannot happen as there is at least one bag per zone
+            }
         }
-        file.close();
-        printStream.println("]}");
+        zoneIndex.Finish();
+        loadArena.Reset();
+        releaseFile(file);
         return true;
     }
 
-    bool ReaderLazy::Load_instrument_data(uint index, SF22ASWT::instrument_data_temp &inst)
+    bool ReaderLazy::BuildNameIndex()
     {
         clearErrors();
         if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
-        File file = SD.open(filePath.c_str());
+        uint32_t instCount = (sfbk.pdta.inst_count != 0) ? (sfbk.pdta.inst_count - 1) : 0; // the last is allways a EOI
+        uint32_t presetCount = (sfbk.pdta.phdr_count != 0) ? (sfbk.pdta.phdr_count - 1) : 0; // the last is allways a EOP
+        if (instrumentNames.Alloc(instCount) == false || presetNames.Alloc(presetCount) == false) {
+            instrumentNames.Free();
+            presetNames.Free();
+            lastError = (external_psram_size != 0) ? SF22ASWT::Errors::EXTRAM_DATA_MALLOC : SF22ASWT::Errors::RAM_DATA_MALLOC;
+            return false;
+        }
+        File tempFile;
+        File &file = openFile(tempFile);
+        if (!file) { instrumentNames.Free(); presetNames.Free(); lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; } // extra failsafe
+
+        // both chunks are read a block at a time with the same open file, the names are copied from the buffer
+        SF22ASWT::inst_rec insts[SF22ASWT_ITERATE_BLOCK_RECORDS];
+        bool readOK = readRecords(file, insts, SF22ASWT_ITERATE_BLOCK_RECORDS, sfbk.pdta.inst_position, sfbk.pdta.inst_count, 0, false,
+            SF22ASWT::Errors::PDTA_INST_DATA_SEEK, SF22ASWT::Errors::PDTA_INST_DATA_READ,
+            [&](uint32_t index, const SF22ASWT::inst_rec *record) { instrumentNames.Set(index, record->achInstName); return true; });
+        SF22ASWT::phdr_rec phdrs[SF22ASWT_ITERATE_BLOCK_RECORDS];
+        if (readOK) readOK = readRecords(file, phdrs, SF22ASWT_ITERATE_BLOCK_RECORDS, sfbk.pdta.phdr_position, sfbk.pdta.phdr_count, 0, false,
+            SF22ASWT::Errors::PDTA_PHDR_DATA_SEEK, SF22ASWT::Errors::PDTA_PHDR_DATA_READ,
+            [&](uint32_t index, const SF22ASWT::phdr_rec *record) { presetNames.Set(index, record->achPresetName); return true; });
+        if (readOK == false) { instrumentNames.Free(); presetNames.Free(); return false; } // the file is released by readRecords
+        releaseFile(file);
+        instrumentNames.Finish();
+        presetNames.Finish();
+        return true;
+    }
+
+    bool ReaderLazy::Load_instrument_data(uint index, SF22ASWT::instrument_data_temp &inst, bool useLoadArena)
+    {
+        clearErrors();
+        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+        if (zoneIndex.isBuilt()) return Load_instrument_data_from_zone_index(index, inst, useLoadArena);
+        File tempFile;
+        File &file = openFile(tempFile);
         if (!file) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; } // extra failsafe
 
-        if (index > sfbk.pdta.inst_count - 1){ 
-            //lastError = "load instrument index out of range";
+        if (index + 1 >= sfbk.pdta.inst_count) { // the last is allways a EOI
             lastError = SF22ASWT::Errors::FUNCTION_LOAD_INST_INDEX_RANGE;
+            releaseFile(file);
             return false;
         }
 
-        uint32_t seekPos = sfbk.pdta.inst_position + inst_rec::Size*index + 20;
-        if (file.seek(seekPos) == false) FILE_SEEK_ERROR(PDTA_INST_DATA_SEEK, seekPos)
         uint16_t ibag_startIndex = 0;
         uint16_t ibag_endIndex = 0;
-        if ((lastReadCount = file.read(&ibag_startIndex, 2)) != 2) FILE_ERROR(PDTA_INST_DATA_READ)
-        // skipping next inst name
-        if (file.seek(20, SeekCur) == false) FILE_SEEK_ERROR(PDTA_INST_DATA_SKIP, 20)
-        if ((lastReadCount = file.read(&ibag_endIndex, 2)) != 2) FILE_ERROR(PDTA_INST_DATA_READ)
+        if (index < instIndex_count) {
+            // instrument index avoids the inst chunk lookup
+            ibag_startIndex = instIndex[index].ibag_start;
+            ibag_endIndex = instIndex[index].ibag_end;
+        }
+        else if (read_ibag_range(file, index, ibag_startIndex, ibag_endIndex) == false) return false;
         
         DebugPrint_Text_Var("\nibag_start index: ", ibag_startIndex);
         DebugPrintln_Text_Var(", ibag_end index: ", ibag_endIndex);
         DebugPrint("\n");
         
+        // a instrument without zones is a error, the same as in Reader
+        if (ibag_endIndex <= ibag_startIndex) { lastError = SF22ASWT::Errors::PDTA_INST_DATA_READ; releaseFile(file); return false; }
         uint16_t ibag_count = ibag_endIndex - ibag_startIndex; 
         
         // store gen data in bags for faster access
-        bag_of_gens bags[ibag_count];
-
+        loadArena.Reset();
+        bag_of_gens *bags = nullptr;
         if (fillBagsOfGens(file, bags, ibag_startIndex, ibag_count) == false) {
             return false;
         }
@@ -184,21 +439,26 @@ namespace SF22ASWT
         // if the first zone ends with a sampleID gen type then there is not any global zone for that instrument
         bool globalExists = (bags[0].count != 0)?(bags[0].lastItem().sfGenOper != SFGenerator::sampleID):true;
 
-        inst.sample_count = globalExists?(ibag_count - 1):ibag_count;
+        int zone_count = globalExists?(ibag_count - 1):ibag_count;
+        if (zone_count > UINT8_MAX) { lastError = SF22ASWT::Errors::FUNCTION_LOAD_INST_DATA_RANGE; lastReadCount = zone_count; releaseFile(file); return false; } // sample_count is a uint8_t
+        inst.sample_count = zone_count;
 
-        inst.sample_note_ranges = new uint8_t[inst.sample_count];
-        inst.samples = new sample_header_temp[inst.sample_count];
+        if (allocInstrumentArrays(inst, useLoadArena) == false) FILE_MALLOC_ERROR(false, inst.sample_count*sizeof(sample_header_temp))
 
         DebugPrint("\nsample count: "); DebugPrint(inst.sample_count);
+        zone_gens zone;
         for (int si=0;si<inst.sample_count;si++)
         {
+            // all generators of the zone are resolved once, the get_ functions below are then simple lookups
+            get_zone_gens(bags, si, zone);
             shdr_rec shdr;
             DebugPrintln_Text_Var("getting sample x: ", si);
-            if (get_sample_header(file, sfbk, bags, si, &shdr) == false) { 
-                break; // classify the file as structually unsound
-                //inst.samples[si].invalid = true;
+            if (get_sample_header(file, zone, &shdr) == false) {
+                if (lastError != SF22ASWT::Errors::NONE) return false; // the file is allready closed
+                // a zone without a sample, the instrument is classified as structually unsound and ends here
                 DebugPrintln_Text_Var("error - while getting sample header @ ", si);
-                //continue;
+                inst.sample_count = si;
+                break;
             }
             DebugPrint("sample name: ");
 #ifdef SF22ASWT_DEBUG
@@ -206,73 +466,45 @@ namespace SF22ASWT
 #endif
             DebugPrintln();
             DebugPrintln("getting data:");
-            inst.sample_note_ranges[si] = get_key_range_end(bags, si);
-            inst.samples[si].sample_start = shdr.dwStart*2 + sfbk.sdta.smpl.position;
-            inst.samples[si].LOOP = get_sample_repeat(bags, si, false);
-            inst.samples[si].SAMPLE_NOTE = get_sample_note(bags, si, shdr);
-            inst.samples[si].CENTS_OFFSET = get_fine_tuning(bags, si);
-            inst.samples[si].LENGTH = get_length(bags, si, shdr);
-            inst.samples[si].LENGTH_BITS = get_length_bits(inst.samples[si].LENGTH);
-            inst.samples[si].SAMPLE_RATE = shdr.dwSampleRate;
-            inst.samples[si].LOOP_START = get_cooked_loop_start(bags, si, shdr);
-            inst.samples[si].LOOP_END = get_cooked_loop_end(bags, si, shdr);
-            inst.samples[si].INIT_ATTENUATION = get_decibel_value(bags, si, SFGenerator::initialAttenuation, 0, 0, 144) * -1;
-            DebugPrintln("getting vol env");
-            // VOLUME ENVELOPE VALUES
-            inst.samples[si].DELAY_ENV = get_timecents_value(bags, si, SFGenerator::delayVolEnv, 0, 0);
-            inst.samples[si].ATTACK_ENV = get_timecents_value(bags, si, SFGenerator::attackVolEnv, 1, 1);
-            inst.samples[si].HOLD_ENV = get_timecents_value(bags, si, SFGenerator::holdVolEnv, 0, 0);
-            inst.samples[si].DECAY_ENV = get_timecents_value(bags, si, SFGenerator::decayVolEnv, 1, 1);
-            inst.samples[si].RELEASE_ENV = get_timecents_value(bags, si, SFGenerator::releaseVolEnv, 1, 1);
-            inst.samples[si].SUSTAIN_FRAC = get_decibel_value(bags, si, SFGenerator::sustainVolEnv, 0, 0, 144) * -1;
-            DebugPrintln("getting vib vals");
-            // VIRBRATO VALUES
-            inst.samples[si].VIB_DELAY_ENV = get_timecents_value(bags, si, SFGenerator::delayVibLFO, 0, 0);
-            inst.samples[si].VIB_INC_ENV = get_hertz(bags, si, SFGenerator::freqVibLFO, 8.176, 0.1, 100);
-            inst.samples[si].VIB_PITCH_INIT = get_pitch_cents(bags, si, SFGenerator::vibLfoToPitch, 0, -12000, 12000);
-            inst.samples[si].VIB_PITCH_SCND = inst.samples[si].VIB_PITCH_INIT * -1; //pitch_cents(bags, si, SFGenerator::vibLfoToPitch, 0, -12000, 12000) * -1;
-            DebugPrintln("getting mod vals");
-            // MODULATION VALUES
-            inst.samples[si].MOD_DELAY_ENV = get_timecents_value(bags, si, SFGenerator::delayModLFO, 0, 0);
-            inst.samples[si].MOD_INC_ENV = get_hertz(bags, si, SFGenerator::freqModLFO, 8.176, 0.1, 100);
-            inst.samples[si].MOD_PITCH_INIT = get_pitch_cents(bags, si, SFGenerator::modLfoToPitch, 0, -12000, 12000);
-            inst.samples[si].MOD_PITCH_SCND = inst.samples[si].MOD_PITCH_INIT * -1; //pitch_cents(bags, si, SFGenerator::modLfoToPitch, 0, -12000, 12000) * -1;
-            inst.samples[si].MOD_AMP_INIT_GAIN = get_decibel_value(bags, si, SFGenerator::modLfoToVolume, 0, -96, 96);
-            inst.samples[si].MOD_AMP_SCND_GAIN = inst.samples[si].MOD_AMP_INIT_GAIN * -1; //decibel_value(bags, si, SFGenerator::modLfoToVolume, 0, -96, 96) * -1;
+            inst.sample_note_ranges[si] = get_key_range_end(zone);
+            get_sample_header_values(zone, shdr, sfbk.sdta.smpl.position, inst.samples[si]);
         }
         
-        file.close();
+        releaseFile(file);
         return true;
     }
 
-    bool ReaderLazy::fillBagsOfGens(File &file, bag_of_gens* bags, int ibag_startIndex, int ibag_count)
+    bool ReaderLazy::fillBagsOfGens(File &file, bag_of_gens*& bags, int ibag_startIndex, int ibag_count, bool preset)
     {
-        uint32_t seekPos = sfbk.pdta.ibag_position + bag_rec::Size*ibag_startIndex;
-        if (file.seek(seekPos) == false) FILE_SEEK_ERROR(PDTA_IBAG_DATA_SEEK, seekPos) //seek error to ibags
+        uint32_t seekPos = (preset?sfbk.pdta.pbag_position:sfbk.pdta.ibag_position) + bag_rec::Size*ibag_startIndex;
+        if (file.seek(seekPos) == false) FILE_SEEK_ERROR_CODE(preset?SF22ASWT::Errors::PDTA_PBAG_DATA_SEEK:SF22ASWT::Errors::PDTA_IBAG_DATA_SEEK, seekPos) //seek error to ibags
         DebugPrint("igen_ndxs: ");
-        uint16_t igen_ndxs[ibag_count+1]; // +1 because of the soundfont structure 
+        uint16_t *igen_ndxs = loadArena.New<uint16_t>(ibag_count+1); // +1 because of the soundfont structure 
+        bags = loadArena.New<bag_of_gens>(ibag_count);
+        if (igen_ndxs == nullptr || bags == nullptr) FILE_MALLOC_ERROR(false, ibag_count*sizeof(bag_of_gens))
         uint16_t dummy = 0;
         for (int i=0;i<ibag_count+1;i++)
         {
-            if ((lastReadCount = file.read(&igen_ndxs[i], 2)) != 2) FILE_ERROR(PDTA_IBAG_DATA_READ) //read error - while reading &igen_ndxs[i]
-            if ((lastReadCount = file.read(&dummy, 2)) != 2) FILE_ERROR(PDTA_IBAG_DATA_SKIP) //read error - while reading dummy
+            if ((lastReadCount = file.read(&igen_ndxs[i], 2)) != 2) FILE_ERROR_CODE(preset?SF22ASWT::Errors::PDTA_PBAG_DATA_READ:SF22ASWT::Errors::PDTA_IBAG_DATA_READ) //read error - while reading &igen_ndxs[i]
+            if ((lastReadCount = file.read(&dummy, 2)) != 2) FILE_ERROR_CODE(preset?SF22ASWT::Errors::PDTA_PBAG_DATA_SKIP:SF22ASWT::Errors::PDTA_IBAG_DATA_SKIP) //read error - while reading dummy
             DebugPrint(igen_ndxs[i]);
             DebugPrint(", ");
+            if (i != 0 && igen_ndxs[i] < igen_ndxs[i-1]) FILE_ERROR_CODE(preset?SF22ASWT::Errors::PDTA_PBAG_DATA_READ:SF22ASWT::Errors::PDTA_IBAG_DATA_READ)
         }
         DebugPrint("\n");
-        // search to the location for the first igen record
-        seekPos = sfbk.pdta.igen_position + igen_ndxs[0]*gen_rec::Size;
-        if (file.seek(seekPos) == false) FILE_SEEK_ERROR(PDTA_IGEN_DATA_SEEK, seekPos) //seek error to first igen record
-            
+        // the gens of all bags are stored after each other, so they are read with a single read
+        uint32_t gen_count = igen_ndxs[ibag_count] - igen_ndxs[0];
+        gen_rec *gens = loadArena.New<gen_rec>(gen_count);
+        if (gens == nullptr) FILE_MALLOC_ERROR(false, gen_count*gen_rec::Size)
+
+        seekPos = (preset?sfbk.pdta.pgen_position:sfbk.pdta.igen_position) + igen_ndxs[0]*gen_rec::Size;
+        if (file.seek(seekPos) == false) FILE_SEEK_ERROR_CODE(preset?SF22ASWT::Errors::PDTA_PGEN_DATA_SEEK:SF22ASWT::Errors::PDTA_IGEN_DATA_SEEK, seekPos) //seek error to first igen record
+        if ((lastReadCount = file.read(gens, gen_rec::Size*gen_count)) != gen_rec::Size*gen_count) FILE_ERROR_CODE(preset?SF22ASWT::Errors::PDTA_PGEN_DATA_READ:SF22ASWT::Errors::PDTA_IGEN_DATA_READ)
+
         for (int i=0;i<ibag_count;i++)
         {
-            uint16_t start = igen_ndxs[i];
-            uint16_t end = igen_ndxs[i+1];
-            uint16_t count = end-start;
-            bags[i].items = new gen_rec[count];
-            bags[i].count = count;
-
-            if ((lastReadCount = file.read(bags[i].items, gen_rec::Size*count)) != gen_rec::Size*count) FILE_ERROR(PDTA_IGEN_DATA_READ)
+            bags[i].items = &gens[igen_ndxs[i] - igen_ndxs[0]];
+            bags[i].count = igen_ndxs[i+1] - igen_ndxs[i];
 #ifdef SF22ASWT_DEBUG
             DebugPrintBagContents(bags[i]);
 #endif
@@ -281,190 +513,159 @@ namespace SF22ASWT
         return true;
     }
 
-    bool ReaderLazy::Load_instrument_from_file(const char * filePath, int instrumentIndex, AudioSynthWavetable::instrument_data **aswt_id, Print &errPrintStream)
+#pragma region preset_load
+    bool ReaderLazy::BuildPresetIndex(File &file)
     {
-        
-        if (ReadFile(filePath) == false)
-        {
-            errPrintStream.println("Read file error:");
-            printSF2ErrorInfo(errPrintStream);
-            return false;
-        }
-        SF22ASWT::instrument_data_temp inst_temp = {0,0,nullptr};
+        if (sfbk.pdta.phdr_count == 0) return true; // failsafe, a valid pdta block has at least the EOP record
+        uint32_t presetCount = sfbk.pdta.phdr_count - 1; // the last is allways a EOP
+        if (presetIndex.Alloc(presetCount) == false) FILE_MALLOC_ERROR(false, (presetCount + 1)*sizeof(preset_index_rec))
+
+        // the terminal EOP record gives the pbag end of the last preset, so it is set together with the last preset
+        SF22ASWT::phdr_rec phdrs[SF22ASWT_ITERATE_BLOCK_RECORDS + 1];
+        bool readOK = readRecords(file, phdrs, SF22ASWT_ITERATE_BLOCK_RECORDS + 1, sfbk.pdta.phdr_position, sfbk.pdta.phdr_count, 0, true,
+            SF22ASWT::Errors::PDTA_PHDR_DATA_SEEK, SF22ASWT::Errors::PDTA_PHDR_DATA_READ,
+            [&](uint32_t index, const SF22ASWT::phdr_rec *record) {
+                presetIndex.Set(index, record[0]);
+                if (index + 1 == presetCount) presetIndex.Set(index + 1, record[1]);
+                return true;
+            });
+        if (readOK == false) return false;
+        if (presetIndex.Finish() == false) FILE_MALLOC_ERROR(false, presetIndex.getSize())
+        return true;
+    }
 
-        if (Load_instrument_data(instrumentIndex, inst_temp) == false)
-        {
-            errPrintStream.println("load_instrument_data error:");
-            printSF2ErrorInfo(errPrintStream);
-            return false;
-        }
-        if (ReadSampleDataFromFile(inst_temp) == false)
+    bool ReaderLazy::Load_preset_data(uint16_t bank, uint16_t program, SF22ASWT::instrument_data_temp &inst, bool useLoadArena)
+    {
+        clearErrors();
+        if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+
+        // the preset index gives the pbag range without reading phdr
+        int index = presetIndex.Find(bank, program);
+        if (index == -1) { lastError = SF22ASWT::Errors::FUNCTION_LOAD_PRESET_INDEX_RANGE; return false; }
+        uint16_t pbag_startIndex = presetIndex.getPbagStart(index);
+        uint16_t pbag_endIndex = presetIndex.getPbagEnd(index);
+        if (pbag_endIndex <= pbag_startIndex) { lastError = SF22ASWT::Errors::PDTA_PHDR_DATA_READ; return false; }
+
+        File tempFile;
+        File &file = openFile(tempFile);
+        if (!file) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; } // extra failsafe
+        uint16_t pbag_count = pbag_endIndex - pbag_startIndex;
+
+        loadArena.Reset();
+        bag_of_gens *pbags = nullptr;
+        if (fillBagsOfGens(file, pbags, pbag_startIndex, pbag_count, true) == false) return false;
+        int preset_zone_count = get_zone_count(pbags, pbag_count, SFGenerator::instrument);
+
+        // the ibag range of every preset zone (0,0 when it don't have a valid instrument), so that they are only read once
+        uint16_t *ibag_ranges = loadArena.New<uint16_t>(preset_zone_count*2);
+        if (ibag_ranges == nullptr) FILE_MALLOC_ERROR(false, preset_zone_count*2*sizeof(uint16_t))
+        // the zones of all used instruments is the upper limit, the zones outside the preset ranges are skipped later
+        zone_gens presetZone;
+        int capacity = 0;
+        for (int pi=0;pi<preset_zone_count;pi++)
         {
-            errPrintStream.println("ReadSampleDataFromFile error:");
-            printSF2ErrorInfo(errPrintStream);
-            return false;
+            get_zone_gens(pbags, pi, presetZone, SFGenerator::instrument);
+            if (presetZone.isSet(SFGenerator::instrument) == false) continue; // a zone without a instrument is ignored
+            uint32_t index = presetZone.get(SFGenerator::instrument).UAmount;
+            if (index + 1 >= sfbk.pdta.inst_count) continue; // the last is allways a EOI
+            if (index < instIndex_count) {
+                ibag_ranges[pi*2] = instIndex[index].ibag_start;
+                ibag_ranges[pi*2+1] = instIndex[index].ibag_end;
+            }
+            else if (read_ibag_range(file, index, ibag_ranges[pi*2], ibag_ranges[pi*2+1]) == false) return false;
+            if (ibag_ranges[pi*2+1] > ibag_ranges[pi*2]) capacity += ibag_ranges[pi*2+1] - ibag_ranges[pi*2];
         }
-        AudioSynthWavetable::instrument_data* new_inst = new AudioSynthWavetable::instrument_data(SF22ASWT::converter::to_AudioSynthWavetable_instrument_data(inst_temp));
-        if (new_inst == nullptr) // failsafe
+        if (capacity > UINT8_MAX) capacity = UINT8_MAX; // sample_count is a uint8_t, addPresetZones fails if more zones are used
+
+        inst.sample_count = capacity;
+        if (allocInstrumentArrays(inst, useLoadArena) == false) FILE_MALLOC_ERROR(false, inst.sample_count*sizeof(sample_header_temp))
+        inst.sample_count = 0;
+
+        auto getShdr = [this, &file](const zone_gens &zone, shdr_rec &shdr) { return get_sample_header(file, zone, &shdr); };
+        for (int pi=0;pi<preset_zone_count;pi++)
         {
-            errPrintStream.println("convert to AudioSynthWavetable::instrument_data error!");
-            return false;
+            if (ibag_ranges[pi*2+1] <= ibag_ranges[pi*2]) continue;
+            get_zone_gens(pbags, pi, presetZone, SFGenerator::instrument);
+            uint16_t ibag_count = ibag_ranges[pi*2+1] - ibag_ranges[pi*2];
+
+            bag_of_gens *ibags = nullptr;
+            if (fillBagsOfGens(file, ibags, ibag_ranges[pi*2], ibag_count) == false) return false;
+            if (addPresetZones(inst, capacity, presetZone, ibags, ibag_count, getShdr) == false) { releaseFile(file); return false; }
         }
-        
-        *aswt_id = new_inst;
+        sortZonesByKeyRange(inst);
+        DebugPrint("\nsample count: "); DebugPrint(inst.sample_count);
+
+        releaseFile(file);
         return true;
     }
 
-    bool ReaderLazy::Load_instrument(int instrumentIndex, AudioSynthWavetable::instrument_data*& aswt_id, Print &errPrintStream)
+    bool ReaderLazy::Load_preset(int bank, int program, AudioSynthWavetable::instrument_data*& aswt_id, Print &errPrintStream)
     {
         SF22ASWT::instrument_data_temp inst_temp = {0,0,nullptr};
+        if (Load_preset_data(bank, program, inst_temp, true) == false) return printLoadError(errPrintStream, "load_preset_data");
+        return loadAswtInstrument(inst_temp, aswt_id, errPrintStream);
+    }
+#pragma endregion
 
-        if (Load_instrument_data(instrumentIndex, inst_temp) == false)
-        {
-            errPrintStream.println("load_instrument_data error:");
-            printSF2ErrorInfo(errPrintStream);
-            return false;
-        }
-        if (ReadSampleDataFromFile(inst_temp) == false)
-        {
-            errPrintStream.println("ReadSampleDataFromFile error:");
-            printSF2ErrorInfo(errPrintStream);
-            return false;
-        }
-        AudioSynthWavetable::instrument_data* new_inst = new AudioSynthWavetable::instrument_data(SF22ASWT::converter::to_AudioSynthWavetable_instrument_data(inst_temp));
-        if (new_inst == nullptr) // failsafe
-        {
-            errPrintStream.println("convert to AudioSynthWavetable::instrument_data error!");
-            return false;
-        }
-        aswt_id = new_inst;
-        return true;
+    bool ReaderLazy::Load_instrument_from_file(const char * filePath, int instrumentIndex, AudioSynthWavetable::instrument_data **aswt_id, Print &errPrintStream)
+    {
+        if (ReadFile(filePath) == false) return printLoadError(errPrintStream, "Read file");
+        return Load_instrument(instrumentIndex, *aswt_id, errPrintStream);
+    }
+
+    bool ReaderLazy::Load_instrument(int instrumentIndex, AudioSynthWavetable::instrument_data*& aswt_id, Print &errPrintStream)
+    {
+        SF22ASWT::instrument_data_temp inst_temp = {0,0,nullptr};
+        if (Load_instrument_data(instrumentIndex, inst_temp, true) == false) return printLoadError(errPrintStream, "load_instrument_data");
+        return loadAswtInstrument(inst_temp, aswt_id, errPrintStream);
     }
 
     bool ReaderLazy::PrintInfoBlock(Print &printStream)
     {
         clearErrors();
         if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
-        File file = SD.open(filePath.c_str());
+        File tempFile;
+        File &file = openFile(tempFile);
         if (!file) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; } // extra failsafe
 
         SF22ASWT::INFO info;
         if (file.seek(sfbk.info_position) == false) FILE_ERROR(INFO_DATA_SEEK)
         if (readInfoBlock(file, info) == false) return false; // readInfoBlock have allready closed the file
         
-        file.close();
+        releaseFile(file);
         info.size = sfbk.info_size;
         info.PrintTo(printStream);
         return true;
     }
 
-    bool ReaderLazy::read_pdta_block(File &file, pdta_rec_lazy &pdta)
+    template<class T>
+    bool ReaderLazy::skip_pdta_records(File &file, uint32_t fourCC, uint32_t size, uint32_t &position, uint32_t &count)
     {
-        char fourCC[4];
-        uint32_t size = 0;
-        while (file.available())
-        {
-            if ((lastReadCount = file.readBytes(fourCC, 4)) != 4) FILE_ERROR(PDTA_FOURCC_READ) //("read error - while getting pdta block type")
-            DebugPrintFOURCC(fourCC);
-            if (verifyFourCC(fourCC) == false) FILE_ERROR(PDTA_FOURCC_INVALID) //("error - pdta type invalid")
-
-            // store result for easier pinpoint of error handing
-            bool sizeReadFail = ((lastReadCount = file.read(&size, 4)) != 4);
-
-            if (strncmp(fourCC, "phdr", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_PHDR_SIZE_READ) //("read error - while getting pdta phdr block size")
-                if (size % phdr_rec::Size != 0) FILE_ERROR(PDTA_PHDR_SIZE_MISMATCH) //("error - pdta phdr block size mismatch")
-
-                pdta.phdr_count = size/phdr_rec::Size;
-                pdta.phdr_position = file.position();
-                if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR(PDTA_PHDR_DATA_SKIP, size) //("seek error - while skipping phdr block")
-            }
-            else if (strncmp(fourCC, "pbag", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_PBAG_SIZE_READ) //("read error - while getting pdta pbag block size")
-                if (size % bag_rec::Size != 0) FILE_ERROR(PDTA_PBAG_SIZE_MISMATCH) //("error - pdta pbag block size mismatch")
-
-                pdta.pbag_count = size/bag_rec::Size;
-                pdta.pbag_position = file.position();
-                if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR(PDTA_PBAG_DATA_SKIP, size) //("seek error - while skipping pbag block")
-            }
-            else if (strncmp(fourCC, "pmod", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_PMOD_SIZE_READ) //("read error - while getting pdta pmod block size")
-                if (size % mod_rec::Size != 0) FILE_ERROR(PDTA_PMOD_SIZE_MISMATCH) //("error - pdta pmod block size mismatch")
-
-                pdta.pmod_count = size/mod_rec::Size;
-                pdta.pmod_position = file.position();
-                if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR(PDTA_PMOD_DATA_SKIP, size) //("seek error - while skipping pmod block")
-            }
-            else if (strncmp(fourCC, "pgen", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_PGEN_SIZE_READ) //("read error - while getting pdta pgen block size")
-                if (size % gen_rec::Size != 0) FILE_ERROR(PDTA_PGEN_SIZE_MISMATCH) //("error - pdta pgen block size mismatch")
-
-                pdta.pgen_count = size/gen_rec::Size;
-                pdta.pgen_position = file.position();
-                if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR(PDTA_PGEN_DATA_SKIP, size) //("seek error - while skipping pgen block")
-            }
-            else if (strncmp(fourCC, "inst", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_INST_SIZE_READ) //("read error - while getting pdta inst block size")
-                if (size % inst_rec::Size != 0) FILE_ERROR(PDTA_INST_SIZE_MISMATCH) //("error - pdta inst block size mismatch")
-
-                pdta.inst_count = size/inst_rec::Size;
-                pdta.inst_position = file.position();
-                if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR(PDTA_INST_DATA_SKIP, size) //("seek error - while skipping inst block")
-            }
-            else if (strncmp(fourCC, "ibag", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_IBAG_SIZE_READ) //("read error - while getting pdta ibag block size")
-                if (size % bag_rec::Size != 0) FILE_ERROR(PDTA_IBAG_SIZE_MISMATCH) //("error - pdta ibag block size mismatch")
-
-                pdta.ibag_count = size/bag_rec::Size;
-                pdta.ibag_position = file.position();
-                if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR(PDTA_IBAG_DATA_SKIP, size) //("seek error - while skipping ibag block")
-            }
-            else if (strncmp(fourCC, "imod", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_IMOD_SIZE_READ) //("read error - while getting pdta imod block size")
-                if (size % mod_rec::Size != 0) FILE_ERROR(PDTA_IMOD_SIZE_MISMATCH) //("error - pdta imod block size mismatch")
-
-                pdta.imod_count = size/mod_rec::Size;
-                pdta.imod_position = file.position();
-                if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR(PDTA_IMOD_DATA_SKIP, size) //("seek error - while skipping imod block")
-            }
-            else if (strncmp(fourCC, "igen", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_IGEN_SIZE_READ) //("read error - while getting pdta igen block size")
-                if (size % gen_rec::Size != 0) FILE_ERROR(PDTA_IGEN_SIZE_MISMATCH) //("error - pdta igen block size mismatch")
+        uint16_t sub = FourCC::pdtaSubLocation(fourCC);
+        if (size % T::Size != 0) FILE_ERROR_CODE(Error::Code(Error::RootLocation::PDTA, sub, Error::Type::SIZE, Error::Operation::MISMATCH)) //("error - pdta block size mismatch")
 
-                pdta.igen_count = size/gen_rec::Size;
-                pdta.igen_position = file.position();
-                if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR(PDTA_IGEN_DATA_SKIP, size) //("seek error - while skipping igen block")
-            }
-            else if (strncmp(fourCC, "shdr", 4) == 0)
-            {
-                if (sizeReadFail) FILE_ERROR(PDTA_SHDR_SIZE_READ) //("read error - while getting pdta shdr block size")
-                if (size % shdr_rec::Size != 0) FILE_ERROR(PDTA_SHDR_SIZE_MISMATCH) //("error - pdta shdr block size mismatch")
+        count = size/T::Size;
+        position = file.position();
+        if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR_CODE(Error::Code(Error::RootLocation::PDTA, sub, Error::Type::DATA, Error::Operation::SEEKSKIP), size) //("seek error - while skipping pdta block")
+        return true;
+    }
 
-                pdta.shdr_count = size/shdr_rec::Size;
-                pdta.shdr_position = file.position();
-                if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR(PDTA_SHDR_DATA_SKIP, size) //("seek error - while skipping shdr block")
-            }
-            else if (strncmp(fourCC, "LIST", 4) == 0) // failsafe if file don't follow standard
-            {
-                // skip back
-                if (file.seek(file.position()-8) == false) FILE_SEEK_ERROR(PDTA_BACK_SEEK, -8) 
-                return true;
-            }
-            else
+    bool ReaderLazy::read_pdta_block(File &file, pdta_rec_lazy &pdta)
+    {
+        return walkChunks(file, Error::RootLocation::PDTA, FourCC::pdtaSubLocation, [&](uint32_t fourCC, uint32_t size) {
+            switch (fourCC)
             {
-                // normally unknown blocks should be ignored
-                if (sizeReadFail) FILE_ERROR(PDTA_UNKNOWN_BLOCK_SIZE_READ) //("read error - while getting unknown block size")
-                if (file.seek(size, SeekCur) == false) FILE_SEEK_ERROR(PDTA_UNKNOWN_BLOCK_DATA_SKIP, size) //("seek error - while skipping unknown pdta block")
+                case FourCC::phdr: return skip_pdta_records<phdr_rec>(file, fourCC, size, pdta.phdr_position, pdta.phdr_count);
+                case FourCC::pbag: return skip_pdta_records<bag_rec>(file, fourCC, size, pdta.pbag_position, pdta.pbag_count);
+                case FourCC::pmod: return skip_pdta_records<mod_rec>(file, fourCC, size, pdta.pmod_position, pdta.pmod_count);
+                case FourCC::pgen: return skip_pdta_records<gen_rec>(file, fourCC, size, pdta.pgen_position, pdta.pgen_count);
+                case FourCC::inst: return skip_pdta_records<inst_rec>(file, fourCC, size, pdta.inst_position, pdta.inst_count);
+                case FourCC::ibag: return skip_pdta_records<bag_rec>(file, fourCC, size, pdta.ibag_position, pdta.ibag_count);
+                case FourCC::imod: return skip_pdta_records<mod_rec>(file, fourCC, size, pdta.imod_position, pdta.imod_count);
+                case FourCC::igen: return skip_pdta_records<gen_rec>(file, fourCC, size, pdta.igen_position, pdta.igen_count);
+                case FourCC::shdr: return skip_pdta_records<shdr_rec>(file, fourCC, size, pdta.shdr_position, pdta.shdr_count);
+                default: return skipChunk(file, Error::RootLocation::PDTA, size);
             }
-        }
-        return true;
+        });
     }
 }
\ No newline at end of file
@@ -1,19 +1,32 @@
 #pragma once
 
-#include <Arduino.h>
-#include <SD.h>
+#include "sf22aswt_platform.h"
 
 #include "sf22aswt_reader_base.h"
 #include "sf22aswt_structures.h"
 #include "sf22aswt_enums.h"
 #include "sf22aswt_helpers.h"
 #include "sf22aswt_converter.h"
+#include "sf22aswt_shdr_cache.h"
+#include "sf22aswt_views.h"
+#include "sf22aswt_json_list.h"
+
+#ifndef SF22ASWT_INDEX_FILE_EXTENSION
+/** appended to the sf2 file path to get the index file path, i.e. gm.sf2.sfidx */
+#define SF22ASWT_INDEX_FILE_EXTENSION ".sfidx"
+#endif
+
+#ifndef SF22ASWT_ITERATE_BLOCK_RECORDS
+/** records read by every file read of ForEachInstrument/ForEachPreset/ForEachSample (the buffer is on the stack) */
+#define SF22ASWT_ITERATE_BLOCK_RECORDS 16
+#endif
 
 namespace SF22ASWT
 {
     class ReaderLazy : public SF22ASWT::ReaderBase
     {
       public:
+        ~ReaderLazy();
         sfbk_rec_lazy sfbk;
 
         bool CloneInto(ReaderLazy &other);
@@ -21,31 +34,176 @@ namespace SF22ASWT
          *  note. this is lazy read 
          *  and only the file data position for
          *  all used blocks are stored into ram
+         * 
+         *  when useIndexFile is true the index file (<filePath>.sfidx) is used
+         *  instead of walking the file structure, if the index file don't exist
+         *  or don't match the sf2 file then it's (re)created after the normal read
          */
-        bool ReadFile(const char * filePath);
-        bool PrintInstrumentListAsJson(Print &printStream);
-        bool PrintPresetListAsJson(Print &printStream);
+        bool ReadFile(const char * filePath, bool useIndexFile = false);
+        /** true when the instrument index is available (only when ReadFile was called with useIndexFile) */
+        bool hasInstrumentIndex();
+        /** returns nullptr if index is out of range or if the instrument index is not available */
+        const inst_index_rec* getInstrumentIndexEntry(uint index);
+        /**
+         * walks the zones of all instruments once and stores them in a flattened table (see getZoneIndex)
+         * Load_instrument_data then only copies the zones of the instrument from the table
+         * the table is placed in PSRAM when available and is freed by ReadFile
+        */
+        bool BuildZoneIndex();
+        /** reads the instrument and preset names (a few records per read) into the name indexes (see ReaderBase::FindInstrument) */
+        bool BuildNameIndex();
+        /**
+         * prints at most limit instruments/presets which name contains filter (case insensitive, nullptr lists all),
+         * starting at the offset matching item (see sf22aswt_json_list.h for the format)
+         * the output is buffered and written in SF22ASWT_JSON_BUFFER_SIZE parts (a USB packet)
+        */
+        bool PrintInstrumentListAsJson(Print &printStream, uint32_t offset = 0, uint32_t limit = UINT32_MAX, const char *filter = nullptr);
+        bool PrintPresetListAsJson(Print &printStream, uint32_t offset = 0, uint32_t limit = UINT32_MAX, const char *filter = nullptr);
+
+#pragma region iterators
+        /**
+         * calls callback(const InstrumentView&) for every instrument in file order
+         * the inst records are read SF22ASWT_ITERATE_BLOCK_RECORDS at a time into a buffer that the views points into
+         * the callback returns false to stop the iteration, nothing is allocated
+         * first is the index of the first instrument, the records before it are not read
+         * note. the other functions of the reader must not be used inside the callback, as they use the same file
+        */
+        template<class F>
+        bool ForEachInstrument(F callback, uint32_t first = 0)
+        {
+            inst_rec records[SF22ASWT_ITERATE_BLOCK_RECORDS + 1];
+            // the next record gives the end of the bags, so the last record of a block is moved to the start of the next
+            return forEachRecord(records, SF22ASWT_ITERATE_BLOCK_RECORDS + 1, sfbk.pdta.inst_position, sfbk.pdta.inst_count, first, true,
+                SF22ASWT::Errors::PDTA_INST_DATA_SEEK, SF22ASWT::Errors::PDTA_INST_DATA_READ,
+                [&](uint32_t index, const inst_rec *record) { return callback(InstrumentView(index, record[0], record[1])); });
+        }
+        /** the same as ForEachInstrument but for the presets, callback(const PresetView&) */
+        template<class F>
+        bool ForEachPreset(F callback, uint32_t first = 0)
+        {
+            phdr_rec records[SF22ASWT_ITERATE_BLOCK_RECORDS + 1];
+            return forEachRecord(records, SF22ASWT_ITERATE_BLOCK_RECORDS + 1, sfbk.pdta.phdr_position, sfbk.pdta.phdr_count, first, true,
+                SF22ASWT::Errors::PDTA_PHDR_DATA_SEEK, SF22ASWT::Errors::PDTA_PHDR_DATA_READ,
+                [&](uint32_t index, const phdr_rec *record) { return callback(PresetView(index, record[0], record[1])); });
+        }
+        /** the same as ForEachInstrument but for the sample headers, callback(const SampleView&) */
+        template<class F>
+        bool ForEachSample(F callback, uint32_t first = 0)
+        {
+            shdr_rec records[SF22ASWT_ITERATE_BLOCK_RECORDS];
+            return forEachRecord(records, SF22ASWT_ITERATE_BLOCK_RECORDS, sfbk.pdta.shdr_position, sfbk.pdta.shdr_count, first, false,
+                SF22ASWT::Errors::PDTA_SHDR_DATA_SEEK, SF22ASWT::Errors::PDTA_SHDR_DATA_READ,
+                [&](uint32_t index, const shdr_rec *record) { return callback(SampleView(index, record[0])); });
+        }
+#pragma endregion
         /**
          * this function do only load the sample preset headers for the instrument (soundfont igen data)
          * to load the actual sample data the function <instance name>::ReadSampleDataFromFile should be used
+         * when useLoadArena is true the arrays of inst are allocated from the load arena,
+         * they are then only valid until the next instrument load
         */
-        bool Load_instrument_data(uint index, SF22ASWT::instrument_data_temp &inst);
+        bool Load_instrument_data(uint index, SF22ASWT::instrument_data_temp &inst, bool useLoadArena = false);
         /**
          * this function is like Load_instrument_data but also loads the sample data 
          * the output is AudioSynthWavetable::instrument_data
          * note that errPrintStream is default to Serial which can be changed into any Print Stream
         */
         bool Load_instrument(int instrumentIndex, AudioSynthWavetable::instrument_data*& aswt_id, Print &errPrintStream = Serial);
+        /**
+         * like Load_instrument_data but for the preset with the bank and program (bank 128 is percussion)
+         * the zones of all instruments of the preset are merged into inst,
+         * only the zones inside the key/velocity range of the preset zones are used
+         * and the generators of the preset zones are added to the instrument generators
+        */
+        bool Load_preset_data(uint16_t bank, uint16_t program, SF22ASWT::instrument_data_temp &inst, bool useLoadArena = false);
+        /**
+         * this function is like Load_preset_data but also loads the sample data
+         * the output is AudioSynthWavetable::instrument_data
+        */
+        bool Load_preset(int bank, int program, AudioSynthWavetable::instrument_data*& aswt_id, Print &errPrintStream = Serial);
         /**
          * this is mostly intended as a demo or to quickly use this library
          * note that errPrintStream is default to Serial which can be changed into any Print Stream
         */
         bool Load_instrument_from_file(const char * filePath, int instrumentIndex, AudioSynthWavetable::instrument_data **aswt_id, Print &errPrintStream = Serial);
         bool PrintInfoBlock(Print &printStream);
+        /** the sample header cache, filled on demand by Load_instrument_data */
+        ShdrCache& getShdrCache();
 
   private:
+        /**
+         * reads the count-1 records (the last is allways a terminal record) at position in blocks into records (bufferCount records)
+         * and calls item(index, record) for each of them starting at first, with withNext the record after is also available as record[1]
+         */
+        template<class T, class F>
+        bool forEachRecord(T *records, uint32_t bufferCount, uint32_t position, uint32_t count, uint32_t first, bool withNext, SF22ASWT::Errors seekError, SF22ASWT::Errors readError, F item)
+        {
+            clearErrors();
+            if (lastReadWasOK == false) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; }
+            if (count == 0 || first >= count - 1) return true;
+            File tempFile;
+            File &file = openFile(tempFile);
+            if (!file) { lastError = SF22ASWT::Errors::FILE_NOT_OPEN; return false; } // extra failsafe
+            if (readRecords(file, records, bufferCount, position, count, first, withNext, seekError, readError, item) == false) return false;
+            releaseFile(file);
+            return true;
+        }
+        /**
+         * the same as forEachRecord but with a already open file, that is only released on errors
+         * (used while the file is read by ReadFile and to read several chunks with one open)
+         */
+        template<class T, class F>
+        bool readRecords(File &file, T *records, uint32_t bufferCount, uint32_t position, uint32_t count, uint32_t first, bool withNext, SF22ASWT::Errors seekError, SF22ASWT::Errors readError, F item)
+        {
+            if (count == 0 || first >= count - 1) return true;
+            position += first*T::Size;
+            if (file.seek(position) == false) FILE_SEEK_ERROR_CODE(seekError, position)
+
+            uint32_t itemCount = count - 1;
+            uint32_t index = first;
+            uint32_t buffered = 0; // the record kept from the previous block (withNext)
+            while (index < itemCount)
+            {
+                uint32_t toRead = count - index - buffered;
+                if (toRead > bufferCount - buffered) toRead = bufferCount - buffered;
+                if ((lastReadCount = file.read(&records[buffered], T::Size*toRead)) != T::Size*toRead) FILE_ERROR_CODE(readError)
+                uint32_t available = buffered + toRead;
+                uint32_t items = withNext ? (available - 1) : available;
+                if (items > itemCount - index) items = itemCount - index;
+                for (uint32_t i=0;i<items;i++,index++)
+                    if (item(index, &records[i]) == false) return true;
+                if (withNext) {
+                    records[0] = records[items];
+                    buffered = 1;
+                }
+            }
+            return true;
+        }
+
+        /** the instrument index is only loaded/created when ReadFile is used with useIndexFile */
+        inst_index_rec *instIndex = nullptr;
+        uint32_t instIndex_count = 0;
+        ShdrCache shdrCache;
+
+        sdta_rec_lazy& get_sdta() { return sfbk.sdta; }
         bool read_pdta_block(File &file, pdta_rec_lazy &pdta);
-        bool fillBagsOfGens(File &file, bag_of_gens* bags, int ibag_startIndex, int ibag_count);
+        /** stores the position and the record count of a pdta sub chunk and skips it */
+        template<class T>
+        bool skip_pdta_records(File &file, uint32_t fourCC, uint32_t size, uint32_t &position, uint32_t &count);
+        /** the bags, the gens and the ibag indexes are allocated from the load arena, pbag/pgen is used when preset is true */
+        bool fillBagsOfGens(File &file, bag_of_gens*& bags, int ibag_startIndex, int ibag_count, bool preset = false);
+        bool read_ibag_range(File &file, uint index, uint16_t &ibag_startIndex, uint16_t &ibag_endIndex);
+        /** reads the phdr chunk a few records at a time into the preset index */
+        bool BuildPresetIndex(File &file);
+        /** returns false if the zone don't have a sampleID, or when it's out of range and on file errors (then lastError is set and the file is released) */
+        bool get_sample_header(File &file, const zone_gens &zone, shdr_rec *shdr);
+
+        void FreeInstrumentIndex();
+        /** calculates the values used to verify that the index file belongs to the sf2 file */
+        bool getIndexFileValidation(File &file, const pdta_rec_lazy &pdta, uint32_t &modifyTime, uint32_t &hash);
+        bool ReadIndexFile(const char * filePath);
+        bool WriteIndexFile();
+        bool buildInstrumentIndexEntry(File &file, uint index, inst_index_rec &entry);
         
     };
 
@@ -0,0 +1,98 @@
+#include "sf22aswt_resampler.h"
+#include <math.h>
+#include <stdlib.h>
+
+namespace SF22ASWT::Resampler
+{
+    /** Kaiser window beta, about 60 dB stopband attenuation */
+    static const double Beta = 6.0;
+
+    static int16_t *table = nullptr;
+    static double tableRatio = 0;
+
+    /** the modified Bessel function of the first kind (order 0) used by the Kaiser window */
+    static double besselI0(double x)
+    {
+        double sum = 1, term = 1;
+        for (int k=1;k<32;k++)
+        {
+            term *= (x / (2*k)) * (x / (2*k));
+            sum += term;
+            if (term < sum * 1e-12) break;
+        }
+        return sum;
+    }
+
+    bool Init(double ratio)
+    {
+        // the loop adjusted ratios of the samples differs a little, they all uses the same filter
+        ratio = floor(ratio * 256) / 256;
+        if (table != nullptr && ratio == tableRatio) return true;
+        if (table == nullptr) {
+            table = (int16_t*)malloc(Phases * Taps * sizeof(int16_t));
+            if (table == nullptr) return false;
+        }
+        tableRatio = ratio;
+
+        // the transition band of the window is about 0.11 cycles/sample, it's placed below the new nyquist
+        double cutoff = 0.5 * ratio - 0.055;
+        if (cutoff < 0.25 * ratio) cutoff = 0.25 * ratio;
+        double i0Beta = besselI0(Beta);
+        for (int p=0;p<Phases;p++)
+        {
+            double frac = (double)p / Phases;
+            double h[Taps];
+            double sum = 0;
+            for (int k=0;k<Taps;k++)
+            {
+                // the distance from the output position to input sample (base - Taps/2 + 1 + k)
+                double t = k - Taps/2 + 1 - frac;
+                double x = 2 * cutoff * t;
+                double sinc = (x == 0) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+                double w = t / (Taps/2);
+                w = (w * w < 1) ? besselI0(Beta * sqrt(1 - w * w)) / i0Beta : 0;
+                h[k] = 2 * cutoff * sinc * w;
+                sum += h[k];
+            }
+            // normalized so that every phase has the gain 1 (in Q15)
+            int16_t *c = table + p*Taps;
+            int32_t total = 0;
+            for (int k=0;k<Taps;k++)
+            {
+                c[k] = (int16_t)lround(h[k] / sum * 32768.0);
+                total += c[k];
+            }
+            c[Taps/2 - 1 + ((frac < 0.5) ? 0 : 1)] += (int16_t)(32768 - total);
+        }
+        return true;
+    }
+
+    void Free()
+    {
+        free(table);
+        table = nullptr;
+        tableRatio = 0;
+    }
+
+    void Process(const int16_t *in, int inFirst, int16_t *out, uint32_t outIndex, size_t count, uint64_t step)
+    {
+        uint64_t pos = (uint64_t)outIndex * step;
+        for (size_t i=0;i<count;i++, pos += step)
+        {
+            int base = (int)(pos >> 32);
+            // the nearest phase, rounding up to the next sample at the end
+            uint32_t phase = (uint32_t)(((pos & 0xFFFFFFFF) + (1ull << (31 - SF22ASWT_RESAMPLER_PHASE_BITS))) >> (32 - SF22ASWT_RESAMPLER_PHASE_BITS));
+            if (phase == Phases) { base++; phase = 0; }
+
+            const int16_t *c = table + phase*Taps;
+            const int16_t *x = in + (base - Taps/2 + 1 - inFirst);
+            int64_t acc = 0;
+            for (int k=0;k<Taps;k++)
+                acc += (int32_t)c[k] * x[k];
+            acc = (acc + (1 << 14)) >> 15;
+            if (acc > 32767) acc = 32767;
+            else if (acc < -32768) acc = -32768;
+            out[i] = (int16_t)acc;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+/**
+ * polyphase windowed sinc resampler used to lower the sample rate of samples while loading
+ * (see ReaderBase::setResampleRate and ReaderBase::setDecimateBudget)
+ *
+ * the filter is a table of SF22ASWT_RESAMPLER_TAPS Kaiser windowed sinc taps
+ * for each of the 2^SF22ASWT_RESAMPLER_PHASE_BITS fractional positions,
+ * the cutoff follows the ratio so it's also the anti alias filter,
+ * the table is allocated on the first use and rebuilt only when the ratio changes
+ *
+ * it has no Arduino dependencies so that it can be tested on a host
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef SF22ASWT_RESAMPLER_TAPS
+/** filter length in input samples, must be even */
+#define SF22ASWT_RESAMPLER_TAPS 32
+#endif
+#ifndef SF22ASWT_RESAMPLER_PHASE_BITS
+/** 2^bits filter phases, the table takes TAPS * 2^bits * 2 bytes (8 kB with the defaults) */
+#define SF22ASWT_RESAMPLER_PHASE_BITS 7
+#endif
+#ifndef SF22ASWT_RESAMPLER_CHUNK_SAMPLES
+/** input samples read at a time while loading, the window buffer on the stack is about 2x this in bytes */
+#define SF22ASWT_RESAMPLER_CHUNK_SAMPLES 1024
+#endif
+
+namespace SF22ASWT::Resampler
+{
+    static_assert(SF22ASWT_RESAMPLER_TAPS % 2 == 0, "SF22ASWT_RESAMPLER_TAPS must be even");
+
+    constexpr int Taps = SF22ASWT_RESAMPLER_TAPS;
+    constexpr int Phases = 1 << SF22ASWT_RESAMPLER_PHASE_BITS;
+
+    /** builds the filter for ratio (output rate / input rate, 0 to 1), returns false if the table could not be allocated */
+    bool Init(double ratio);
+    /** frees the filter table */
+    void Free();
+
+    /** input samples per output sample as 32.32 fixed point */
+    inline uint64_t getStep(double ratio) { return (uint64_t)(4294967296.0 / ratio + 0.5); }
+    /** the first and last input sample needed to compute the output sample outIndex */
+    inline int getFirstInput(uint32_t outIndex, uint64_t step) { return (int)(((uint64_t)outIndex * step) >> 32) - Taps/2 + 1; }
+    inline int getLastInput(uint32_t outIndex, uint64_t step) { return (int)(((uint64_t)outIndex * step) >> 32) + Taps/2 + 1; }
+
+    /**
+     * computes count output samples from the output index outIndex,
+     * in holds the input samples from the input index inFirst and must cover
+     * getFirstInput(outIndex) to getLastInput(outIndex + count - 1)
+     */
+    void Process(const int16_t *in, int inFirst, int16_t *out, uint32_t outIndex, size_t count, uint64_t step);
+}
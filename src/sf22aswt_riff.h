@@ -0,0 +1,101 @@
+/**
+ * RIFF FourCC values used by the chunk walkers in ReaderBase
+ *
+ * a FourCC is read from file directly into a uint32_t and is then compared
+ * to these constexpr values in a switch, instead of a chain of strncmp
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+#include "sf22aswt_error_enums.h"
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "the FourCC values are in little endian file byte order");
+
+namespace SF22ASWT::FourCC
+{
+    /** the value of the FourCC when it's read from file into a uint32_t */
+    constexpr uint32_t make(const char (&id)[5])
+    {
+        return (uint32_t)(uint8_t)id[0] | ((uint32_t)(uint8_t)id[1] << 8) | ((uint32_t)(uint8_t)id[2] << 16) | ((uint32_t)(uint8_t)id[3] << 24);
+    }
+
+    constexpr uint32_t RIFF = make("RIFF");
+    constexpr uint32_t sfbk = make("sfbk");
+    constexpr uint32_t LIST = make("LIST");
+    // list types
+    constexpr uint32_t INFO = make("INFO");
+    constexpr uint32_t sdta = make("sdta");
+    constexpr uint32_t pdta = make("pdta");
+    // INFO sub chunks
+    constexpr uint32_t ifil = make("ifil");
+    constexpr uint32_t isng = make("isng");
+    constexpr uint32_t INAM = make("INAM");
+    constexpr uint32_t irom = make("irom");
+    constexpr uint32_t iver = make("iver");
+    constexpr uint32_t ICRD = make("ICRD");
+    constexpr uint32_t IENG = make("IENG");
+    constexpr uint32_t IPRD = make("IPRD");
+    constexpr uint32_t ICOP = make("ICOP");
+    constexpr uint32_t ICMT = make("ICMT");
+    constexpr uint32_t ISFT = make("ISFT");
+    // sdta sub chunks
+    constexpr uint32_t smpl = make("smpl");
+    constexpr uint32_t sm24 = make("sm24");
+    // pdta sub chunks
+    constexpr uint32_t phdr = make("phdr");
+    constexpr uint32_t pbag = make("pbag");
+    constexpr uint32_t pmod = make("pmod");
+    constexpr uint32_t pgen = make("pgen");
+    constexpr uint32_t inst = make("inst");
+    constexpr uint32_t ibag = make("ibag");
+    constexpr uint32_t imod = make("imod");
+    constexpr uint32_t igen = make("igen");
+    constexpr uint32_t shdr = make("shdr");
+
+    /** the error sub location of a INFO sub chunk, 0 = unknown chunk */
+    constexpr uint16_t infoSubLocation(uint32_t fourCC)
+    {
+        switch (fourCC)
+        {
+            case ifil: return (uint16_t)Error::INFO::IFIL;
+            case isng: return (uint16_t)Error::INFO::ISNG;
+            case INAM: return (uint16_t)Error::INFO::INAM;
+            case irom: return (uint16_t)Error::INFO::IROM;
+            case iver: return (uint16_t)Error::INFO::IVER;
+            case ICRD: return (uint16_t)Error::INFO::ICRD;
+            case IENG: return (uint16_t)Error::INFO::IENG;
+            case IPRD: return (uint16_t)Error::INFO::IPRD;
+            case ICOP: return (uint16_t)Error::INFO::ICOP;
+            case ICMT: return (uint16_t)Error::INFO::ICMT;
+            case ISFT: return (uint16_t)Error::INFO::ISFT;
+            default: return 0;
+        }
+    }
+    /** the error sub location of a sdta sub chunk, 0 = unknown chunk */
+    constexpr uint16_t sdtaSubLocation(uint32_t fourCC)
+    {
+        switch (fourCC)
+        {
+            case smpl: return (uint16_t)Error::SDTA::SMPL;
+            case sm24: return (uint16_t)Error::SDTA::SM24;
+            default: return 0;
+        }
+    }
+    /** the error sub location of a pdta sub chunk, 0 = unknown chunk */
+    constexpr uint16_t pdtaSubLocation(uint32_t fourCC)
+    {
+        switch (fourCC)
+        {
+            case phdr: return (uint16_t)Error::PDTA::PHDR;
+            case pbag: return (uint16_t)Error::PDTA::PBAG;
+            case pmod: return (uint16_t)Error::PDTA::PMOD;
+            case pgen: return (uint16_t)Error::PDTA::PGEN;
+            case inst: return (uint16_t)Error::PDTA::INST;
+            case ibag: return (uint16_t)Error::PDTA::IBAG;
+            case imod: return (uint16_t)Error::PDTA::IMOD;
+            case igen: return (uint16_t)Error::PDTA::IGEN;
+            case shdr: return (uint16_t)Error::PDTA::SHDR;
+            default: return 0;
+        }
+    }
+}
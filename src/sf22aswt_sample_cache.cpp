@@ -0,0 +1,210 @@
+#include "sf22aswt_sample_cache.h"
+#include "sf22aswt_helpers.h"
+
+namespace SF22ASWT
+{
+    extern int samples_usedRam;
+}
+
+namespace SF22ASWT::SampleCache
+{
+    struct Entry
+    {
+        uint32_t fileId = 0;
+        uint32_t sampleStart = 0;
+        uint32_t length = 0;
+        int refCount = 0;
+        bool pinned = false;
+        uint32_t lastUse = 0;
+        SamplePool data;
+
+        bool isUsed() { return data.getData() != nullptr; }
+        bool isEvictable() { return isUsed() && refCount == 0 && pinned == false; }
+    };
+    static Entry entries[SF22ASWT_SAMPLE_CACHE_SIZE];
+    static int count = 0;
+    /** [0] = internal ram, [1] = PSRAM */
+    static size_t usedRam[2] = {0, 0};
+    static size_t budget[2] = {0, 0};
+    static uint32_t useCounter = 0;
+
+    static uint32_t hits = 0;
+    static uint32_t misses = 0;
+    static uint32_t evictions = 0;
+
+    static Entry* find(const int16_t *sample)
+    {
+        if (sample == nullptr) return nullptr;
+        for (int i=0;i<SF22ASWT_SAMPLE_CACHE_SIZE;i++)
+            if (entries[i].isUsed() && (const int16_t*)entries[i].data.getData() == sample) return &entries[i];
+        return nullptr;
+    }
+
+    static void remove(Entry &entry)
+    {
+        samples_usedRam -= entry.data.getSize();
+        usedRam[entry.data.getUseExtMem()?1:0] -= entry.data.getSize();
+        entry.data.Free();
+        entry.refCount = 0;
+        entry.pinned = false;
+        count--;
+    }
+
+    /** the least recently used evictable entry, optionally only of one memory type */
+    static Entry* findLRU(bool anyMemType, bool useExtMem)
+    {
+        Entry *lru = nullptr;
+        for (int i=0;i<SF22ASWT_SAMPLE_CACHE_SIZE;i++)
+        {
+            Entry &entry = entries[i];
+            if (entry.isEvictable() == false) continue;
+            if (anyMemType == false && entry.data.getUseExtMem() != useExtMem) continue;
+            // the difference handles the counter wrap around
+            if (lru == nullptr || (useCounter - entry.lastUse) > (useCounter - lru->lastUse)) lru = &entry;
+        }
+        return lru;
+    }
+
+    static void evict(Entry &entry)
+    {
+        remove(entry);
+        evictions++;
+    }
+
+    uint32_t getFileId(const char *filePath, uint32_t fileSize)
+    {
+        return Helpers::fnv1a32((const uint8_t*)filePath, strlen(filePath), fileSize);
+    }
+
+    const int16_t* Acquire(uint32_t fileId, uint32_t sampleStart, uint32_t length)
+    {
+        for (int i=0;i<SF22ASWT_SAMPLE_CACHE_SIZE;i++)
+        {
+            Entry &entry = entries[i];
+            if (entry.isUsed() == false || entry.fileId != fileId || entry.sampleStart != sampleStart || entry.length != length) continue;
+            entry.refCount++;
+            entry.lastUse = ++useCounter;
+            hits++;
+            return (const int16_t*)entry.data.getData();
+        }
+        misses++;
+        return nullptr;
+    }
+
+    int16_t* Insert(uint32_t fileId, uint32_t sampleStart, uint32_t length, size_t size, bool useExtMem)
+    {
+        if (getAvailable(useExtMem) < size) {
+            if (Evict(size - getAvailable(useExtMem), useExtMem) == false) return nullptr;
+        }
+
+        Entry *free = nullptr;
+        for (int i=0;i<SF22ASWT_SAMPLE_CACHE_SIZE && free == nullptr;i++)
+            if (entries[i].isUsed() == false) free = &entries[i];
+        if (free == nullptr) { // the cache is full
+            if ((free = findLRU(true, false)) == nullptr) return nullptr;
+            evict(*free);
+        }
+
+        // when out of memory (or the heap is fragmented) evict released samples until it fits
+        while (free->data.Alloc(size, useExtMem) == false) {
+            Entry *lru = findLRU(false, useExtMem);
+            if (lru == nullptr) return nullptr;
+            evict(*lru);
+        }
+        free->fileId = fileId;
+        free->sampleStart = sampleStart;
+        free->length = length;
+        free->refCount = 1;
+        free->pinned = false;
+        free->lastUse = ++useCounter;
+        count++;
+        usedRam[useExtMem?1:0] += size;
+        samples_usedRam += size;
+        return (int16_t*)free->data.getData();
+    }
+
+    void Release(const int16_t *sample)
+    {
+        Entry *entry = find(sample);
+        if (entry == nullptr || entry->refCount == 0) return;
+        entry->refCount--;
+        entry->lastUse = ++useCounter;
+    }
+
+    void Release(instrument_data_temp &inst)
+    {
+        for (int si=0;si<inst.sample_count;si++)
+        {
+            Release(inst.samples[si].sample);
+            inst.samples[si].sample = nullptr;
+        }
+    }
+
+    void Release(const AudioSynthWavetable::instrument_data &inst)
+    {
+        for (int si=0;si<inst.sample_count;si++)
+            Release((const int16_t*)inst.samples[si].sample);
+    }
+
+    void Discard(const int16_t *sample)
+    {
+        Entry *entry = find(sample);
+        if (entry == nullptr) return;
+        if (entry->refCount > 0) entry->refCount--;
+        if (entry->refCount == 0) remove(*entry);
+    }
+
+    void Pin(const int16_t *sample, bool pinned)
+    {
+        Entry *entry = find(sample);
+        if (entry != nullptr) entry->pinned = pinned;
+    }
+
+    void Pin(const AudioSynthWavetable::instrument_data &inst, bool pinned)
+    {
+        for (int si=0;si<inst.sample_count;si++)
+            Pin((const int16_t*)inst.samples[si].sample, pinned);
+    }
+
+    bool Evict(size_t size, bool useExtMem)
+    {
+        size_t freed = 0;
+        while (freed < size) {
+            Entry *lru = findLRU(false, useExtMem);
+            if (lru == nullptr) return false;
+            freed += lru->data.getSize();
+            evict(*lru);
+        }
+        return true;
+    }
+
+    void Flush()
+    {
+        for (int i=0;i<SF22ASWT_SAMPLE_CACHE_SIZE;i++)
+            if (entries[i].isEvictable()) remove(entries[i]);
+    }
+
+    void setBudget(size_t size, bool useExtMem) { budget[useExtMem?1:0] = size; }
+    size_t getBudget(bool useExtMem) { return budget[useExtMem?1:0]; }
+    size_t getAvailable(bool useExtMem)
+    {
+        int mt = useExtMem?1:0;
+        if (budget[mt] == 0) return SIZE_MAX;
+        return (usedRam[mt] < budget[mt]) ? (budget[mt] - usedRam[mt]) : 0;
+    }
+
+    int getRefCount(const int16_t *sample)
+    {
+        Entry *entry = find(sample);
+        return (entry != nullptr) ? entry->refCount : 0;
+    }
+
+    int getCount() { return count; }
+    size_t getUsedRam() { return usedRam[0] + usedRam[1]; }
+    size_t getUsedRam(bool useExtMem) { return usedRam[useExtMem?1:0]; }
+
+    uint32_t getHits() { return hits; }
+    uint32_t getMisses() { return misses; }
+    uint32_t getEvictions() { return evictions; }
+    void ResetCounters() { hits = 0; misses = 0; evictions = 0; }
+}
@@ -0,0 +1,88 @@
+/**
+ * reference counted sample data cache shared by all readers and instruments
+ *
+ * the samples are keyed by (file, sample start position in file, length), the file id of
+ * processed samples (resampled, sm24 merged or stereo downmix) also includes the options
+ * so that instruments that uses the same samples (i.e. GM fonts with layered
+ * pianos/strings and drum kits) shares the sample data, loading such a sample
+ * again don't use any file access or extra ram
+ *
+ * released samples (reference count 0) are kept in the cache, when a new sample
+ * don't fit in the ram budget the least recently used released samples are evicted,
+ * this makes frequent program changes between the same instruments fast
+ * samples that are pinned (i.e. a released instrument that can still be playing its release phase)
+ * are never evicted
+ *
+ * every sample is a own SamplePool so that it can be freed when no instrument uses it anymore
+ * used by ReaderBase::ReadSampleDataCached
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+#include "sf22aswt_structures.h"
+#include "sf22aswt_sample_pool.h"
+
+#ifndef SF22ASWT_SAMPLE_CACHE_SIZE
+/** max number of different samples in the cache */
+#define SF22ASWT_SAMPLE_CACHE_SIZE 256
+#endif
+
+namespace SF22ASWT::SampleCache
+{
+    /** identifies the sample data of a file */
+    uint32_t getFileId(const char *filePath, uint32_t fileSize);
+
+    /** returns the cached sample and increments the reference count, nullptr if not cached */
+    const int16_t* Acquire(uint32_t fileId, uint32_t sampleStart, uint32_t length);
+    /**
+     * adds a new sample with the reference count 1, the caller must then fill the data
+     * released samples are evicted when the sample don't fit in the budget or when the cache is full
+     * returns nullptr if out of memory or if nothing more can be evicted
+     */
+    int16_t* Insert(uint32_t fileId, uint32_t sampleStart, uint32_t length, size_t size, bool useExtMem);
+    /** decrements the reference count, when it reaches 0 the sample stays in the cache until evicted */
+    void Release(const int16_t *sample);
+    /** releases all samples of the instrument and sets the sample pointers to nullptr */
+    void Release(instrument_data_temp &inst);
+    /** releases all samples of the instrument, the instrument must not be played after this unless it's pinned */
+    void Release(const AudioSynthWavetable::instrument_data &inst);
+    /** releases the sample and frees it directly, used when the sample data could not be read */
+    void Discard(const int16_t *sample);
+
+    /** a pinned sample is never evicted, even when released, use it while a voice can still be playing the sample */
+    void Pin(const int16_t *sample, bool pinned);
+    void Pin(const AudioSynthWavetable::instrument_data &inst, bool pinned);
+
+    /**
+     * evicts least recently used released and not pinned samples until at least size bytes of the memory type are freed
+     * returns false if not enough could be freed
+     */
+    bool Evict(size_t size, bool useExtMem);
+    /** frees all released and not pinned samples */
+    void Flush();
+
+    /**
+     * max bytes of sample data in the cache for the memory type, 0 = no limit (default)
+     * note. the global limits (Samples_Max_Internal_RAM_Cap and the PSRAM size) are still used by ReadSampleDataCached
+     */
+    void setBudget(size_t size, bool useExtMem);
+    size_t getBudget(bool useExtMem);
+    /** bytes that can still be used before evicting, SIZE_MAX when there is no budget */
+    size_t getAvailable(bool useExtMem);
+
+    /** 0 if the sample is not in the cache or released */
+    int getRefCount(const int16_t *sample);
+    /** number of samples in the cache, including the released ones */
+    int getCount();
+    /** bytes used by the samples in the cache, including the released ones */
+    size_t getUsedRam();
+    size_t getUsedRam(bool useExtMem);
+
+    /** Acquire calls that found the sample */
+    uint32_t getHits();
+    /** Acquire calls that did not find the sample */
+    uint32_t getMisses();
+    /** released samples freed to make room for new ones */
+    uint32_t getEvictions();
+    void ResetCounters();
+}
@@ -0,0 +1,36 @@
+#include "sf22aswt_sample_pool.h"
+
+namespace SF22ASWT
+{
+    bool SamplePool::Alloc(size_t size, bool useExtMem)
+    {
+        Free();
+        // neither malloc nor extmem_malloc guarantee the alignment, so it's done here
+        size_t blockSize = size + SF22ASWT_SAMPLE_ALIGNMENT - 1;
+        block = useExtMem ? extmem_malloc(blockSize) : malloc(blockSize);
+        if (block == nullptr) return false;
+
+        data = (uint8_t*)alignSize((uintptr_t)block);
+        this->size = size;
+        this->useExtMem = useExtMem;
+        return true;
+    }
+
+    void SamplePool::Free()
+    {
+        if (block != nullptr) {
+            if (useExtMem) extmem_free(block);
+            else free(block);
+        }
+        block = nullptr;
+        data = nullptr;
+        size = 0;
+    }
+
+    void SamplePool::Swap(SamplePool &other)
+    {
+        SamplePool temp = *this;
+        *this = other;
+        other = temp;
+    }
+}
@@ -0,0 +1,53 @@
+/**
+ * a single allocation that holds the sample data of all samples of a instrument
+ *
+ * the samples are placed back to back, each one starting at a SF22ASWT_SAMPLE_ALIGNMENT boundary
+ * (the cache line size of the Cortex-M7), which is good for both the D-cache and PSRAM bursts
+ * freeing all samples of the instrument is then a single free
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+
+#ifndef SF22ASWT_SAMPLE_ALIGNMENT
+/** alignment in bytes of every sample in the pool, must be a power of 2 */
+#define SF22ASWT_SAMPLE_ALIGNMENT 32
+#endif
+
+namespace SF22ASWT
+{
+    class SamplePool
+    {
+      public:
+        static_assert((SF22ASWT_SAMPLE_ALIGNMENT & (SF22ASWT_SAMPLE_ALIGNMENT - 1)) == 0, "SF22ASWT_SAMPLE_ALIGNMENT must be a power of 2");
+
+        /** rounds size up to the sample alignment */
+        static constexpr size_t alignSize(size_t size) { return (size + SF22ASWT_SAMPLE_ALIGNMENT - 1) & ~(size_t)(SF22ASWT_SAMPLE_ALIGNMENT - 1); }
+
+        /**
+         * frees the previous pool and allocates a new one of size bytes (use alignSize on the size of every sample)
+         * returns false if out of memory
+         */
+        bool Alloc(size_t size, bool useExtMem);
+        /**
+         * frees all samples in O(1)
+         * note. this is not done by the destructor as the sample data can still be used by AudioSynthWavetable
+         */
+        void Free();
+
+        /** exchanges the allocations of the two pools */
+        void Swap(SamplePool &other);
+
+        /** aligned to SF22ASWT_SAMPLE_ALIGNMENT, nullptr when not allocated */
+        uint8_t* getData() { return data; }
+        size_t getSize() { return size; }
+        bool getUseExtMem() { return useExtMem; }
+
+      private:
+        /** the allocated block, data is aligned within it */
+        void *block = nullptr;
+        uint8_t *data = nullptr;
+        size_t size = 0;
+        bool useExtMem = false;
+    };
+}
@@ -0,0 +1,227 @@
+#include "sf22aswt_sample_stream.h"
+#include "sf22aswt_file_pool.h"
+
+namespace SF22ASWT
+{
+    extern int samples_usedRam;
+
+#pragma region StreamedInstrument
+    void StreamedInstrument::Free()
+    {
+        samples_usedRam -= resident.getSize();
+        resident.Free();
+        if (file != nullptr) FilePool::Release(file);
+        file = nullptr;
+        delete[] samples;
+        samples = nullptr;
+        delete[] sample_note_ranges;
+        sample_note_ranges = nullptr;
+        sample_count = 0;
+    }
+
+    bool StreamedInstrument::Init(const char *filePath, uint8_t sample_count)
+    {
+        Free();
+        // the file is kept open as long as the instrument is used
+        if ((file = FilePool::Acquire(filePath)) == nullptr) return false;
+        this->sample_count = sample_count;
+        samples = new streamed_sample[sample_count];
+        sample_note_ranges = new uint8_t[sample_count];
+        return true;
+    }
+
+    const streamed_sample* StreamedInstrument::getSample(int note) const
+    {
+        if (sample_count == 0) return nullptr;
+        int i = 0;
+        while (i < sample_count - 1 && note > sample_note_ranges[i]) i++;
+        return &samples[i];
+    }
+#pragma endregion
+
+#pragma region StreamVoice
+    void StreamVoice::setInstrument(const StreamedInstrument &instrument)
+    {
+        AudioNoInterrupts();
+        this->instrument = &instrument;
+        sample = nullptr;
+        playing = false;
+        AudioInterrupts();
+    }
+
+    void StreamVoice::playNote(int note, int velocity)
+    {
+        if (instrument == nullptr) return;
+        const streamed_sample *s = instrument->getSample(note);
+        if (s == nullptr || s->length == 0) return;
+
+        double increment = WAVETABLE_CENTS_SHIFT(s->CENTS_OFFSET) * s->SAMPLE_RATE / WAVETABLE_NOTE_TO_FREQUENCY(s->SAMPLE_NOTE) / AUDIO_SAMPLE_RATE_EXACT;
+        increment *= WAVETABLE_NOTE_TO_FREQUENCY(note);
+        double amplitude = WAVETABLE_DECIBEL_SHIFT(s->INIT_ATTENUATION) * velocity / 127.0;
+        double releaseSamples = s->RELEASE_ENV * AUDIO_SAMPLE_RATE_EXACT / 1000.0;
+
+        AudioNoInterrupts();
+        sample = s;
+        phase = 0;
+        phaseIncrement = (uint64_t)(increment * 4294967296.0);
+        gain = (int32_t)(amplitude * 65536.0);
+        releaseStep = (releaseSamples < 1.0) ? gain : (int32_t)(gain / releaseSamples) + 1;
+        writeIndex = s->headLength;
+        readIndex = s->headLength;
+        releasing = false;
+        playing = true;
+        AudioInterrupts();
+    }
+
+    void StreamVoice::stop()
+    {
+        releasing = true;
+    }
+
+    bool StreamVoice::fetch(uint32_t index, int16_t &value)
+    {
+        // the loop first, so that the interpolation at the loop end uses the start of the loop
+        if (sample->LOOP && index >= sample->loopStart && index <= sample->loopEnd) { value = sample->loopData[index - sample->loopStart]; return true; }
+        if (index < sample->headLength) { value = sample->head[index]; return true; }
+        if (index >= sample->streamEnd) { value = 0; return true; } // after the end of the sample
+        if (index < readIndex || index >= writeIndex) return false;
+        value = ring[index & RingMask];
+        return true;
+    }
+
+    void StreamVoice::render(int16_t *out, int count)
+    {
+        if (playing == false) { memset(out, 0, count*sizeof(int16_t)); return; }
+
+        bool underrun = false;
+        int i = 0;
+        for (;i<count;i++)
+        {
+            uint32_t index = (uint32_t)(phase >> 32);
+            if (sample->LOOP == false && index >= sample->length) { playing = false; break; }
+
+            int16_t a, b;
+            if (fetch(index, a) == false || fetch(index + 1, b) == false) {
+                underrun = true;
+                out[i] = 0;
+            }
+            else {
+                int32_t frac = (int32_t)((uint32_t)phase >> 17); // 15 bits so that it can't overflow
+                int32_t value = a + (((b - a) * frac) >> 15);
+                out[i] = (int16_t)((value * gain) >> 16);
+            }
+
+            if (releasing) {
+                gain -= releaseStep;
+                if (gain <= 0) { playing = false; i++; break; }
+            }
+            phase += phaseIncrement;
+            if (sample->LOOP && (uint32_t)(phase >> 32) >= sample->loopEnd)
+                phase -= (uint64_t)(sample->loopEnd - sample->loopStart) << 32;
+        }
+        if (i < count) memset(out + i, 0, (count - i)*sizeof(int16_t));
+        if (underrun) underruns++;
+
+        // the samples before the playhead are not needed anymore,
+        // after a underrun readIndex is ahead of writeIndex and the next Fill continues from the playhead
+        uint32_t index = (uint32_t)(phase >> 32);
+        if (index > sample->streamEnd) index = sample->streamEnd;
+        if (index > readIndex) readIndex = index;
+    }
+
+    void StreamVoice::update(void)
+    {
+        if (playing == false) return;
+        audio_block_t *block = allocate();
+        if (block == nullptr) return;
+        render(block->data, AUDIO_BLOCK_SAMPLES);
+        transmit(block);
+        release(block);
+    }
+
+    uint32_t StreamVoice::getBufferedAhead()
+    {
+        if (playing == false || writeIndex >= sample->streamEnd) return UINT32_MAX;
+        if (readIndex > writeIndex) return 0; // underrun, the playhead have passed the read data
+        if (writeIndex - readIndex >= SF22ASWT_STREAM_RING_SAMPLES) return UINT32_MAX; // full
+        uint32_t index = (uint32_t)(phase >> 32);
+        return (writeIndex > index) ? (writeIndex - index) : 0;
+    }
+
+    int StreamVoice::Fill(uint32_t maxSamples)
+    {
+        if (playing == false || sample == nullptr) return 0;
+        File *file = instrument->getFile();
+        if (file == nullptr) return 0;
+        // the pooled handle could have been closed after a error, then it's opened again
+        if (!*file && FilePool::Reopen(file) == false) return 0;
+
+        uint32_t write = writeIndex;
+        uint32_t first = readIndex;
+        // after a underrun the samples between writeIndex and the playhead would never be played, so they are skipped
+        if (first > write) write = first;
+        uint32_t count = SF22ASWT_STREAM_RING_SAMPLES - (write - first);
+        if (count > sample->streamEnd - write) count = sample->streamEnd - write;
+        if (count > maxSamples) count = maxSamples;
+        // only up to the end of the ring, the rest is done by the next call
+        if (count > SF22ASWT_STREAM_RING_SAMPLES - (write & RingMask)) count = SF22ASWT_STREAM_RING_SAMPLES - (write & RingMask);
+        if (count == 0) { writeIndex = write; return 0; }
+
+        // the file can be shared so the position must allways be set
+        if (file->seek(sample->sample_start + write*2) == false) return 0;
+        uint32_t read = file->read(&ring[write & RingMask], count*2) / 2;
+        writeIndex = write + read; // the data is in the ring before the audio interrupt can see it
+        return read;
+    }
+#pragma endregion
+
+#pragma region SampleStreamer
+    namespace SampleStreamer
+    {
+        static StreamVoice *voices[SF22ASWT_STREAM_VOICES];
+
+        bool AddVoice(StreamVoice &voice)
+        {
+            for (int i=0;i<SF22ASWT_STREAM_VOICES;i++)
+                if (voices[i] == &voice) return true;
+            for (int i=0;i<SF22ASWT_STREAM_VOICES;i++)
+                if (voices[i] == nullptr) { voices[i] = &voice; return true; }
+            return false;
+        }
+
+        void RemoveVoice(StreamVoice &voice)
+        {
+            for (int i=0;i<SF22ASWT_STREAM_VOICES;i++)
+                if (voices[i] == &voice) voices[i] = nullptr;
+        }
+
+        int Service(int maxReads)
+        {
+            int reads = 0;
+            while (reads < maxReads)
+            {
+                StreamVoice *next = nullptr;
+                uint32_t nextAhead = UINT32_MAX;
+                for (int i=0;i<SF22ASWT_STREAM_VOICES;i++)
+                {
+                    if (voices[i] == nullptr) continue;
+                    uint32_t ahead = voices[i]->getBufferedAhead();
+                    if (ahead < nextAhead) { next = voices[i]; nextAhead = ahead; }
+                }
+                if (next == nullptr) break;
+                if (next->Fill(SF22ASWT_STREAM_READ_SAMPLES) == 0) break;
+                reads++;
+            }
+            return reads;
+        }
+
+        uint32_t getUnderruns()
+        {
+            uint32_t total = 0;
+            for (int i=0;i<SF22ASWT_STREAM_VOICES;i++)
+                if (voices[i] != nullptr) total += voices[i]->getUnderruns();
+            return total;
+        }
+    }
+#pragma endregion
+}
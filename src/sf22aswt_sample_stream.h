@@ -0,0 +1,168 @@
+/**
+ * direct from disk streaming of long samples
+ *
+ * a streamed instrument (see ReaderBase::ReadSampleDataStreamed) only keeps the first
+ * SF22ASWT_STREAM_HEAD_MS of every sample and the loop region in ram, the rest is read
+ * from file into a ring buffer of the StreamVoice that plays the sample,
+ * ahead of the playhead, the head gives the time needed for the first reads
+ *
+ * the voices are filled by SampleStreamer::Service() that must be called often from loop()
+ * (file access is not possible from the audio interrupt), StreamVoice::update only reads
+ * the ring buffer, if the data is not there in time the output is silent (counted as underrun)
+ *
+ * StreamVoice is a simpler companion to AudioSynthWavetable: pitch, velocity, initial attenuation,
+ * the loop and the release time are used, the other envelopes and the LFOs are not
+ * it's used the same way as AudioSynthWavetable in WaveTableSynth (setInstrument, playNote, stop)
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+#include "sf22aswt_structures.h"
+#include "sf22aswt_sample_pool.h"
+#include "sf22aswt_buffered_file.h"
+
+#ifndef SF22ASWT_STREAM_HEAD_MS
+/** the length in ms of the start of every sample that is kept in ram */
+#define SF22ASWT_STREAM_HEAD_MS 150
+#endif
+
+#ifndef SF22ASWT_STREAM_RING_SAMPLES
+/** the size of the ring buffer of every StreamVoice in samples, must be a power of 2 */
+#define SF22ASWT_STREAM_RING_SAMPLES 8192
+#endif
+
+#ifndef SF22ASWT_STREAM_READ_SAMPLES
+/** the max number of samples read from file into a voice by every read in SampleStreamer::Service */
+#define SF22ASWT_STREAM_READ_SAMPLES 2048
+#endif
+
+#ifndef SF22ASWT_STREAM_VOICES
+/** max number of voices that can be added to the SampleStreamer */
+#define SF22ASWT_STREAM_VOICES 32
+#endif
+
+namespace SF22ASWT
+{
+    /** a sample of a streamed instrument, positions and lengths are in samples */
+    struct streamed_sample
+    {
+        /** the position of the first sample in the file */
+        uint32_t sample_start;
+        uint32_t length;
+        /** [0, headLength) is in ram */
+        uint32_t headLength;
+        const int16_t *head;
+        /** [headLength, streamEnd) is read from file while playing, streamEnd == headLength when nothing needs to be streamed */
+        uint32_t streamEnd;
+
+        bool LOOP;
+        /** the same loop points as used by AudioSynthWavetable */
+        uint32_t loopStart;
+        uint32_t loopEnd;
+        /** [loopStart, loopEnd] is in ram, the last sample is a copy of the first one for the interpolation */
+        const int16_t *loopData;
+
+        int SAMPLE_NOTE;
+        int CENTS_OFFSET;
+        float SAMPLE_RATE;
+        float INIT_ATTENUATION;
+        float RELEASE_ENV;
+    };
+
+    class StreamedInstrument
+    {
+      public:
+        uint8_t sample_count = 0;
+        uint8_t *sample_note_ranges = nullptr;
+        streamed_sample *samples = nullptr;
+
+        StreamedInstrument() {}
+        StreamedInstrument(const StreamedInstrument&) = delete;
+        StreamedInstrument& operator=(const StreamedInstrument&) = delete;
+        ~StreamedInstrument() { Free(); }
+
+        /** frees the resident sample data and closes the file, no voice must use the instrument after this */
+        void Free();
+        /** allocates the arrays and opens the file, used by ReaderBase::ReadSampleDataStreamed */
+        bool Init(const char *filePath, uint8_t sample_count);
+
+        /** the sample used for the note, the same as AudioSynthWavetable */
+        const streamed_sample* getSample(int note) const;
+        File* getFile() const { return file; }
+        SamplePool& getResident() { return resident; }
+
+      private:
+        File *file = nullptr;
+        SamplePool resident;
+    };
+
+    class StreamVoice : public AudioStream
+    {
+      public:
+        StreamVoice() : AudioStream(0, nullptr) {}
+
+        void setInstrument(const StreamedInstrument &instrument);
+        void playNote(int note, int velocity = 127);
+        /** starts the release phase */
+        void stop();
+        bool isPlaying() { return playing; }
+
+        /** the audio interrupt, renders from the resident data and the ring buffer */
+        void update(void) override;
+        /** renders count samples, used by update and for testing without the audio library */
+        void render(int16_t *out, int count);
+
+        /**
+         * reads the next part of the sample from file into the ring buffer, at most maxSamples
+         * returns the number of samples read, called by SampleStreamer::Service
+         */
+        int Fill(uint32_t maxSamples);
+        /** the number of samples in the ring buffer ahead of the playhead, UINT32_MAX when the ring buffer is full or nothing more needs to be read */
+        uint32_t getBufferedAhead();
+        /** blocks where a sample was not read from file in time */
+        uint32_t getUnderruns() { return underruns; }
+
+      private:
+        static_assert((SF22ASWT_STREAM_RING_SAMPLES & (SF22ASWT_STREAM_RING_SAMPLES - 1)) == 0, "SF22ASWT_STREAM_RING_SAMPLES must be a power of 2");
+        static const uint32_t RingMask = SF22ASWT_STREAM_RING_SAMPLES - 1;
+
+        const StreamedInstrument *instrument = nullptr;
+        const streamed_sample *sample = nullptr;
+        volatile bool playing = false;
+        volatile bool releasing = false;
+
+        /** 32.32 fixed point sample position */
+        uint64_t phase = 0;
+        uint64_t phaseIncrement = 0;
+        /** 16.16 fixed point */
+        int32_t gain = 0;
+        int32_t releaseStep = 0;
+
+        int16_t ring[SF22ASWT_STREAM_RING_SAMPLES] __attribute__((aligned(32)));
+        /**
+         * the ring buffer contains the samples [readIndex, writeIndex), writeIndex is only written by Fill, readIndex only by render (and playNote)
+         * readIndex follows the playhead (at most streamEnd), when it have passed writeIndex (a underrun) Fill moves writeIndex to it
+         */
+        volatile uint32_t writeIndex = 0;
+        volatile uint32_t readIndex = 0;
+        uint32_t underruns = 0;
+
+        bool fetch(uint32_t index, int16_t &value);
+    };
+
+    /** fills the ring buffers of the added voices */
+    namespace SampleStreamer
+    {
+        /** returns false if SF22ASWT_STREAM_VOICES voices are allready added */
+        bool AddVoice(StreamVoice &voice);
+        void RemoveVoice(StreamVoice &voice);
+        /**
+         * does at most maxReads file reads, each time into the voice with the least data buffered ahead of the playhead
+         * must be called from the same context as StreamVoice::playNote (i.e. loop())
+         * returns the number of reads done
+         */
+        int Service(int maxReads = 4);
+        /** the sum of the underruns of all added voices */
+        uint32_t getUnderruns();
+    }
+}
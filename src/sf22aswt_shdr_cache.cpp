@@ -0,0 +1,103 @@
+#include "sf22aswt_shdr_cache.h"
+
+namespace SF22ASWT
+{
+    void ShdrCache::Reset(uint32_t shdr_position, uint32_t shdr_count)
+    {
+        Free();
+        position = shdr_position;
+        count = shdr_count;
+        hits = 0;
+        misses = 0;
+    }
+
+    void ShdrCache::Free()
+    {
+        if (all != nullptr) {
+            if (allUseExtMem) extmem_free(all);
+            else free(all);
+        }
+        all = nullptr;
+        allTried = false;
+        delete[] blocks;
+        blocks = nullptr;
+        useCounter = 0;
+    }
+
+    bool ShdrCache::Get(File &file, uint32_t index, shdr_rec &shdr)
+    {
+        if (index >= count) return false;
+
+        if (all == nullptr && allTried == false)
+        {
+            allTried = true;
+            LoadAll(file); // the blocks are used if it fails
+        }
+        if (all != nullptr)
+        {
+            hits++;
+            shdr = all[index];
+            return true;
+        }
+        return GetFromBlocks(file, index, shdr);
+    }
+
+    bool ShdrCache::LoadAll(File &file)
+    {
+        size_t size = count*shdr_rec::Size;
+        allUseExtMem = (external_psram_size != 0);
+        if (allUseExtMem == false && size > SF22ASWT_SHDR_CACHE_MAX_INTERNAL_SIZE) return false;
+
+        all = (shdr_rec*)(allUseExtMem ? extmem_malloc(size) : malloc(size));
+        if (all == nullptr) return false; // use the blocks instead
+
+        misses++;
+        if (file.seek(position) == false || (size_t)file.read(all, size) != size)
+        {
+            if (allUseExtMem) extmem_free(all);
+            else free(all);
+            all = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    bool ShdrCache::GetFromBlocks(File &file, uint32_t index, shdr_rec &shdr)
+    {
+        uint32_t firstIndex = index - (index % SF22ASWT_SHDR_CACHE_BLOCK_RECORDS);
+        Block *block = nullptr;
+        if (SF22ASWT_SHDR_CACHE_BLOCKS != 0)
+        {
+            if (blocks == nullptr) blocks = new Block[SF22ASWT_SHDR_CACHE_BLOCKS];
+
+            for (int i=0;i<SF22ASWT_SHDR_CACHE_BLOCKS;i++)
+            {
+                if (blocks[i].firstIndex != firstIndex) continue;
+                hits++;
+                blocks[i].lastUse = ++useCounter;
+                shdr = blocks[i].records[index - firstIndex];
+                return true;
+            }
+            // replace the least recently used block
+            block = &blocks[0];
+            for (int i=1;i<SF22ASWT_SHDR_CACHE_BLOCKS;i++)
+                if (blocks[i].lastUse < block->lastUse) block = &blocks[i];
+        }
+        misses++;
+        if (block == nullptr) // no cache
+        {
+            if (file.seek(position + index*shdr_rec::Size) == false) return false;
+            return (size_t)file.read(&shdr, shdr_rec::Size) == shdr_rec::Size;
+        }
+
+        uint32_t recordCount = count - firstIndex;
+        if (recordCount > SF22ASWT_SHDR_CACHE_BLOCK_RECORDS) recordCount = SF22ASWT_SHDR_CACHE_BLOCK_RECORDS;
+        block->firstIndex = Block::Invalid;
+        if (file.seek(position + firstIndex*shdr_rec::Size) == false) return false;
+        if ((size_t)file.read(block->records, recordCount*shdr_rec::Size) != recordCount*shdr_rec::Size) return false;
+        block->firstIndex = firstIndex;
+        block->lastUse = ++useCounter;
+        shdr = block->records[index - firstIndex];
+        return true;
+    }
+}
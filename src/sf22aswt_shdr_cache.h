@@ -0,0 +1,80 @@
+/**
+ * sample header (shdr) cache used by the lazy reader
+ *
+ * the whole shdr chunk is read with a single read when it fits
+ * (always when PSRAM is available, otherwise when it's not larger than SF22ASWT_SHDR_CACHE_MAX_INTERNAL_SIZE)
+ * if not, a small LRU of shdr blocks is used instead, each block contains
+ * SF22ASWT_SHDR_CACHE_BLOCK_RECORDS records that are read with a single read
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+#include "sf22aswt_structures.h"
+#include "sf22aswt_buffered_file.h"
+
+#ifndef SF22ASWT_SHDR_CACHE_MAX_INTERNAL_SIZE
+/** max size in bytes of the whole shdr chunk when it's placed in internal ram */
+#define SF22ASWT_SHDR_CACHE_MAX_INTERNAL_SIZE 8192
+#endif
+
+#ifndef SF22ASWT_SHDR_CACHE_BLOCKS
+/** number of LRU blocks used when the whole shdr chunk don't fit, 0 = no cache in that case */
+#define SF22ASWT_SHDR_CACHE_BLOCKS 4
+#endif
+
+#ifndef SF22ASWT_SHDR_CACHE_BLOCK_RECORDS
+/** number of shdr records in each LRU block */
+#define SF22ASWT_SHDR_CACHE_BLOCK_RECORDS 16
+#endif
+
+namespace SF22ASWT
+{
+    class ShdrCache
+    {
+      public:
+        ShdrCache() = default;
+        ShdrCache(const ShdrCache&) = delete;
+        ShdrCache& operator=(const ShdrCache&) = delete;
+        ~ShdrCache() { Free(); }
+
+        /** frees the cache and sets the location of the shdr chunk, the cache is then filled on demand */
+        void Reset(uint32_t shdr_position, uint32_t shdr_count);
+        void Free();
+        /**
+         * gets the sample header at index, reading it from file when it's not cached
+         * returns false if index is out of range or on file errors
+         * note. the file is not closed on errors
+        */
+        bool Get(File &file, uint32_t index, shdr_rec &shdr);
+
+        /** true when the whole shdr chunk is in ram */
+        bool isFullyLoaded() { return all != nullptr; }
+        uint32_t getHits() { return hits; }
+        uint32_t getMisses() { return misses; }
+
+      private:
+        struct Block
+        {
+            static const uint32_t Invalid = 0xFFFFFFFF;
+            uint32_t firstIndex = Invalid;
+            uint32_t lastUse = 0;
+            shdr_rec records[SF22ASWT_SHDR_CACHE_BLOCK_RECORDS];
+        };
+
+        uint32_t position = 0;
+        uint32_t count = 0;
+        /** the whole chunk */
+        shdr_rec *all = nullptr;
+        bool allUseExtMem = false;
+        /** set when loading the whole chunk was tried so that it's only tried once */
+        bool allTried = false;
+        Block *blocks = nullptr;
+        uint32_t useCounter = 0;
+
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+
+        bool LoadAll(File &file);
+        bool GetFromBlocks(File &file, uint32_t index, shdr_rec &shdr);
+    };
+}
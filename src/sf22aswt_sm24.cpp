@@ -0,0 +1,134 @@
+#include "sf22aswt_sm24.h"
+#include <string.h>
+
+#if !defined(SF22ASWT_SM24_NO_SIMD)
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SF22ASWT_SM24_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SF22ASWT_SM24_SSE2
+#elif defined(__ARM_FEATURE_DSP)
+#define SF22ASWT_SM24_ARM_DSP
+#endif
+#endif
+
+namespace SF22ASWT::Sm24
+{
+    /**
+     * every group of 8 samples uses the 16 random bytes of the 4 lanes,
+     * sample k takes byte 2k and 2k+1, after the group all lanes are stepped
+     */
+    static inline void step(Dither &dither)
+    {
+        for (int i=0;i<4;i++)
+        {
+            uint32_t x = dither.state[i];
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            dither.state[i] = x;
+        }
+    }
+
+    /**
+     * the 24 bit value (hi << 8 | lo) plus the dither (r1 + r2 - 255) rounded to 16 bit,
+     * the biased sum lo + r1 + r2 + 129 is allways positive so that all versions can use a unsigned shift
+     */
+    static inline int16_t mergeSample(int16_t hi, uint8_t lo, uint16_t random)
+    {
+        int32_t adj = ((lo + (random & 0xFF) + (random >> 8) + 129) >> 8) - 1;
+        int32_t out = hi + adj;
+        if (out > 32767) out = 32767;
+        else if (out < -32768) out = -32768;
+        return (int16_t)out;
+    }
+
+    /** the rest that is not a full group of 8 */
+    static void mergeTail(int16_t *samples, const uint8_t *low, size_t count, Dither &dither)
+    {
+        for (size_t k=0;k<count;k++)
+        {
+            uint32_t lane = dither.state[k / 2];
+            samples[k] = mergeSample(samples[k], low[k], (k & 1) ? (lane >> 16) : (lane & 0xFFFF));
+        }
+        step(dither);
+    }
+
+    void Merge(int16_t *samples, const uint8_t *low, size_t count, Dither &dither)
+    {
+        size_t groups = count / 8;
+#if defined(SF22ASWT_SM24_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i lowMask = _mm_set1_epi16(0x00FF);
+        const __m128i bias = _mm_set1_epi16(129);
+        const __m128i one = _mm_set1_epi16(1);
+        __m128i state = _mm_loadu_si128((const __m128i*)dither.state);
+        for (size_t g=0;g<groups;g++)
+        {
+            __m128i hi = _mm_loadu_si128((const __m128i*)samples);
+            __m128i lo = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)low), zero);
+            __m128i t = _mm_add_epi16(_mm_add_epi16(lo, bias), _mm_add_epi16(_mm_and_si128(state, lowMask), _mm_srli_epi16(state, 8)));
+            __m128i adj = _mm_sub_epi16(_mm_srli_epi16(t, 8), one);
+            _mm_storeu_si128((__m128i*)samples, _mm_adds_epi16(hi, adj));
+            state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+            state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+            state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+            samples += 8;
+            low += 8;
+        }
+        _mm_storeu_si128((__m128i*)dither.state, state);
+#elif defined(SF22ASWT_SM24_NEON)
+        const uint16x8_t lowMask = vdupq_n_u16(0x00FF);
+        const uint16x8_t bias = vdupq_n_u16(129);
+        const int16x8_t one = vdupq_n_s16(1);
+        uint32x4_t state = vld1q_u32(dither.state);
+        for (size_t g=0;g<groups;g++)
+        {
+            int16x8_t hi = vld1q_s16(samples);
+            uint16x8_t lo = vmovl_u8(vld1_u8(low));
+            uint16x8_t random = vreinterpretq_u16_u32(state);
+            uint16x8_t t = vaddq_u16(vaddq_u16(lo, bias), vaddq_u16(vandq_u16(random, lowMask), vshrq_n_u16(random, 8)));
+            int16x8_t adj = vsubq_s16(vreinterpretq_s16_u16(vshrq_n_u16(t, 8)), one);
+            vst1q_s16(samples, vqaddq_s16(hi, adj));
+            state = veorq_u32(state, vshlq_n_u32(state, 13));
+            state = veorq_u32(state, vshrq_n_u32(state, 17));
+            state = veorq_u32(state, vshlq_n_u32(state, 5));
+            samples += 8;
+            low += 8;
+        }
+        vst1q_u32(dither.state, state);
+#elif defined(SF22ASWT_SM24_ARM_DSP)
+        // two samples per 32 bit word, every halfword of the biased sum is < 65536 so a normal add don't carry over
+        for (size_t g=0;g<groups;g++)
+        {
+            uint32_t lows[2];
+            memcpy(lows, low, 8);
+            for (int p=0;p<4;p++)
+            {
+                uint32_t l = lows[p / 2] >> ((p & 1) * 16);
+                uint32_t loPair = (l & 0xFF) | ((l & 0xFF00) << 8);
+                uint32_t random = dither.state[p];
+                uint32_t t = loPair + (random & 0x00FF00FF) + ((random >> 8) & 0x00FF00FF) + 0x00810081;
+                int32_t adj = (t >> 8) & 0x00FF00FF;
+                int32_t hi, out;
+                memcpy(&hi, samples + p*2, 4);
+                asm ("ssub16 %0, %1, %2" : "=r" (adj) : "r" (adj), "r" (0x00010001));
+                asm ("qadd16 %0, %1, %2" : "=r" (out) : "r" (hi), "r" (adj));
+                memcpy(samples + p*2, &out, 4);
+            }
+            step(dither);
+            samples += 8;
+            low += 8;
+        }
+#else
+        for (size_t g=0;g<groups;g++)
+        {
+            mergeTail(samples, low, 8, dither);
+            samples += 8;
+            low += 8;
+        }
+#endif
+        if (count % 8 != 0) mergeTail(samples, low, count % 8, dither);
+    }
+}
@@ -0,0 +1,36 @@
+/**
+ * merges the 16 bit samples (smpl) with the extra low bytes of 24 bit fonts (sm24)
+ * and dithers the 24 bit result back to the 16 bit that AudioSynthWavetable plays
+ *
+ * the dither is TPDF (the sum of two random bytes, +-1 LSB) from a xorshift generator,
+ * the kernel uses the DSP instructions on Teensy (qadd16/ssub16) and SSE2/NEON on a host,
+ * all versions gives the same result (the portable one can be forced with SF22ASWT_SM24_NO_SIMD)
+ *
+ * it has no Arduino dependencies so that it can be tested on a host
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef SF22ASWT_SM24_CHUNK_SAMPLES
+/** samples merged at a time while loading, the sm24 bytes are read into a stack buffer of this size, must be a multiple of 8 */
+#define SF22ASWT_SM24_CHUNK_SAMPLES 1024
+#endif
+
+namespace SF22ASWT::Sm24
+{
+    static_assert(SF22ASWT_SM24_CHUNK_SAMPLES % 8 == 0, "SF22ASWT_SM24_CHUNK_SAMPLES must be a multiple of 8");
+
+    /** the state of the dither generator, four xorshift32 lanes that each gives the random bytes for two samples */
+    struct Dither
+    {
+        uint32_t state[4] = { 0x9E3779B9, 0x7F4A7C15, 0x85EBCA6B, 0xC2B2AE35 };
+    };
+
+    /**
+     * samples holds the high 16 bits (the smpl data) and is replaced with the dithered result,
+     * low is the sm24 byte of each sample
+     */
+    void Merge(int16_t *samples, const uint8_t *low, size_t count, Dither &dither);
+}
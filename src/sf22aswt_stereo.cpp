@@ -0,0 +1,46 @@
+#include "sf22aswt_stereo.h"
+#include <string.h>
+
+#if !defined(SF22ASWT_STEREO_NO_SIMD)
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SF22ASWT_STEREO_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SF22ASWT_STEREO_SSE2
+#elif defined(__ARM_FEATURE_DSP)
+#define SF22ASWT_STEREO_ARM_DSP
+#endif
+#endif
+
+namespace SF22ASWT::Stereo
+{
+    void Downmix(int16_t *left, const int16_t *right, size_t count)
+    {
+        size_t i = 0;
+#if defined(SF22ASWT_STEREO_SSE2)
+        // (a & b) + ((a ^ b) >> 1) is the halving add without overflow
+        for (;i+8<=count;i+=8)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i*)(left + i));
+            __m128i b = _mm_loadu_si128((const __m128i*)(right + i));
+            __m128i mix = _mm_add_epi16(_mm_and_si128(a, b), _mm_srai_epi16(_mm_xor_si128(a, b), 1));
+            _mm_storeu_si128((__m128i*)(left + i), mix);
+        }
+#elif defined(SF22ASWT_STEREO_NEON)
+        for (;i+8<=count;i+=8)
+            vst1q_s16(left + i, vhaddq_s16(vld1q_s16(left + i), vld1q_s16(right + i)));
+#elif defined(SF22ASWT_STEREO_ARM_DSP)
+        for (;i+2<=count;i+=2)
+        {
+            int32_t a, b, mix;
+            memcpy(&a, left + i, 4);
+            memcpy(&b, right + i, 4);
+            asm ("shadd16 %0, %1, %2" : "=r" (mix) : "r" (a), "r" (b));
+            memcpy(left + i, &mix, 4);
+        }
+#endif
+        for (;i<count;i++)
+            left[i] = (int16_t)((left[i] + right[i]) >> 1);
+    }
+}
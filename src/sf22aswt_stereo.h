@@ -0,0 +1,23 @@
+/**
+ * mono downmix of the two channels of a stereo sample pair (see ReaderBase::setStereoDownmix)
+ *
+ * the kernel uses the DSP instructions on Teensy (shadd16) and SSE2/NEON on a host,
+ * all versions gives the same result (the portable one can be forced with SF22ASWT_STEREO_NO_SIMD)
+ *
+ * it has no Arduino dependencies so that it can be tested on a host
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef SF22ASWT_STEREO_CHUNK_SAMPLES
+/** samples of the other channel read at a time while loading, into a stack buffer of 2x this in bytes */
+#define SF22ASWT_STEREO_CHUNK_SAMPLES 512
+#endif
+
+namespace SF22ASWT::Stereo
+{
+    /** left is replaced with (left + right) / 2 (rounded down) */
+    void Downmix(int16_t *left, const int16_t *right, size_t count);
+}
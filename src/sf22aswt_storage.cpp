@@ -0,0 +1,241 @@
+#include "sf22aswt_storage.h"
+
+// the SD backend is fully inlined in sf22aswt_storage.h
+#if !defined(SF22ASWT_STORAGE_SD)
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#if defined(SF22ASWT_STORAGE_MMAP)
+#include <sys/mman.h>
+#endif
+#include <time.h>
+
+namespace SF22ASWT::Storage
+{
+#if defined(SF22ASWT_STORAGE_POSIX) || defined(SF22ASWT_STORAGE_MMAP)
+    static uint32_t PackModifyTime(time_t mtime)
+    {
+        struct tm tm;
+        if (localtime_r(&mtime, &tm) == nullptr) return 0;
+        return ((uint32_t)(tm.tm_year - 80) << 25) | ((uint32_t)(tm.tm_mon + 1) << 21) | ((uint32_t)tm.tm_mday << 16) |
+               ((uint32_t)tm.tm_hour << 11) | ((uint32_t)tm.tm_min << 5) | (tm.tm_sec >> 1);
+    }
+#endif
+
+#pragma region PosixFile
+    PosixFile& PosixFile::operator=(PosixFile &&other)
+    {
+        if (this == &other) return *this;
+        close();
+        fd = other.fd;
+        pos = other.pos;
+        fileSize = other.fileSize;
+        other.fd = -1;
+        other.pos = 0;
+        other.fileSize = 0;
+        return *this;
+    }
+
+    int PosixFile::read(void *buf, size_t nbyte)
+    {
+        if (fd < 0) return -1;
+        size_t total = 0;
+        while (total < nbyte)
+        {
+            ssize_t n = ::pread(fd, (uint8_t*)buf + total, nbyte - total, pos);
+            if (n <= 0) break;
+            pos += n;
+            total += n;
+        }
+#if SF22ASWT_STORAGE_SIMULATED_LATENCY_US > 0
+        uint64_t us = SF22ASWT_STORAGE_SIMULATED_LATENCY_US;
+#if SF22ASWT_STORAGE_SIMULATED_KB_PER_SEC > 0
+        us += (uint64_t)total * 1000000 / ((uint64_t)SF22ASWT_STORAGE_SIMULATED_KB_PER_SEC * 1024);
+#endif
+        ::usleep(us);
+#endif
+        return (int)total;
+    }
+
+    size_t PosixFile::write(const uint8_t *buf, size_t size)
+    {
+        if (fd < 0) return 0;
+        size_t total = 0;
+        while (total < size)
+        {
+            ssize_t n = ::pwrite(fd, buf + total, size - total, pos);
+            if (n <= 0) break;
+            pos += n;
+            total += n;
+        }
+        if (pos > fileSize) fileSize = pos;
+        return total;
+    }
+
+    bool PosixFile::seek(uint64_t pos, int mode)
+    {
+        if (fd < 0) return false;
+        int64_t newPos = (int64_t)pos;
+        if (mode == SeekCur) newPos = (int64_t)this->pos + (int64_t)pos;
+        else if (mode == SeekEnd) newPos = (int64_t)fileSize + (int64_t)pos;
+        // same as SD, seeking past the end is not allowed for read only use
+        if (newPos < 0 || (uint64_t)newPos > fileSize) return false;
+        this->pos = newPos;
+        return true;
+    }
+
+    void PosixFile::close()
+    {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+#pragma endregion
+
+#if defined(SF22ASWT_STORAGE_POSIX)
+    File Open(const char *path)
+    {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return File();
+        struct stat st;
+        if (fstat(fd, &st) != 0 || S_ISDIR(st.st_mode)) { ::close(fd); return File(); }
+        return File(fd, st.st_size);
+    }
+
+#elif defined(SF22ASWT_STORAGE_MMAP)
+#pragma region MmapFile
+    MmapFile& MmapFile::operator=(MmapFile &&other)
+    {
+        if (this == &other) return *this;
+        close();
+        PosixFile::operator=(static_cast<PosixFile&&>(other));
+        map = other.map;
+        other.map = nullptr;
+        return *this;
+    }
+
+    int MmapFile::read(void *buf, size_t nbyte)
+    {
+        if (map == nullptr) return PosixFile::read(buf, nbyte);
+        if (pos >= fileSize) return 0;
+        if (nbyte > fileSize - pos) nbyte = fileSize - pos;
+        memcpy(buf, map + pos, nbyte);
+        pos += nbyte;
+        return (int)nbyte;
+    }
+
+    void MmapFile::close()
+    {
+        if (map != nullptr) munmap((void*)map, fileSize);
+        map = nullptr;
+        PosixFile::close();
+    }
+#pragma endregion
+
+    File Open(const char *path)
+    {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return File();
+        struct stat st;
+        if (fstat(fd, &st) != 0 || S_ISDIR(st.st_mode) || st.st_size == 0) { ::close(fd); return File(); }
+        void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) { ::close(fd); return File(); }
+        // the readers mostly walks the file forward
+        madvise(map, st.st_size, MADV_SEQUENTIAL);
+        return File(fd, st.st_size, (const uint8_t*)map);
+    }
+
+#elif defined(SF22ASWT_STORAGE_MEMORY)
+#pragma region MemoryFile
+    struct MemoryImage
+    {
+        const char *path = nullptr;
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+    };
+    static MemoryImage memoryImages[SF22ASWT_STORAGE_MEMORY_IMAGES];
+
+    bool AttachMemoryImage(const char *path, const uint8_t *data, size_t size)
+    {
+        DetachMemoryImage(path);
+        for (int i=0;i<SF22ASWT_STORAGE_MEMORY_IMAGES;i++)
+        {
+            if (memoryImages[i].path != nullptr) continue;
+            memoryImages[i].path = path;
+            memoryImages[i].data = data;
+            memoryImages[i].size = size;
+            return true;
+        }
+        return false;
+    }
+
+    void DetachMemoryImage(const char *path)
+    {
+        for (int i=0;i<SF22ASWT_STORAGE_MEMORY_IMAGES;i++)
+        {
+            if (memoryImages[i].path != nullptr && strcmp(memoryImages[i].path, path) == 0)
+                memoryImages[i] = MemoryImage();
+        }
+    }
+
+    int MemoryFile::read(void *buf, size_t nbyte)
+    {
+        if (map == nullptr) return -1;
+        if (pos >= fileSize) return 0;
+        if (nbyte > fileSize - pos) nbyte = fileSize - pos;
+        memcpy(buf, map + pos, nbyte);
+        pos += nbyte;
+        return (int)nbyte;
+    }
+
+    bool MemoryFile::seek(uint64_t pos, int mode)
+    {
+        if (map == nullptr) return false;
+        int64_t newPos = (int64_t)pos;
+        if (mode == SeekCur) newPos = (int64_t)this->pos + (int64_t)pos;
+        else if (mode == SeekEnd) newPos = (int64_t)fileSize + (int64_t)pos;
+        if (newPos < 0 || (uint64_t)newPos > fileSize) return false;
+        this->pos = newPos;
+        return true;
+    }
+#pragma endregion
+
+    File Open(const char *path)
+    {
+        for (int i=0;i<SF22ASWT_STORAGE_MEMORY_IMAGES;i++)
+        {
+            if (memoryImages[i].path != nullptr && strcmp(memoryImages[i].path, path) == 0)
+                return File(memoryImages[i].data, memoryImages[i].size);
+        }
+        return File();
+    }
+
+    // memory images are read only
+    File OpenWrite(const char *) { return File(); }
+    bool Remove(const char *) { return false; }
+    uint32_t ModifyTime(File &) { return 0; }
+#endif
+
+#if defined(SF22ASWT_STORAGE_POSIX) || defined(SF22ASWT_STORAGE_MMAP)
+    File OpenWrite(const char *path)
+    {
+        int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return File();
+        return File(fd, 0);
+    }
+
+    bool Remove(const char *path)
+    {
+        return ::unlink(path) == 0;
+    }
+
+    uint32_t ModifyTime(File &file)
+    {
+        struct stat st;
+        if (!file || fstat(file.getFd(), &st) != 0) return 0;
+        return PackModifyTime(st.st_mtime);
+    }
+#endif
+}
+
+#endif
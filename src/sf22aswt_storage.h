@@ -0,0 +1,188 @@
+/**
+ * storage backend used by the readers, selected at compile time
+ * by defining one of the following (as a build flag so that all files use the same):
+ *
+ * SF22ASWT_STORAGE_SD     (default) Arduino SD library, File is the normal Arduino File
+ * SF22ASWT_STORAGE_POSIX  (default on a host) POSIX file using pread, for running on a host (linux/mac)
+ * SF22ASWT_STORAGE_MMAP   read only memory mapped file, for running on a host (linux/mac)
+ * SF22ASWT_STORAGE_MEMORY caller supplied memory images, see Storage::AttachMemoryImage
+ *
+ * all backends have the same interface as the Arduino File functions used by the readers:
+ * read, readBytes, write, seek, position, size, available, close and operator bool
+ * so when using SD there is no extra cost as Storage::File is the Arduino File
+ * the readers use SF22ASWT::File (see sf22aswt_buffered_file.h) which adds a read buffer on top
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+
+#if !defined(SF22ASWT_STORAGE_SD) && !defined(SF22ASWT_STORAGE_POSIX) && !defined(SF22ASWT_STORAGE_MMAP) && !defined(SF22ASWT_STORAGE_MEMORY)
+#if defined(ARDUINO)
+#define SF22ASWT_STORAGE_SD
+#else
+#define SF22ASWT_STORAGE_POSIX
+#endif
+#endif
+
+#if defined(SF22ASWT_STORAGE_SD)
+#include <SD.h>
+#elif __has_include(<FS.h>)
+#include <FS.h>
+#else
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+#endif
+
+#ifndef SF22ASWT_STORAGE_SIMULATED_LATENCY_US
+/**
+ * POSIX backend only, every read waits this many microseconds before returning (0 = disabled)
+ * used to simulate the access time of a SD card when testing on a host (i.e. the sample streaming)
+ */
+#define SF22ASWT_STORAGE_SIMULATED_LATENCY_US 0
+#endif
+
+#ifndef SF22ASWT_STORAGE_SIMULATED_KB_PER_SEC
+/** POSIX backend only, when set (and the latency is enabled) the reads are also limited to this speed */
+#define SF22ASWT_STORAGE_SIMULATED_KB_PER_SEC 0
+#endif
+
+#ifndef SF22ASWT_STORAGE_MEMORY_IMAGES
+/** max number of memory images that can be attached at the same time */
+#define SF22ASWT_STORAGE_MEMORY_IMAGES 4
+#endif
+
+namespace SF22ASWT::Storage
+{
+#if defined(SF22ASWT_STORAGE_SD)
+
+    typedef ::File File;
+
+    inline File Open(const char *path) { return SD.open(path); }
+    /** creates the file, or truncates it if it allready exists */
+    inline File OpenWrite(const char *path) {
+        SD.remove(path); // FILE_WRITE appends to existing files
+        return SD.open(path, FILE_WRITE);
+    }
+    inline bool Remove(const char *path) { return SD.remove(path); }
+    /** returns the packed (FAT style) modify time, or 0 if not available */
+    inline uint32_t ModifyTime(File &file) {
+        DateTimeFields tm;
+        if (file.getModifyTime(tm) == false) return 0;
+        return ((uint32_t)(tm.year - 80) << 25) | ((uint32_t)(tm.mon + 1) << 21) | ((uint32_t)tm.mday << 16) |
+               ((uint32_t)tm.hour << 11) | ((uint32_t)tm.min << 5) | (tm.sec >> 1);
+    }
+
+#else
+
+    /**
+     * base for the host backends, uses a POSIX file descriptor
+     * and keeps track of the position so that pread/pwrite can be used
+    */
+    class PosixFile
+    {
+      public:
+        PosixFile() {}
+        PosixFile(int fd, uint64_t size) : fd(fd), fileSize(size) {}
+        PosixFile(PosixFile &&other) { *this = static_cast<PosixFile&&>(other); }
+        PosixFile& operator=(PosixFile &&other);
+        PosixFile(const PosixFile&) = delete;
+        PosixFile& operator=(const PosixFile&) = delete;
+        ~PosixFile() { close(); }
+
+        int read(void *buf, size_t nbyte);
+        size_t readBytes(char *buffer, size_t length) { int n = read(buffer, length); return (n < 0) ? 0 : n; }
+        size_t write(const uint8_t *buf, size_t size);
+        bool seek(uint64_t pos, int mode = SeekSet);
+        uint64_t position() { return pos; }
+        uint64_t size() { return fileSize; }
+        int available() { return (pos >= fileSize) ? 0 : (((fileSize - pos) > 0x7FFFFFFF) ? 0x7FFFFFFF : (int)(fileSize - pos)); }
+        void close();
+        operator bool() const { return fd >= 0; }
+        int getFd() { return fd; }
+
+      protected:
+        int fd = -1;
+        uint64_t pos = 0;
+        uint64_t fileSize = 0;
+    };
+
+#if defined(SF22ASWT_STORAGE_POSIX)
+
+    typedef PosixFile File;
+
+#elif defined(SF22ASWT_STORAGE_MMAP)
+
+    /**
+     * the whole file is mapped read only, reads are plain memory copies,
+     * files opened with OpenWrite are not mapped and uses the PosixFile functions
+    */
+    class MmapFile : public PosixFile
+    {
+      public:
+        MmapFile() {}
+        MmapFile(int fd, uint64_t size, const uint8_t *map = nullptr) : PosixFile(fd, size), map(map) {}
+        MmapFile(MmapFile &&other) { *this = static_cast<MmapFile&&>(other); }
+        MmapFile& operator=(MmapFile &&other);
+        ~MmapFile() { close(); }
+
+        int read(void *buf, size_t nbyte);
+        size_t readBytes(char *buffer, size_t length) { int n = read(buffer, length); return (n < 0) ? 0 : n; }
+        void close();
+        /** direct access to the mapped file, nullptr if not mapped */
+        const uint8_t* data() { return map; }
+
+      private:
+        const uint8_t *map = nullptr;
+    };
+    typedef MmapFile File;
+
+#elif defined(SF22ASWT_STORAGE_MEMORY)
+
+    /** read only view of a memory image attached with AttachMemoryImage */
+    class MemoryFile
+    {
+      public:
+        MemoryFile() {}
+        MemoryFile(const uint8_t *data, size_t size) : map(data), fileSize(size) {}
+
+        int read(void *buf, size_t nbyte);
+        size_t readBytes(char *buffer, size_t length) { return read(buffer, length); }
+        size_t write(const uint8_t *, size_t) { return 0; } // read only
+        bool seek(uint64_t pos, int mode = SeekSet);
+        uint64_t position() { return pos; }
+        uint64_t size() { return fileSize; }
+        int available() { return (pos >= fileSize) ? 0 : (int)(fileSize - pos); }
+        void close() { map = nullptr; }
+        operator bool() const { return map != nullptr; }
+        /** direct access to the memory image */
+        const uint8_t* data() { return map; }
+
+      private:
+        const uint8_t *map = nullptr;
+        size_t fileSize = 0;
+        size_t pos = 0;
+    };
+    typedef MemoryFile File;
+
+    /**
+     * makes a memory image available to Open using path,
+     * the data is not copied so it must be valid as long as it's used
+     * returns false if all SF22ASWT_STORAGE_MEMORY_IMAGES slots are in use
+    */
+    bool AttachMemoryImage(const char *path, const uint8_t *data, size_t size);
+    void DetachMemoryImage(const char *path);
+
+#endif
+
+    File Open(const char *path);
+    /** creates the file, or truncates it if it allready exists */
+    File OpenWrite(const char *path);
+    bool Remove(const char *path);
+    /** returns the packed (FAT style) modify time, or 0 if not available */
+    uint32_t ModifyTime(File &file);
+
+#endif
+}
@@ -1,6 +1,5 @@
 
 #include "sf22aswt_structures.h"
-#include "Print.h"
 
 namespace SF22ASWT
 {
@@ -77,17 +76,67 @@ namespace SF22ASWT
         stream.print("Tools: "); stream.println(ISFT);
     }
 
-    pdta_rec::pdta_rec()
+    pdta_rec::~pdta_rec()
     {
-        phdr = new phdr_rec[0];
-        pbag = new bag_rec[0];
-        pmod = new mod_rec[0];
-        pgen = new gen_rec[0];
-        inst = new inst_rec[0];
-        ibag = new bag_rec[0];
-        imod = new mod_rec[0];
-        igen = new gen_rec[0];
-        shdr = new shdr_rec[0];
+        Free();
+    }
+
+    void* pdta_rec::Allocate(size_t size)
+    {
+        if (useExtMem) return extmem_malloc(size);
+        return malloc(size);
+    }
+
+    template<typename T>
+    static void pdta_rec_free(T *&records, uint32_t &count, bool useExtMem)
+    {
+        if (records != nullptr)
+        {
+            if (useExtMem) extmem_free(records);
+            else free(records);
+        }
+        records = nullptr;
+        count = 0;
+    }
+
+    void pdta_rec::Free()
+    {
+        pdta_rec_free(phdr, phdr_count, useExtMem);
+        pdta_rec_free(pbag, pbag_count, useExtMem);
+        pdta_rec_free(pmod, pmod_count, useExtMem);
+        pdta_rec_free(pgen, pgen_count, useExtMem);
+        pdta_rec_free(inst, inst_count, useExtMem);
+        pdta_rec_free(ibag, ibag_count, useExtMem);
+        pdta_rec_free(imod, imod_count, useExtMem);
+        pdta_rec_free(igen, igen_count, useExtMem);
+        pdta_rec_free(shdr, shdr_count, useExtMem);
+        size = 0;
+    }
+
+    template<typename T>
+    static void pdta_rec_clone(pdta_rec &other, T *records, uint32_t count, T *&other_records, uint32_t &other_count)
+    {
+        other_count = count;
+        if (records == nullptr || count == 0) return;
+        other_records = (T*)other.Allocate(count*sizeof(T));
+        if (other_records == nullptr) { other_count = 0; return; }
+        memcpy(other_records, records, count*sizeof(T));
+    }
+
+    void pdta_rec::CloneInto(pdta_rec &other)
+    {
+        other.Free();
+        other.size = size;
+        other.useExtMem = useExtMem;
+        pdta_rec_clone(other, phdr, phdr_count, other.phdr, other.phdr_count);
+        pdta_rec_clone(other, pbag, pbag_count, other.pbag, other.pbag_count);
+        pdta_rec_clone(other, pmod, pmod_count, other.pmod, other.pmod_count);
+        pdta_rec_clone(other, pgen, pgen_count, other.pgen, other.pgen_count);
+        pdta_rec_clone(other, inst, inst_count, other.inst, other.inst_count);
+        pdta_rec_clone(other, ibag, ibag_count, other.ibag, other.ibag_count);
+        pdta_rec_clone(other, imod, imod_count, other.imod, other.imod_count);
+        pdta_rec_clone(other, igen, igen_count, other.igen, other.igen_count);
+        pdta_rec_clone(other, shdr, shdr_count, other.shdr, other.shdr_count);
     }
 
     void pdta_rec_lazy::CloneInto(pdta_rec_lazy &other)
@@ -1,7 +1,7 @@
 
 #pragma once
 
-#include <Arduino.h>
+#include "sf22aswt_platform.h"
 #include "sf22aswt_enums.h"
 
 
@@ -13,17 +13,6 @@
 
 namespace SF22ASWT
 {
-    /** make it easier to manage sample datas
-     * TODO. store all samples in a memory pool/continuous array
-    */
-    class sample_data
-    {
-      public:
-        /** array of sample data*/
-        uint32_t *data = nullptr;
-        int dataSize;
-    };
-
     struct sample_header { // rename it to sample_header instead of sample_data
         // SAMPLE VALUES
         const int16_t* sample;
@@ -72,6 +61,12 @@ namespace SF22ASWT
         uint32_t sample_start;
         /** pointer to sample data when loaded into ram*/
         const int16_t* sample;
+        /** the sample id, the linked sample id and the type from the sample header, used to pair stereo samples */
+        uint16_t sample_id;
+        uint16_t sample_link;
+        SFSampleLink sample_type;
+        /** when the zone is the downmix of a stereo pair, the location of the other channel in the file (0 = none) */
+        uint32_t link_start;
         
         bool LOOP;
         int SAMPLE_NOTE;
@@ -113,15 +108,24 @@ namespace SF22ASWT
         uint8_t sample_count;
         uint8_t* sample_note_ranges;
         sample_header_temp* samples;
+        /** set when the arrays above are allocated from the load arena of the reader, they are then not deleted here */
+        bool arenaAllocated = false;
 
         void PrintTo(Print &stream);
 
-        ~instrument_data_temp() {
-          delete[] samples;
+        /** frees the arrays (when not from the load arena), the struct can then be loaded again */
+        void Free() {
+          if (arenaAllocated == false) {
+            delete[] samples;
+            delete[] sample_note_ranges;
+          }
           samples = nullptr; // avoid dangling pointer
-          delete[] sample_note_ranges;
           sample_note_ranges = nullptr; // avoid dangling pointer
+          sample_count = 0;
+          arenaAllocated = false;
         }
+
+        ~instrument_data_temp() { Free(); }
     };
 
     class sfVersionTag
@@ -168,7 +172,8 @@ namespace SF22ASWT
         void PrintTo(Print &stream);
     };
 
-    class phdr_rec
+    /** packed so that the whole phdr chunk can be read with a single read */
+    class __attribute__((packed)) phdr_rec
     {
       public:
         static const uint32_t Size = 38;
@@ -283,18 +288,13 @@ namespace SF22ASWT
         SF2GeneratorAmount genAmount;
     };
 
+    /** items are not owned, they points into the load arena or the igen data in ram */
     class bag_of_gens
     {
       public:
-        ~bag_of_gens() {
-            if (items != nullptr)
-            {
-                delete[] items;
-            }
-        }
         /** item count */
         uint16_t count = 0;
-        gen_rec* items;
+        gen_rec* items = nullptr;
         gen_rec lastItem()
         {
             return items[count-1];
@@ -309,7 +309,8 @@ namespace SF22ASWT
         uint16_t wInstBagNdx;
     };
 
-    class shdr_rec
+    /** packed so that the whole shdr chunk can be read with a single read */
+    class __attribute__((packed)) shdr_rec
     {
       public:
         static const uint32_t Size = 46;
@@ -325,45 +326,62 @@ namespace SF22ASWT
         SFSampleLink sfSampleType;
     };
 
+    /**
+     * all records are stored in ram, 
+     * every array is read with a single read directly from the file
+     * and is placed in external ram (PSRAM) when available
+    */
     class pdta_rec
     {
       public:
-        pdta_rec();
+        pdta_rec() = default;
+        // owns the arrays, a copy would free them twice (CloneInto makes a deep copy)
+        pdta_rec(const pdta_rec&) = delete;
+        pdta_rec& operator=(const pdta_rec&) = delete;
+        ~pdta_rec();
 
         uint32_t size = 0; // comes from parent LIST, used mostly for debug
+        /** true when the arrays is allocated in external ram (PSRAM) */
+        bool useExtMem = false;
         /** The Preset Headers */
-        phdr_rec *phdr;
+        phdr_rec *phdr = nullptr;
         uint32_t phdr_count = 0;
         /** The Preset Index list */
-        bag_rec *pbag;
+        bag_rec *pbag = nullptr;
         uint32_t pbag_count = 0;
         /** The Preset Modulator list */
-        mod_rec *pmod;
+        mod_rec *pmod = nullptr;
         uint32_t pmod_count = 0;
         /** The Preset Generator list */
-        gen_rec *pgen;
+        gen_rec *pgen = nullptr;
         uint32_t pgen_count = 0;
         /** The Instrument Names and Indices */
-        inst_rec *inst;
+        inst_rec *inst = nullptr;
         uint32_t inst_count = 0;
         /** The Instrument Index list */
-        bag_rec *ibag;
+        bag_rec *ibag = nullptr;
         uint32_t ibag_count = 0;
         /** The Instrument Modulator list */
-        mod_rec *imod;
+        mod_rec *imod = nullptr;
         uint32_t imod_count = 0;
         /** The Instrument Generator list */
-        gen_rec *igen;
+        gen_rec *igen = nullptr;
         uint32_t igen_count = 0;
         /** The Sample Headers */
-        shdr_rec *shdr;
+        shdr_rec *shdr = nullptr;
         uint32_t shdr_count = 0;
+
+        /** allocates size bytes in external ram if useExtMem is set otherwise in internal ram */
+        void* Allocate(size_t size);
+        /** frees all arrays and resets all counts */
+        void Free();
+        void CloneInto(pdta_rec &other);
     };
 
     class pdta_rec_lazy
     {
       public:
-        uint32_t size; // comes from parent LIST, used mostly for debug
+        uint32_t size = 0; // comes from parent LIST, used mostly for debug
         /** The Preset Headers */
         uint32_t phdr_position = 0;
         uint32_t phdr_count = 0;
@@ -409,7 +427,7 @@ namespace SF22ASWT
     class sdta_rec_lazy
     {
       public:
-        uint32_t size; // comes from parent LIST
+        uint32_t size = 0; // comes from parent LIST
         smpl_rec smpl;
         smpl_rec sm24;
 
@@ -439,4 +457,77 @@ namespace SF22ASWT
         pdta_rec pdta;
     };
 
+    /**
+     * one record per instrument in the index file (<sf2 file>.sfidx)
+     * so that instruments can be looked up without reading inst/ibag
+     * and so that the needed ram can be checked before loading
+    */
+    class inst_index_rec
+    {
+      public:
+        /** first ibag record of the instrument */
+        uint16_t ibag_start = 0;
+        /** the ibag record after the last one of the instrument (ibag_start of the next instrument) */
+        uint16_t ibag_end = 0;
+        /** number of zones that have a sample, the global zone is not included */
+        uint16_t zone_count = 0;
+        /** lowest key of all zones */
+        uint8_t key_low = 0;
+        /** highest key of all zones */
+        uint8_t key_high = 127;
+        /** sample data size inclusive padding, same value as getTotalSampleDataSizeBytes would give after load */
+        uint32_t sample_data_size = 0;
+    };
+
+    /**
+     * one record per preset (used by PresetIndex and stored in the index file)
+     * so that a bank/program is resolved without reading phdr
+    */
+    class preset_index_rec
+    {
+      public:
+        uint16_t bank = 0;
+        uint16_t program = 0;
+        /** first pbag record of the preset */
+        uint16_t pbag_start = 0;
+    };
+
+    /**
+     * the index file is stored as
+     * index_file_header, sfbk_rec_lazy, inst_index_rec[inst_count], preset_index_rec[preset_count + 1]
+     * and is only valid for the sf2 file that it was created from,
+     * fileSize, modifyTime and hash is used to detect that
+    */
+    class index_file_header
+    {
+      public:
+        static const uint32_t Magic = 0x58494653; // "SFIX"
+        static const uint16_t Version = 2;
+        /** number of bytes that is used to calculate the hash, taken from the start of the inst chunk */
+        static const uint32_t HashBlockSize = 512;
+
+        uint32_t magic = Magic;
+        uint16_t version = Version;
+        /** used to detect structure changes between library versions/platforms */
+        uint16_t sfbk_rec_size = sizeof(sfbk_rec_lazy);
+        uint16_t inst_index_rec_size = sizeof(inst_index_rec);
+        uint16_t preset_index_rec_size = sizeof(preset_index_rec);
+        /** size of the sf2 file */
+        uint32_t fileSize = 0;
+        /** packed (FAT style) modify time of the sf2 file, 0 when not available */
+        uint32_t modifyTime = 0;
+        /** FNV-1a hash of the RIFF header and the first HashBlockSize bytes of the inst chunk */
+        uint32_t hash = 0;
+        uint32_t inst_count = 0;
+        /** the presets excluding the EOP record (it's stored as well) */
+        uint32_t preset_count = 0;
+    };
+
+    // the records are read directly from the file so the sizes must match the file format
+    static_assert(sizeof(phdr_rec) == phdr_rec::Size, "phdr_rec size mismatch");
+    static_assert(sizeof(bag_rec) == bag_rec::Size, "bag_rec size mismatch");
+    static_assert(sizeof(mod_rec) == mod_rec::Size, "mod_rec size mismatch");
+    static_assert(sizeof(gen_rec) == gen_rec::Size, "gen_rec size mismatch");
+    static_assert(sizeof(inst_rec) == inst_rec::Size, "inst_rec size mismatch");
+    static_assert(sizeof(shdr_rec) == shdr_rec::Size, "shdr_rec size mismatch");
 }
\ No newline at end of file
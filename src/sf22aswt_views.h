@@ -0,0 +1,70 @@
+/**
+ * lightweight views of the inst, phdr and shdr records given to the ForEachInstrument/ForEachPreset/ForEachSample callbacks
+ *
+ * a view only points into the record buffer of the reader, so nothing is allocated or formatted
+ * while iterating, the name (and the view itself) is only valid inside the callback
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+#include "sf22aswt_structures.h"
+
+namespace SF22ASWT
+{
+    /** the length of a 20 byte name field without the null padding */
+    inline uint8_t getNameLength(const char *name)
+    {
+        uint8_t length = 0;
+        while (length < 20 && name[length] != '\0') length++;
+        return length;
+    }
+
+    struct InstrumentView
+    {
+        uint16_t index;
+        /** not null terminated, nameLength chars */
+        const char *name;
+        uint8_t nameLength;
+        uint16_t ibag_start;
+        /** the number of zones (bags), the global zone is included when the instrument have one */
+        uint16_t zone_count;
+
+        InstrumentView(uint16_t index, const inst_rec &inst, const inst_rec &next) :
+            index(index), name(inst.achInstName), nameLength(getNameLength(inst.achInstName)),
+            ibag_start(inst.wInstBagNdx), zone_count((next.wInstBagNdx > inst.wInstBagNdx) ? (next.wInstBagNdx - inst.wInstBagNdx) : 0) {}
+    };
+
+    struct PresetView
+    {
+        /** the phdr index */
+        uint16_t index;
+        /** not null terminated, nameLength chars */
+        const char *name;
+        uint8_t nameLength;
+        uint16_t bank;
+        uint16_t program;
+        uint16_t pbag_start;
+        /** the number of zones (bags), the global zone is included when the preset have one */
+        uint16_t zone_count;
+
+        PresetView(uint16_t index, const phdr_rec &phdr, const phdr_rec &next) :
+            index(index), name(phdr.achPresetName), nameLength(getNameLength(phdr.achPresetName)),
+            bank(phdr.wBank), program(phdr.wPreset),
+            pbag_start(phdr.wPresetBagNdx), zone_count((next.wPresetBagNdx > phdr.wPresetBagNdx) ? (next.wPresetBagNdx - phdr.wPresetBagNdx) : 0) {}
+    };
+
+    struct SampleView
+    {
+        uint16_t index;
+        /** not null terminated, nameLength chars */
+        const char *name;
+        uint8_t nameLength;
+        /** the raw record, for the start/end/loop points (in samples), rate, key and link */
+        const shdr_rec &shdr;
+
+        SampleView(uint16_t index, const shdr_rec &shdr) :
+            index(index), name(shdr.achSampleName), nameLength(getNameLength(shdr.achSampleName)), shdr(shdr) {}
+
+        uint32_t getLength() const { return (shdr.dwEnd > shdr.dwStart) ? (shdr.dwEnd - shdr.dwStart) : 0; }
+    };
+}
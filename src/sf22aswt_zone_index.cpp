@@ -0,0 +1,88 @@
+#include "sf22aswt_zone_index.h"
+
+namespace SF22ASWT
+{
+    bool ZoneIndex::Alloc(uint32_t instCount, uint32_t maxZoneCount)
+    {
+        Free();
+        // the arrays are placed in order of alignment
+        size = maxZoneCount*sizeof(sample_header_temp) +
+               (instCount + 1)*4 + maxZoneCount*(4 + 4) +
+               maxZoneCount*(2 + 2) +
+               maxZoneCount*(1 + 1 + 1 + 1);
+        useExtMem = (external_psram_size != 0);
+        block = (uint8_t*)(useExtMem ? extmem_malloc(size) : malloc(size));
+        if (block == nullptr) { size = 0; return false; }
+
+        uint8_t *ptr = block;
+        samples = (sample_header_temp*)ptr; ptr += maxZoneCount*sizeof(sample_header_temp);
+        instZoneStart = (uint32_t*)ptr; ptr += (instCount + 1)*4;
+        sampleStart = (uint32_t*)ptr; ptr += maxZoneCount*4;
+        sampleLength = (uint32_t*)ptr; ptr += maxZoneCount*4;
+        instrument = (uint16_t*)ptr; ptr += maxZoneCount*2;
+        sampleID = (uint16_t*)ptr; ptr += maxZoneCount*2;
+        keyLow = ptr; ptr += maxZoneCount;
+        keyHigh = ptr; ptr += maxZoneCount;
+        velLow = ptr; ptr += maxZoneCount;
+        velHigh = ptr;
+
+        this->instCount = instCount;
+        this->maxZoneCount = maxZoneCount;
+        zoneCount = 0;
+        for (uint32_t i=0;i<=instCount;i++) instZoneStart[i] = 0;
+        return true;
+    }
+
+    void ZoneIndex::Free()
+    {
+        if (block != nullptr) {
+            if (useExtMem) extmem_free(block);
+            else free(block);
+        }
+        block = nullptr;
+        size = 0;
+        built = false;
+        instCount = 0;
+        maxZoneCount = 0;
+        zoneCount = 0;
+        instZoneStart = nullptr;
+        instrument = nullptr;
+        keyLow = nullptr;
+        keyHigh = nullptr;
+        velLow = nullptr;
+        velHigh = nullptr;
+        sampleID = nullptr;
+        sampleStart = nullptr;
+        sampleLength = nullptr;
+        samples = nullptr;
+    }
+
+    void ZoneIndex::BeginInstrument(uint32_t index)
+    {
+        instZoneStart[index] = zoneCount;
+    }
+
+    bool ZoneIndex::Add(uint16_t instrument, const zone_gens &zone, const sample_header_temp &sample)
+    {
+        if (zoneCount >= maxZoneCount) return false;
+        SF2GeneratorAmount keyRange = zone.get(SFGenerator::keyRange);
+        SF2GeneratorAmount velRange = zone.get(SFGenerator::velRange);
+        this->instrument[zoneCount] = instrument;
+        keyLow[zoneCount] = keyRange.rangeLow();
+        keyHigh[zoneCount] = keyRange.rangeHigh();
+        velLow[zoneCount] = velRange.rangeLow();
+        velHigh[zoneCount] = velRange.rangeHigh();
+        sampleID[zoneCount] = zone.get(SFGenerator::sampleID).UAmount;
+        sampleStart[zoneCount] = sample.sample_start;
+        sampleLength[zoneCount] = sample.LENGTH;
+        samples[zoneCount] = sample;
+        zoneCount++;
+        return true;
+    }
+
+    void ZoneIndex::Finish()
+    {
+        instZoneStart[instCount] = zoneCount;
+        built = true;
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ * flattened table of the zones of all instruments, built once by BuildZoneIndex
+ *
+ * the table is stored as a structure of arrays (one array per value) in a single block
+ * that is placed in PSRAM when available, the zones of instrument n are
+ * the range instZoneStart[n] .. instZoneStart[n+1]-1
+ * so that loading a instrument is just a copy of that range
+*/
+#pragma once
+
+#include "sf22aswt_platform.h"
+#include "sf22aswt_structures.h"
+#include "sf22aswt_generators.h"
+
+namespace SF22ASWT
+{
+    class ZoneIndex
+    {
+      public:
+        ZoneIndex() {}
+        ZoneIndex(const ZoneIndex&) = delete;
+        ZoneIndex& operator=(const ZoneIndex&) = delete;
+        ~ZoneIndex() { Free(); }
+
+        /** allocates the table for instCount instruments with at most maxZoneCount zones in total */
+        bool Alloc(uint32_t instCount, uint32_t maxZoneCount);
+        void Free();
+        /** must be called before the zones of instrument index are added, the instruments must be added in order */
+        void BeginInstrument(uint32_t index);
+        /** returns false if the table is full */
+        bool Add(uint16_t instrument, const zone_gens &zone, const sample_header_temp &sample);
+        /** marks the table as complete */
+        void Finish();
+
+        bool isBuilt() { return built; }
+        uint32_t getInstrumentCount() { return instCount; }
+        uint32_t getZoneCount() { return zoneCount; }
+        /** the size in bytes of the table */
+        size_t getSize() { return size; }
+        bool getUseExtMem() { return useExtMem; }
+        uint32_t getInstrumentZoneStart(uint32_t index) { return instZoneStart[index]; }
+        uint32_t getInstrumentZoneCount(uint32_t index) { return instZoneStart[index+1] - instZoneStart[index]; }
+
+        /** instCount+1 items, the first zone of each instrument */
+        uint32_t *instZoneStart = nullptr;
+        // the following have one item per zone
+        uint16_t *instrument = nullptr;
+        uint8_t *keyLow = nullptr;
+        uint8_t *keyHigh = nullptr;
+        uint8_t *velLow = nullptr;
+        uint8_t *velHigh = nullptr;
+        uint16_t *sampleID = nullptr;
+        /** file position of the sample data */
+        uint32_t *sampleStart = nullptr;
+        /** in samples */
+        uint32_t *sampleLength = nullptr;
+        /** all resolved generator values, the sample pointer is allways nullptr */
+        sample_header_temp *samples = nullptr;
+
+      private:
+        uint8_t *block = nullptr;
+        size_t size = 0;
+        bool useExtMem = false;
+        bool built = false;
+        uint32_t instCount = 0;
+        uint32_t maxZoneCount = 0;
+        uint32_t zoneCount = 0;
+    };
+}